@@ -51,6 +51,12 @@ public:
      * @return City's water demand
      */
     int getDemand() const {return demand;}
+    /**
+     * Gets city's priority when water is scarce (its explicit priority, or its population if it has none).
+     * Complexity: O(1)
+     * @return City's priority
+     */
+    double getPriority() const {return priority < 0 ? population : priority;}
 
     //Setters==============================================================
     /**
@@ -83,6 +89,12 @@ public:
      * @param demand New water demand for the city
      */
     void setDemand(int demand) {this->demand = demand;}
+    /**
+     * Sets city's priority (a negative value uses the population).
+     * Complexity: O(1)
+     * @param priority New priority for the city
+     */
+    void setPriority(double priority) {this->priority = priority;}
 
     //operator ===================================================================================
     bool operator==(const City &other) const{
@@ -92,6 +104,7 @@ public:
 private:
     std::string name, code;
     int id, population, demand;
+    double priority = -1; // negative if the city has no explicit priority
 
 };
 #endif //PROJECT1_CITY_H
@@ -0,0 +1,218 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#include "CompactNetwork.h"
+#include <algorithm>
+
+using namespace std;
+
+/** @file CompactNetwork.cpp
+ *  @brief Implementation of CompactNetwork class
+ */
+
+const uint32_t CompactNetwork::NONE;
+
+/**
+ * Copies the network (the previous copy is replaced).
+ * Complexity: O(V log V + E) where V is the number of vertexes and E is the number of edges
+ * @param network Network to copy
+ */
+void CompactNetwork::build(const Graph<std::string> &network) {
+    *this = CompactNetwork();
+    vector<Vertex<string>*> vertexSet = network.getVertexSet();
+
+    //vertexes (the super nodes are skipped)
+    vector<uint32_t> position(vertexSet.size(), NONE);
+    codeOffsets.push_back(0);
+    for(Vertex<string> *v : vertexSet){
+        if(v->getType() == VertexType::SUPERSOURCE || v->getType() == VertexType::SUPERSINK) continue;
+        position[v->getIndex()] = types.size();
+        types.push_back(static_cast<uint8_t>(v->getType()));
+        codeData += v->getInfo();
+        codeOffsets.push_back(codeData.size());
+    }
+    byCode.resize(types.size());
+    for(uint32_t i = 0; i < byCode.size(); i++) byCode[i] = i;
+    sort(byCode.begin(), byCode.end(), [this](uint32_t a, uint32_t b) {
+        return codeData.compare(codeOffsets[a], codeOffsets[a + 1] - codeOffsets[a], codeData, codeOffsets[b], codeOffsets[b + 1] - codeOffsets[b]) < 0;
+    });
+
+    //pipes, by origin
+    vector<double> capacity, flow, cost;
+    offsets.push_back(0);
+    for(Vertex<string> *v : vertexSet){
+        if(position[v->getIndex()] == NONE) continue;
+        for(Edge<string> *e : v->getAdj()){
+            if(position[e->getDest()->getIndex()] == NONE) continue;
+            heads.push_back(position[e->getDest()->getIndex()]);
+            bidirectional.push_back(e->isBidirectional());
+            capacity.push_back(e->getWeight());
+            flow.push_back(e->getFlow());
+            cost.push_back(e->getCost());
+        }
+        offsets.push_back(heads.size());
+    }
+    capacities.assign(capacity);
+    flows.assign(flow);
+    costs.assign(cost);
+
+    codeData.shrink_to_fit();
+    codeOffsets.shrink_to_fit();
+    types.shrink_to_fit();
+    offsets.shrink_to_fit();
+    heads.shrink_to_fit();
+    bidirectional.shrink_to_fit();
+}
+
+/**
+ * Finds a vertex by its code (binary search on the codes).
+ * Complexity: O(log V) where V is the number of vertexes
+ * @param code Code of the vertex
+ * @return Index of the vertex (NONE if it doesn't exist)
+ */
+uint32_t CompactNetwork::findVertex(const std::string &code) const {
+    auto search = lower_bound(byCode.begin(), byCode.end(), code, [this](uint32_t v, const string &key) {
+        return codeData.compare(codeOffsets[v], codeOffsets[v + 1] - codeOffsets[v], key) < 0;
+    });
+    if(search == byCode.end() || codeData.compare(codeOffsets[*search], codeOffsets[*search + 1] - codeOffsets[*search], code) != 0) return NONE;
+    return *search;
+}
+
+/**
+ * Gets the code of a vertex.
+ * Complexity: O(n) where n is the size of the code
+ * @param vertex Index of the vertex
+ * @return Code of the vertex
+ */
+std::string CompactNetwork::getCode(uint32_t vertex) const {
+    return codeData.substr(codeOffsets[vertex], codeOffsets[vertex + 1] - codeOffsets[vertex]);
+}
+
+/**
+ * Gets the type of a vertex.
+ * Complexity: O(1)
+ * @param vertex Index of the vertex
+ * @return Type of the vertex
+ */
+VertexType CompactNetwork::getType(uint32_t vertex) const {
+    return static_cast<VertexType>(types[vertex]);
+}
+
+/**
+ * Gets the first pipe leaving a vertex (the pipes leaving the vertex end right before firstPipe(vertex + 1)).
+ * Complexity: O(1)
+ * @param vertex Index of the vertex (getNumVertexes() gives the end of the last vertex)
+ * @return Index of the pipe
+ */
+uint32_t CompactNetwork::firstPipe(uint32_t vertex) const {
+    return offsets[vertex];
+}
+
+/**
+ * Gets the destination of a pipe.
+ * Complexity: O(1)
+ * @param pipe Index of the pipe
+ * @return Index of the destination vertex
+ */
+uint32_t CompactNetwork::getDest(uint32_t pipe) const {
+    return heads[pipe];
+}
+
+/**
+ * Gets the capacity of a pipe.
+ * Complexity: O(1)
+ * @param pipe Index of the pipe
+ * @return Capacity of the pipe
+ */
+double CompactNetwork::getCapacity(uint32_t pipe) const {
+    return capacities.get(pipe);
+}
+
+/**
+ * Gets the flow of a pipe when the copy was made.
+ * Complexity: O(1)
+ * @param pipe Index of the pipe
+ * @return Flow of the pipe (negative if a bidirectional pipe is used from its destination)
+ */
+double CompactNetwork::getFlow(uint32_t pipe) const {
+    return flows.get(pipe);
+}
+
+/**
+ * Gets the cost per unit of flow of a pipe.
+ * Complexity: O(1)
+ * @param pipe Index of the pipe
+ * @return Cost of the pipe
+ */
+double CompactNetwork::getCost(uint32_t pipe) const {
+    return costs.get(pipe);
+}
+
+/**
+ * Checks if a pipe can be used both ways.
+ * Complexity: O(1)
+ * @param pipe Index of the pipe
+ * @return True if the pipe is bidirectional, false otherwise
+ */
+bool CompactNetwork::isBidirectional(uint32_t pipe) const {
+    return bidirectional[pipe];
+}
+
+/**
+ * Checks if every number of the pipes is stored as a float.
+ * Complexity: O(1)
+ * @return True if capacities, flows and costs are all stored as floats (or not stored), false otherwise
+ */
+bool CompactNetwork::isSinglePrecision() const {
+    return capacities.isSinglePrecision() && flows.isSinglePrecision() && costs.isSinglePrecision();
+}
+
+/**
+ * Gets the memory used by the copy.
+ * Complexity: O(1)
+ * @return Bytes used
+ */
+std::size_t CompactNetwork::memoryUsage() const {
+    return sizeof(CompactNetwork) + codeData.capacity() + MemoryUsage::heapBytes(codeOffsets) + MemoryUsage::heapBytes(byCode)
+           + MemoryUsage::heapBytes(types) + MemoryUsage::heapBytes(offsets) + MemoryUsage::heapBytes(heads)
+           + (bidirectional.capacity() + 7) / 8 + capacities.memoryUsage() + flows.memoryUsage() + costs.memoryUsage();
+}
+
+/**
+ * Stores the values as floats if every one of them is exactly a float, as doubles otherwise. Nothing is stored if they are all 0.
+ * Complexity: O(n) where n is the number of values
+ * @param values Values to store
+ */
+void CompactNetwork::Values::assign(const std::vector<double> &values) {
+    floats.clear();
+    doubles.clear();
+    bool allZero = true, lossless = true;
+    for(double value : values){
+        if(value != 0) allZero = false;
+        if(static_cast<double>(static_cast<float>(value)) != value) lossless = false;
+    }
+    if(allZero) return;
+    if(lossless) floats.assign(values.begin(), values.end());
+    else doubles = values;
+}
+
+/**
+ * Gets a value.
+ * Complexity: O(1)
+ * @param i Index of the value
+ * @return Value
+ */
+double CompactNetwork::Values::get(std::size_t i) const {
+    if(!doubles.empty()) return doubles[i];
+    return floats.empty() ? 0 : floats[i];
+}
+
+/**
+ * Gets the memory used by the values.
+ * Complexity: O(1)
+ * @return Bytes used
+ */
+std::size_t CompactNetwork::Values::memoryUsage() const {
+    return MemoryUsage::heapBytes(floats) + MemoryUsage::heapBytes(doubles);
+}
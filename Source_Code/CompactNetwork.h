@@ -0,0 +1,86 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#ifndef PROJECT1_COMPACTNETWORK_H
+#define PROJECT1_COMPACTNETWORK_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Graph.h"
+
+/**
+ * @file CompactNetwork.h
+ * @brief Definition of class CompactNetwork.
+ *
+ * \class CompactNetwork
+ * Read-only copy of the pipe network that uses as little memory as possible, for networks too big for the Graph model:
+ *  - the codes are interned in a single buffer (no string per vertex, no hash map: codes are found with a binary search);
+ *  - the pipes are compressed rows with 32 bit indexes (pipes leaving vertex v are firstPipe(v) .. firstPipe(v + 1) - 1);
+ *  - capacities, flows and costs are stored as floats when every value is exactly a float (as doubles otherwise),
+ *    and not stored at all when they are all 0.
+ * The super source and the super sink are not copied.
+ */
+class CompactNetwork {
+public:
+    static const uint32_t NONE = UINT32_MAX;
+
+    void build(const Graph<std::string> &network);
+
+    uint32_t findVertex(const std::string &code) const;
+    std::string getCode(uint32_t vertex) const;
+    VertexType getType(uint32_t vertex) const;
+    uint32_t firstPipe(uint32_t vertex) const;
+    uint32_t getDest(uint32_t pipe) const;
+    double getCapacity(uint32_t pipe) const;
+    double getFlow(uint32_t pipe) const;
+    double getCost(uint32_t pipe) const;
+    bool isBidirectional(uint32_t pipe) const;
+    bool isSinglePrecision() const;
+    std::size_t memoryUsage() const;
+
+    /**
+     * Gets the number of vertexes.
+     * Complexity: O(1)
+     * @return Number of vertexes
+     */
+    uint32_t getNumVertexes() const { return types.size(); }
+    /**
+     * Gets the number of pipes.
+     * Complexity: O(1)
+     * @return Number of pipes
+     */
+    uint32_t getNumPipes() const { return heads.size(); }
+
+private:
+    /**
+     * \class Values
+     * Numbers of the pipes, stored as floats when that is lossless.
+     */
+    class Values {
+    public:
+        void assign(const std::vector<double> &values);
+        double get(std::size_t i) const;
+        bool isSinglePrecision() const { return doubles.empty(); }
+        std::size_t memoryUsage() const;
+    private:
+        std::vector<float> floats;
+        std::vector<double> doubles;
+    };
+
+    std::string codeData;               // every code, one after the other
+    std::vector<uint32_t> codeOffsets;  // code of vertex v is codeData[codeOffsets[v] .. codeOffsets[v + 1]]
+    std::vector<uint32_t> byCode;       // vertexes sorted by code
+    std::vector<uint8_t> types;
+
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> heads;
+    std::vector<bool> bidirectional;
+    Values capacities;
+    Values flows;
+    Values costs;
+};
+
+
+#endif //PROJECT1_COMPACTNETWORK_H
@@ -0,0 +1,21 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#ifndef PROJECT1_DISTRIBUTIONMODE_H
+#define PROJECT1_DISTRIBUTIONMODE_H
+/**
+ * @file DistributionMode.h
+ * @brief Contains a enum class to help differentiate how the water is distributed when it is not enough for every city
+ *
+ * \enum DistributionMode
+ * Helps differentiate how the water is distributed (any maximum flow, the same fraction of the demand for every city, the cities with the highest priority first
+ * or the maximum flow with the smallest operating cost)
+ */
+enum class DistributionMode{
+    MAX_FLOW,
+    FAIR_SHARE,
+    PRIORITY,
+    MIN_COST
+};
+#endif //PROJECT1_DISTRIBUTIONMODE_H
@@ -0,0 +1,324 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#include "DominatorTree.h"
+
+using namespace std;
+
+/** @file DominatorTree.cpp
+ *  @brief Implementation of DominatorTree class
+ */
+
+const int DominatorTree::NONE;
+
+/**
+ * Builds the dominator tree: creates the node graph (vertexes, pipes and the virtual root), finds the immediate dominators
+ * and numbers the tree so that dominance can be checked in constant time.
+ * Complexity: O(E log V) where V is the number of vertexes and E is the number of edges
+ * @param network Water network
+ */
+void DominatorTree::build(const Graph<std::string> &network) {
+    const vector<Vertex<string> *> vertexSet = network.getVertexSet();
+    const int numVertex = vertexSet.size() + 1;
+
+    vertexNode.clear();
+    pipeNode.clear();
+    pipeEnds.clear();
+    pipeBidirectional.clear();
+    vertexCode.assign(numVertex, "");
+    vertexType.assign(numVertex, VertexType::SUPERSOURCE);
+
+    vector<vector<int>> succ(numVertex), pred(numVertex);
+    auto addArc = [&](int a, int b){
+        succ[a].push_back(b);
+        pred[b].push_back(a);
+    };
+    auto newNode = [&](){
+        succ.emplace_back();
+        pred.emplace_back();
+        return (int) succ.size() - 1;
+    };
+
+    for(Vertex<string> *v : vertexSet){
+        int node = v->getIndex() + 1;
+        vertexNode.emplace(v->getInfo(), node);
+        vertexCode[node] = v->getInfo();
+        vertexType[node] = v->getType();
+        if(v->getType() == VertexType::RESERVOIR) addArc(0, node);
+    }
+
+    //every pipe is a node between its endpoints (bidirectional pipes can be crossed both ways)
+    for(Vertex<string> *v : vertexSet){
+        if(v->getType() == VertexType::SUPERSOURCE || v->getType() == VertexType::SUPERSINK) continue;
+        for(Edge<string> *e : v->getAdj()){
+            Vertex<string> *w = e->getDest();
+            if(w->getType() == VertexType::SUPERSOURCE || w->getType() == VertexType::SUPERSINK) continue;
+            int p = newNode();
+            pipeNode.emplace(v->getInfo() + '\n' + w->getInfo(), p);
+            pipeEnds.emplace_back(v->getInfo(), w->getInfo());
+            pipeBidirectional.push_back(e->isBidirectional());
+            addArc(v->getIndex() + 1, p);
+            addArc(p, w->getIndex() + 1);
+            if(e->isBidirectional()){
+                addArc(w->getIndex() + 1, p);
+                addArc(p, v->getIndex() + 1);
+            }
+        }
+    }
+
+    computeDominators(succ, pred);
+
+    //preorder interval of each node in the dominator tree (a dominates b if b's interval is inside a's)
+    const int n = succ.size();
+    vector<vector<int>> children(n);
+    for(int v = 1; v < n; v++){
+        if(idom[v] != NONE) children[idom[v]].push_back(v);
+    }
+    treeIn.assign(n, NONE);
+    treeOut.assign(n, NONE);
+    int counter = 0;
+    vector<pair<int, size_t>> stack {{0, 0}};
+    treeIn[0] = counter++;
+    while(!stack.empty()){
+        pair<int, size_t> &top = stack.back();
+        if(top.second < children[top.first].size()){
+            int child = children[top.first][top.second++];
+            treeIn[child] = counter++;
+            stack.emplace_back(child, 0);
+        }
+        else{
+            treeOut[top.first] = counter++;
+            stack.pop_back();
+        }
+    }
+}
+
+/**
+ * Finds the immediate dominator of every node reachable from the root (node 0), with the simple version of Lengauer-Tarjan
+ * (path compression, no balancing). The depth first search and the path compression use explicit stacks.
+ * Complexity: O(E log V) where V is the number of nodes and E is the number of arcs
+ * @param succ Successors of each node
+ * @param pred Predecessors of each node
+ */
+void DominatorTree::computeDominators(const std::vector<std::vector<int>> &succ, const std::vector<std::vector<int>> &pred) {
+    const int n = succ.size();
+    vector<int> dfn(n, NONE), vertex, parent;
+    vertex.reserve(n);
+    parent.reserve(n);
+
+    //depth first numbering
+    vector<pair<int, size_t>> stack {{0, 0}};
+    dfn[0] = 0;
+    vertex.push_back(0);
+    parent.push_back(NONE);
+    while(!stack.empty()){
+        pair<int, size_t> &top = stack.back();
+        if(top.second == succ[top.first].size()){
+            stack.pop_back();
+            continue;
+        }
+        int w = succ[top.first][top.second++];
+        if(dfn[w] != NONE) continue;
+        dfn[w] = vertex.size();
+        parent.push_back(dfn[top.first]);
+        vertex.push_back(w);
+        stack.emplace_back(w, 0);
+    }
+
+    const int k = vertex.size();
+    semi.resize(k);
+    label.resize(k);
+    ancestor.assign(k, NONE);
+    for(int i = 0; i < k; i++){
+        semi[i] = i;
+        label[i] = i;
+    }
+    vector<int> dom(k, 0);
+    vector<vector<int>> bucket(k);
+
+    for(int w = k - 1; w > 0; w--){
+        for(int v : pred[vertex[w]]){
+            if(dfn[v] == NONE) continue;
+            int u = eval(dfn[v]);
+            if(semi[u] < semi[w]) semi[w] = semi[u];
+        }
+        bucket[semi[w]].push_back(w);
+        ancestor[w] = parent[w];
+
+        for(int v : bucket[parent[w]]){
+            int u = eval(v);
+            dom[v] = semi[u] < semi[v] ? u : parent[w];
+        }
+        bucket[parent[w]].clear();
+    }
+    for(int w = 1; w < k; w++){
+        if(dom[w] != semi[w]) dom[w] = dom[dom[w]];
+    }
+
+    idom.assign(n, NONE);
+    for(int w = 1; w < k; w++){
+        idom[vertex[w]] = vertex[dom[w]];
+    }
+}
+
+/**
+ * Finds the node with the smallest semidominator in the path from a node to the root of its tree in the forest, compressing the path.
+ * Complexity: O(log V) amortized
+ * @param v Node (dfs number)
+ * @return Node (dfs number) with the smallest semidominator
+ */
+int DominatorTree::eval(int v) {
+    if(ancestor[v] == NONE) return v;
+
+    vector<int> path;
+    for(int x = v; ancestor[ancestor[x]] != NONE; x = ancestor[x]){
+        path.push_back(x);
+    }
+    //the nodes closer to the root are compressed first
+    for(auto it = path.rbegin(); it != path.rend(); it++){
+        int x = *it;
+        if(semi[label[ancestor[x]]] < semi[label[x]]) label[x] = label[ancestor[x]];
+        ancestor[x] = ancestor[ancestor[x]];
+    }
+    return label[v];
+}
+
+/**
+ * Checks if a vertex can receive water from at least one reservoir.
+ * Complexity: O(1) on average
+ * @param code Code of the vertex
+ * @return True if the vertex is reachable, false otherwise
+ */
+bool DominatorTree::isReachable(const std::string &code) const {
+    auto search = vertexNode.find(code);
+    return search != vertexNode.end() && idom[search->second] != NONE;
+}
+
+/**
+ * Checks if every path from the reservoirs to a city goes through an element (reservoir, station or city).
+ * Complexity: O(1) on average
+ * @param elementCode Code of the element
+ * @param cityCode Code of the city
+ * @return True if the element dominates the city (a city dominates itself), false otherwise
+ */
+bool DominatorTree::dominates(const std::string &elementCode, const std::string &cityCode) const {
+    auto element = vertexNode.find(elementCode);
+    auto city = vertexNode.find(cityCode);
+    if(element == vertexNode.end() || city == vertexNode.end()) return false;
+    return nodeDominates(element->second, city->second);
+}
+
+/**
+ * Checks if every path from the reservoirs to a city goes through a pipe.
+ * Complexity: O(1) on average
+ * @param origin Origin of the pipe
+ * @param destination Destination of the pipe
+ * @param cityCode Code of the city
+ * @return True if the pipe dominates the city, false otherwise
+ */
+bool DominatorTree::pipeDominates(const std::string &origin, const std::string &destination, const std::string &cityCode) const {
+    int pipe = findPipeNode(origin, destination);
+    auto city = vertexNode.find(cityCode);
+    if(pipe == NONE || city == vertexNode.end()) return false;
+    return nodeDominates(pipe, city->second);
+}
+
+/**
+ * Gets the stations whose failure leaves a city without any water (the stations in the dominator tree path from the city to the root).
+ * Complexity: O(d) where d is the depth of the city in the dominator tree
+ * @param cityCode Code of the city
+ * @return Codes of the stations, from the closest to the city to the farthest
+ */
+std::vector<std::string> DominatorTree::criticalStations(const std::string &cityCode) const {
+    vector<string> res;
+    auto city = vertexNode.find(cityCode);
+    if(city == vertexNode.end() || idom[city->second] == NONE) return res;
+    for(int v = idom[city->second]; v > 0; v = idom[v]){
+        if(v < (int) vertexCode.size() && vertexType[v] == VertexType::STATIONS) res.push_back(vertexCode[v]);
+    }
+    return res;
+}
+
+/**
+ * Gets the pipes whose rupture leaves a city without any water (the pipes in the dominator tree path from the city to the root).
+ * Complexity: O(d) where d is the depth of the city in the dominator tree
+ * @param cityCode Code of the city
+ * @return Origin/destination of the pipes, from the closest to the city to the farthest
+ */
+std::vector<std::pair<std::string, std::string>> DominatorTree::criticalPipes(const std::string &cityCode) const {
+    vector<pair<string, string>> res;
+    auto city = vertexNode.find(cityCode);
+    if(city == vertexNode.end() || idom[city->second] == NONE) return res;
+    for(int v = idom[city->second]; v > 0; v = idom[v]){
+        if(v >= (int) vertexCode.size()) res.push_back(pipeEnds[v - vertexCode.size()]);
+    }
+    return res;
+}
+
+/**
+ * Gets the cities left without any water if an element (reservoir or station) fails.
+ * Complexity: O(V) where V is the number of vertexes
+ * @param elementCode Code of the element
+ * @return Codes of the cities
+ */
+std::vector<std::string> DominatorTree::disconnectedCities(const std::string &elementCode) const {
+    auto element = vertexNode.find(elementCode);
+    if(element == vertexNode.end()) return {};
+    return dominatedCities(element->second);
+}
+
+/**
+ * Gets the cities left without any water if a pipe is ruptured.
+ * Complexity: O(V) where V is the number of vertexes
+ * @param origin Origin of the pipe
+ * @param destination Destination of the pipe
+ * @return Codes of the cities
+ */
+std::vector<std::string> DominatorTree::disconnectedCities(const std::string &origin, const std::string &destination) const {
+    int pipe = findPipeNode(origin, destination);
+    if(pipe == NONE) return {};
+    return dominatedCities(pipe);
+}
+
+/**
+ * Finds the node of a pipe (bidirectional pipes can be given in both directions).
+ * Complexity: O(1) on average
+ * @param origin Origin of the pipe
+ * @param destination Destination of the pipe
+ * @return Node of the pipe or NONE if it doesn't exist
+ */
+int DominatorTree::findPipeNode(const std::string &origin, const std::string &destination) const {
+    auto search = pipeNode.find(origin + '\n' + destination);
+    if(search != pipeNode.end()) return search->second;
+    //stored the other way, only valid if the pipe can be crossed from origin to destination
+    search = pipeNode.find(destination + '\n' + origin);
+    if(search != pipeNode.end() && pipeBidirectional[search->second - vertexCode.size()]) return search->second;
+    return NONE;
+}
+
+/**
+ * Checks if a node dominates another one (using the preorder intervals of the dominator tree).
+ * Complexity: O(1)
+ * @param a Possible dominator
+ * @param b Dominated node
+ * @return True if a dominates b, false otherwise (or if any of them is unreachable)
+ */
+bool DominatorTree::nodeDominates(int a, int b) const {
+    if(treeIn[a] == NONE || treeIn[b] == NONE) return false;
+    return treeIn[a] <= treeIn[b] && treeOut[b] <= treeOut[a];
+}
+
+/**
+ * Gets the cities dominated by a node (without the node itself).
+ * Complexity: O(V) where V is the number of vertexes
+ * @param node Node
+ * @return Codes of the cities
+ */
+std::vector<std::string> DominatorTree::dominatedCities(int node) const {
+    vector<string> res;
+    for(size_t v = 1; v < vertexCode.size(); v++){
+        if((int) v != node && vertexType[v] == VertexType::CITIES && nodeDominates(node, v)) res.push_back(vertexCode[v]);
+    }
+    return res;
+}
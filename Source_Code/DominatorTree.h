@@ -0,0 +1,64 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#ifndef PROJECT1_DOMINATORTREE_H
+#define PROJECT1_DOMINATORTREE_H
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Graph.h"
+
+/**
+ * @file DominatorTree.h
+ * @brief Definition of class DominatorTree.
+ *
+ * \class DominatorTree
+ * Dominator tree of the pipe network, rooted at a virtual source connected to every reservoir (Lengauer-Tarjan).
+ * Each pipe is also a node (between its endpoints), so pipes can dominate too.
+ * An element (reservoir, station or pipe) dominates a city if every path from the reservoirs to the city goes through it:
+ * removing it leaves the city with no water at all, whatever the capacities. These single points of failure are found without solving any flow.
+ * The super source and the super sink are ignored. The tree must be built again when pipes or vertexes are added or removed.
+ */
+class DominatorTree {
+public:
+    DominatorTree() = default;
+
+    void build(const Graph<std::string> &network);
+
+    bool isReachable(const std::string &code) const;
+    bool dominates(const std::string &elementCode, const std::string &cityCode) const;
+    bool pipeDominates(const std::string &origin, const std::string &destination, const std::string &cityCode) const;
+    std::vector<std::string> criticalStations(const std::string &cityCode) const;
+    std::vector<std::pair<std::string, std::string>> criticalPipes(const std::string &cityCode) const;
+    std::vector<std::string> disconnectedCities(const std::string &elementCode) const;
+    std::vector<std::string> disconnectedCities(const std::string &origin, const std::string &destination) const;
+
+private:
+    static const int NONE = -1;
+
+    int findPipeNode(const std::string &origin, const std::string &destination) const;
+    bool nodeDominates(int a, int b) const;
+    std::vector<std::string> dominatedCities(int node) const;
+    void computeDominators(const std::vector<std::vector<int>> &succ, const std::vector<std::vector<int>> &pred);
+    int eval(int v);
+
+    //nodes: 0 is the virtual root, then one per vertex (index + 1), then one per pipe
+    std::unordered_map<std::string, int> vertexNode;
+    std::vector<std::string> vertexCode;   // code of each vertex node
+    std::vector<VertexType> vertexType;    // type of each vertex node
+    std::vector<std::pair<std::string, std::string>> pipeEnds;   // origin/destination of each pipe node
+    std::vector<bool> pipeBidirectional;
+    std::unordered_map<std::string, int> pipeNode;
+
+    std::vector<int> idom;            // immediate dominator of each node (NONE if unreachable)
+    std::vector<int> treeIn, treeOut; // preorder interval of each node in the dominator tree
+
+    //Lengauer-Tarjan auxiliary arrays (indexed by dfs number)
+    std::vector<int> semi, ancestor, label;
+};
+
+
+#endif //PROJECT1_DOMINATORTREE_H
@@ -0,0 +1,108 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#include "EditJournal.h"
+#include <limits>
+
+using namespace std;
+
+/** @file EditJournal.cpp
+ *  @brief Implementation of EditJournal class
+ */
+
+/**
+ * Records an edit that was just applied. The edits that were undone can't be redone anymore.
+ * Complexity: O(1) amortized (plus the edits discarded)
+ * @param edit Edit applied
+ */
+void EditJournal::record(const Edit &edit) {
+    edits.resize(position);
+    edits.push_back(edit);
+    position++;
+}
+
+/**
+ * Moves back one edit.
+ * Complexity: O(1)
+ * @return Edit to revert (see inverse) or nullptr if there is none
+ */
+const EditJournal::Edit *EditJournal::undo() {
+    if(!canUndo()) return nullptr;
+    return &edits[--position];
+}
+
+/**
+ * Moves forward one edit.
+ * Complexity: O(1)
+ * @return Edit to apply again or nullptr if there is none
+ */
+const EditJournal::Edit *EditJournal::redo() {
+    if(!canRedo()) return nullptr;
+    return &edits[position++];
+}
+
+/**
+ * Removes every edit.
+ * Complexity: O(n) where n is the number of edits
+ */
+void EditJournal::clear() {
+    edits.clear();
+    position = 0;
+}
+
+/**
+ * Gets the edit that reverts an edit.
+ * Complexity: O(1)
+ * @param edit Edit
+ * @return Opposite edit
+ */
+EditJournal::Edit EditJournal::inverse(const Edit &edit) {
+    Edit res = edit;
+    switch (edit.type) {
+        case EditType::INSERT_VERTEX: res.type = EditType::REMOVE_VERTEX; break;
+        case EditType::REMOVE_VERTEX: res.type = EditType::INSERT_VERTEX; break;
+        case EditType::ADD_PIPE: res.type = EditType::REMOVE_PIPE; break;
+        case EditType::REMOVE_PIPE: res.type = EditType::ADD_PIPE; break;
+        case EditType::CHANGE_CAPACITY:
+        case EditType::CHANGE_STATION_CAPACITY:
+            res.capacity = edit.previousCapacity;
+            res.previousCapacity = edit.capacity;
+            break;
+    }
+    return res;
+}
+
+/**
+ * Writes the capacity of a station to show it to the user.
+ * Complexity: O(1)
+ * @param capacity Capacity (infinity for no limit)
+ * @return Capacity as text
+ */
+static std::string stationCapacityText(double capacity) {
+    if(capacity == numeric_limits<double>::infinity()) return "no limit";
+    return to_string(static_cast<long long>(capacity));
+}
+
+/**
+ * Describes an edit to show it to the user.
+ * Complexity: O(1)
+ * @param edit Edit
+ * @return Description of the edit
+ */
+std::string EditJournal::describe(const Edit &edit) {
+    string pipe = edit.origin + (edit.bidirectional ? " <-> " : " -> ") + edit.destination;
+    switch (edit.type) {
+        case EditType::INSERT_VERTEX: return "insertion of " + edit.origin;
+        case EditType::REMOVE_VERTEX: return "removal of " + edit.origin;
+        case EditType::ADD_PIPE: return "addition of the pipe " + pipe;
+        case EditType::REMOVE_PIPE: return "removal of the pipe " + pipe;
+        case EditType::CHANGE_CAPACITY:
+            return "capacity of the pipe " + pipe + " changed from " + to_string(static_cast<long long>(edit.previousCapacity))
+                   + " to " + to_string(static_cast<long long>(edit.capacity));
+        case EditType::CHANGE_STATION_CAPACITY:
+            return "capacity of the station " + edit.origin + " changed from " + stationCapacityText(edit.previousCapacity)
+                   + " to " + stationCapacityText(edit.capacity);
+    }
+    return "";
+}
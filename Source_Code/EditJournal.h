@@ -0,0 +1,89 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#ifndef PROJECT1_EDITJOURNAL_H
+#define PROJECT1_EDITJOURNAL_H
+
+#include <string>
+#include <vector>
+#include "VertexType.h"
+
+/**
+ * @file EditJournal.h
+ * @brief Definition of class EditJournal.
+ *
+ * \class EditJournal
+ * Ordered list of the edits made to the network (vertexes inserted, pipes added or removed and capacities of pipes and stations changed),
+ * with everything needed to revert each one. The edits after the current position were undone and can be redone;
+ * recording a new edit discards them. A checkpoint is a position of the journal the network can be taken back to.
+ */
+class EditJournal {
+public:
+    /**
+     * \enum EditType
+     * Type of change made to the network.
+     */
+    enum class EditType{
+        INSERT_VERTEX,
+        REMOVE_VERTEX,
+        ADD_PIPE,
+        REMOVE_PIPE,
+        CHANGE_CAPACITY,
+        CHANGE_STATION_CAPACITY
+    };
+
+    /**
+     * \struct Edit
+     * A change made to the network. Vertex edits only use the origin (the code of the vertex) and its type, station capacity
+     * edits only use the origin (the code of the station) and the capacities.
+     */
+    struct Edit {
+        EditType type;
+        std::string origin;
+        std::string destination;
+        VertexType vertexType = VertexType::STATIONS;
+        double capacity = 0;            // capacity of the pipe (new capacity for CHANGE_CAPACITY and CHANGE_STATION_CAPACITY)
+        double previousCapacity = 0;    // only for CHANGE_CAPACITY and CHANGE_STATION_CAPACITY
+        bool bidirectional = false;
+        double cost = 0;
+    };
+
+    void record(const Edit &edit);
+    const Edit *undo();
+    const Edit *redo();
+    void clear();
+
+    /**
+     * Checks if there is an edit to undo.
+     * Complexity: O(1)
+     * @return True if there is, false otherwise
+     */
+    bool canUndo() const { return position > 0; }
+
+    /**
+     * Checks if there is an undone edit to redo.
+     * Complexity: O(1)
+     * @return True if there is, false otherwise
+     */
+    bool canRedo() const { return position < edits.size(); }
+
+    /**
+     * Gets the current position of the journal (number of edits applied), to go back to it later.
+     * Complexity: O(1)
+     * @return Checkpoint
+     */
+    std::size_t checkpoint() const { return position; }
+
+    const std::vector<Edit> &getEdits() const { return edits; }
+
+    static Edit inverse(const Edit &edit);
+    static std::string describe(const Edit &edit);
+
+private:
+    std::vector<Edit> edits;
+    std::size_t position = 0;   // edits before this position are applied
+};
+
+
+#endif //PROJECT1_EDITJOURNAL_H
@@ -0,0 +1,339 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#include "FlowNetwork.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+using namespace std;
+
+/** @file FlowNetwork.cpp
+ *  @brief Implementation of FlowNetwork class
+ */
+
+/**
+ * Adds a node to the network.
+ * Complexity: O(1)
+ * @return Index of the new node
+ */
+uint32_t FlowNetwork::addNode() {
+    return numNodes++;
+}
+
+/**
+ * Adds a pipe to the network (finalize must be called after the last pipe). The pipe gets the index getNumPipes() - 1.
+ * Complexity: O(1) amortized
+ * @param origin Origin node
+ * @param destination Destination node
+ * @param capacity Capacity of the pipe
+ * @param bidirectional True if the pipe can be used both ways (sharing its capacity)
+ * @param cost Cost per unit of flow (ignored for bidirectional pipes)
+ */
+void FlowNetwork::addPipe(uint32_t origin, uint32_t destination, double capacity, bool bidirectional, double cost) {
+    //the tail of each arc is the head of its pair
+    arcHead.push_back(destination);
+    arcCapacity.push_back(capacity);
+    arcHead.push_back(origin);
+    arcCapacity.push_back(bidirectional ? capacity : 0);
+    bidirectionalPipe.push_back(bidirectional);
+    arcCost.push_back(bidirectional ? 0 : cost);
+    arcCost.push_back(bidirectional ? 0 : -cost);
+}
+
+/**
+ * Builds the compressed rows (arcs leaving each node).
+ * Complexity: O(V + E) where V is the number of nodes and E is the number of arcs
+ */
+void FlowNetwork::finalize() {
+    offsets.assign(numNodes + 1, 0);
+    for(uint32_t a = 0; a < arcHead.size(); a++){
+        offsets[arcHead[a ^ 1] + 1]++;
+    }
+    for(uint32_t u = 0; u < numNodes; u++){
+        offsets[u + 1] += offsets[u];
+    }
+    adjacency.assign(arcHead.size(), 0);
+    vector<uint32_t> next(offsets.begin(), offsets.end() - 1);
+    for(uint32_t a = 0; a < arcHead.size(); a++){
+        adjacency[next[arcHead[a ^ 1]]++] = a;
+    }
+}
+
+/**
+ * Changes the capacity of a pipe (its flows are lost on the next query, unless it is augmentFlow and no capacity went below its flow).
+ * The reverse arc of a bidirectional pipe gets the same capacity.
+ * Complexity: O(1)
+ * @param pipe Index of the pipe
+ * @param capacity New capacity
+ */
+void FlowNetwork::setCapacity(uint32_t pipe, double capacity) {
+    arcCapacity[2 * pipe] = capacity;
+    if(bidirectionalPipe[pipe]) arcCapacity[2 * pipe + 1] = capacity;
+}
+
+/**
+ * Changes the cost per unit of flow of a directed pipe (bidirectional pipes have no cost).
+ * Complexity: O(1)
+ * @param pipe Index of the pipe
+ * @param cost New cost
+ */
+void FlowNetwork::setCost(uint32_t pipe, double cost) {
+    if(bidirectionalPipe[pipe]) return;
+    arcCost[2 * pipe] = cost;
+    arcCost[2 * pipe + 1] = -cost;
+}
+
+/**
+ * Finds the maximum flow between two nodes (Edmonds-Karp). The flows are stored in the workspace.
+ * Complexity: O(V E^2) where V is the number of nodes and E is the number of arcs
+ * @param source Source node
+ * @param target Target node
+ * @param ws Workspace of the query (its buffers are reused)
+ * @return Value of the maximum flow
+ */
+double FlowNetwork::maxFlow(uint32_t source, uint32_t target, Workspace &ws) const {
+    ws.flow.assign(arcHead.size(), 0);
+    return augmentFlow(source, target, ws);
+}
+
+/**
+ * Continues a max-flow query from the flows already in the workspace (Edmonds-Karp), e.g. after raising some capacities.
+ * Only the extra flow is searched for, so it costs a fraction of a new query when the capacities changed little.
+ * Complexity: O(V E^2) where V is the number of nodes and E is the number of arcs (one search per augmenting path found)
+ * @param source Source node
+ * @param target Target node
+ * @param ws Workspace of a previous query with the same source and target
+ * @return Flow added to the previous one
+ */
+double FlowNetwork::augmentFlow(uint32_t source, uint32_t target, Workspace &ws) const {
+    ws.flow.resize(arcHead.size(), 0);
+    ws.parentArc.resize(numNodes);
+    ws.visitedStamp.resize(numNodes, 0);
+    ws.queue.resize(numNodes);
+    if(source == target) return 0;
+
+    double total = 0;
+    while(findAugmentingPath(source, target, ws)){
+        double f = numeric_limits<double>::infinity();
+        for(uint32_t v = target; v != source; v = arcHead[ws.parentArc[v] ^ 1]){
+            uint32_t a = ws.parentArc[v];
+            f = min(f, arcCapacity[a] - ws.flow[a]);
+        }
+        for(uint32_t v = target; v != source; v = arcHead[ws.parentArc[v] ^ 1]){
+            uint32_t a = ws.parentArc[v];
+            ws.flow[a] += f;
+            ws.flow[a ^ 1] -= f;
+        }
+        total += f;
+    }
+    return total;
+}
+
+/**
+ * Finds a path with residual capacity from the source to the target (breadth-first search).
+ * Complexity: O(V + E) where V is the number of nodes and E is the number of arcs
+ * @param source Source node
+ * @param target Target node
+ * @param ws Workspace with the flows (the path is stored in parentArc)
+ * @return True if a path was found, false otherwise
+ */
+bool FlowNetwork::findAugmentingPath(uint32_t source, uint32_t target, Workspace &ws) const {
+    ws.generation++;
+    if(ws.generation == 0){
+        fill(ws.visitedStamp.begin(), ws.visitedStamp.end(), 0);
+        ws.generation = 1;
+    }
+
+    size_t head = 0, tail = 0;
+    ws.queue[tail++] = source;
+    ws.visitedStamp[source] = ws.generation;
+    while(head < tail){
+        uint32_t u = ws.queue[head++];
+        for(uint32_t i = offsets[u]; i < offsets[u + 1]; i++){
+            uint32_t a = adjacency[i];
+            uint32_t v = arcHead[a];
+            if(ws.visitedStamp[v] == ws.generation || arcCapacity[a] - ws.flow[a] <= 0) continue;
+            ws.visitedStamp[v] = ws.generation;
+            ws.parentArc[v] = a;
+            if(v == target) return true;
+            ws.queue[tail++] = v;
+        }
+    }
+    return false;
+}
+
+/**
+ * Gets the total capacity of the arcs that can bring flow into a node (an upper bound of any flow to it).
+ * Complexity: O(n) where n is the number of arcs of the node
+ * @param node Node
+ * @return Total capacity
+ */
+double FlowNetwork::inflowCapacity(uint32_t node) const {
+    double total = 0;
+    for(uint32_t i = offsets[node]; i < offsets[node + 1]; i++){
+        //the pair of an arc leaving the node enters it
+        total += arcCapacity[adjacency[i] ^ 1];
+    }
+    return total;
+}
+
+/**
+ * Gets the flow of a pipe after a query (positive from its origin to its destination).
+ * Complexity: O(1)
+ * @param pipe Index of the pipe
+ * @param ws Workspace of the query
+ * @return Flow of the pipe
+ */
+double FlowNetwork::arcFlow(uint32_t pipe, const Workspace &ws) const {
+    return ws.flow[2 * pipe];
+}
+
+/**
+ * Finds the nodes that can still receive flow from the source after a query (the source side of a minimum cut).
+ * Complexity: O(V + E) where V is the number of nodes and E is the number of arcs
+ * @param source Source node
+ * @param ws Workspace of the query
+ * @param minResidual Arcs with a residual capacity up to this value are considered full (rounding errors)
+ * @param reachable Set to true for the nodes reached, false for the others
+ */
+void FlowNetwork::residualReachable(uint32_t source, const Workspace &ws, double minResidual, std::vector<bool> &reachable) const {
+    reachable.assign(numNodes, false);
+    vector<uint32_t> queue;
+    queue.push_back(source);
+    reachable[source] = true;
+    for(size_t head = 0; head < queue.size(); head++){
+        uint32_t u = queue[head];
+        for(uint32_t i = offsets[u]; i < offsets[u + 1]; i++){
+            uint32_t a = adjacency[i];
+            uint32_t v = arcHead[a];
+            if(reachable[v] || arcCapacity[a] - ws.flow[a] <= minResidual) continue;
+            reachable[v] = true;
+            queue.push_back(v);
+        }
+    }
+}
+
+/**
+ * Finds the maximum flow between two nodes with the smallest total cost (successive shortest paths: Dijkstra with potentials).
+ * Costs can be negative as long as there is no cycle with a negative cost. The flows are stored in the workspace.
+ * Complexity: O(F E log V) where F is the number of augmenting paths, V is the number of nodes and E is the number of arcs
+ * @param source Source node
+ * @param target Target node
+ * @param ws Workspace of the query (its buffers are reused)
+ * @param cost Set to the total cost of the flow
+ * @return Value of the maximum flow
+ */
+double FlowNetwork::minCostMaxFlow(uint32_t source, uint32_t target, Workspace &ws, double &cost) const {
+    ws.flow.assign(arcHead.size(), 0);
+    ws.parentArc.resize(numNodes);
+    ws.visitedStamp.resize(numNodes, 0);
+    ws.queue.resize(numNodes);
+    cost = 0;
+    if(source == target) return 0;
+
+    initialPotentials(source, ws);
+    double total = 0;
+    while(findCheapestPath(source, target, ws)){
+        double f = numeric_limits<double>::infinity();
+        for(uint32_t v = target; v != source; v = arcHead[ws.parentArc[v] ^ 1]){
+            uint32_t a = ws.parentArc[v];
+            f = min(f, arcCapacity[a] - ws.flow[a]);
+        }
+        for(uint32_t v = target; v != source; v = arcHead[ws.parentArc[v] ^ 1]){
+            uint32_t a = ws.parentArc[v];
+            ws.flow[a] += f;
+            ws.flow[a ^ 1] -= f;
+            cost += f * arcCost[a];
+        }
+        total += f;
+    }
+    return total;
+}
+
+/**
+ * Sets the potential of each node to its cheapest distance from the source (Bellman-Ford with a queue), so every arc with
+ * residual capacity has a non negative reduced cost. Nodes that can't be reached get 0.
+ * Complexity: O(V E) in the worst case, O(V + E) when only the arcs reaching the target have negative costs
+ * @param source Source node
+ * @param ws Workspace of the query
+ */
+void FlowNetwork::initialPotentials(uint32_t source, Workspace &ws) const {
+    const double INF = numeric_limits<double>::infinity();
+    ws.potential.assign(numNodes, INF);
+    vector<bool> inQueue(numNodes, false);
+    vector<uint32_t> queue;
+    ws.potential[source] = 0;
+    queue.push_back(source);
+    inQueue[source] = true;
+    for(size_t head = 0; head < queue.size(); head++){
+        uint32_t u = queue[head];
+        inQueue[u] = false;
+        for(uint32_t i = offsets[u]; i < offsets[u + 1]; i++){
+            uint32_t a = adjacency[i];
+            uint32_t v = arcHead[a];
+            if(arcCapacity[a] - ws.flow[a] <= 0 || ws.potential[u] + arcCost[a] >= ws.potential[v]) continue;
+            ws.potential[v] = ws.potential[u] + arcCost[a];
+            if(!inQueue[v]){
+                inQueue[v] = true;
+                queue.push_back(v);
+            }
+        }
+    }
+    for(double &p : ws.potential){
+        if(p == INF) p = 0;
+    }
+}
+
+/**
+ * Finds the cheapest path with residual capacity from the source to the target (Dijkstra on the reduced costs) and updates the potentials.
+ * Complexity: O(E log V) where V is the number of nodes and E is the number of arcs
+ * @param source Source node
+ * @param target Target node
+ * @param ws Workspace with the flows and the potentials (the path is stored in parentArc)
+ * @return True if a path was found, false otherwise
+ */
+bool FlowNetwork::findCheapestPath(uint32_t source, uint32_t target, Workspace &ws) const {
+    const double INF = numeric_limits<double>::infinity();
+    ws.dist.assign(numNodes, INF);
+    ws.generation++;
+    if(ws.generation == 0){
+        fill(ws.visitedStamp.begin(), ws.visitedStamp.end(), 0);
+        ws.generation = 1;
+    }
+
+    typedef pair<double, uint32_t> Item;
+    priority_queue<Item, vector<Item>, greater<Item>> queue;
+    ws.dist[source] = 0;
+    queue.emplace(0, source);
+    while(!queue.empty()){
+        Item item = queue.top();
+        queue.pop();
+        uint32_t u = item.second;
+        if(ws.visitedStamp[u] == ws.generation) continue;
+        ws.visitedStamp[u] = ws.generation;
+        //the nodes not settled yet are at least as far as the target
+        if(u == target) break;
+
+        for(uint32_t i = offsets[u]; i < offsets[u + 1]; i++){
+            uint32_t a = adjacency[i];
+            uint32_t v = arcHead[a];
+            if(ws.visitedStamp[v] == ws.generation || arcCapacity[a] - ws.flow[a] <= 0) continue;
+            //rounding errors can make a reduced cost slightly negative
+            double reduced = max(0.0, arcCost[a] + ws.potential[u] - ws.potential[v]);
+            if(ws.dist[u] + reduced < ws.dist[v]){
+                ws.dist[v] = ws.dist[u] + reduced;
+                ws.parentArc[v] = a;
+                queue.emplace(ws.dist[v], v);
+            }
+        }
+    }
+    if(ws.dist[target] == INF) return false;
+
+    for(uint32_t v = 0; v < numNodes; v++){
+        ws.potential[v] += min(ws.dist[v], ws.dist[target]);
+    }
+    return true;
+}
@@ -0,0 +1,80 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#ifndef PROJECT1_FLOWNETWORK_H
+#define PROJECT1_FLOWNETWORK_H
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file FlowNetwork.h
+ * @brief Definition of class FlowNetwork.
+ *
+ * \class FlowNetwork
+ * Compact copy of a pipe network for running many max-flow queries (compressed sparse rows, 32 bit indexes).
+ * Every pipe is a pair of arcs (arc a and its pair a ^ 1): a directed pipe has a reverse arc with no capacity, a bidirectional pipe
+ * has a reverse arc with the same capacity, which gives the shared capacity of the Graph edges.
+ * Pipes can have a cost per unit of flow (min-cost queries); the reverse arc of a directed pipe has the opposite cost, bidirectional pipes have no cost.
+ * The network is never changed by a query: the flows are kept in a Workspace, so several threads can solve queries at the same time,
+ * each one with its own workspace (reused between its queries).
+ */
+class FlowNetwork {
+public:
+    /**
+     * \struct Workspace
+     * Flow of each arc and the search state of a max-flow query.
+     */
+    struct Workspace {
+        std::vector<double> flow;
+        std::vector<uint32_t> parentArc;
+        std::vector<uint32_t> visitedStamp;
+        std::vector<uint32_t> queue;
+        uint32_t generation = 0;
+        std::vector<double> potential;  // min-cost queries
+        std::vector<double> dist;
+    };
+
+    uint32_t addNode();
+    void addPipe(uint32_t origin, uint32_t destination, double capacity, bool bidirectional, double cost = 0);
+    void finalize();
+    void setCapacity(uint32_t pipe, double capacity);
+    void setCost(uint32_t pipe, double cost);
+
+    double maxFlow(uint32_t source, uint32_t target, Workspace &ws) const;
+    double augmentFlow(uint32_t source, uint32_t target, Workspace &ws) const;
+    double minCostMaxFlow(uint32_t source, uint32_t target, Workspace &ws, double &cost) const;
+    double inflowCapacity(uint32_t node) const;
+    double arcFlow(uint32_t pipe, const Workspace &ws) const;
+    void residualReachable(uint32_t source, const Workspace &ws, double minResidual, std::vector<bool> &reachable) const;
+
+    /**
+     * Gets the number of nodes.
+     * Complexity: O(1)
+     * @return Number of nodes
+     */
+    uint32_t getNumNodes() const { return numNodes; }
+    /**
+     * Gets the number of pipes (pairs of arcs).
+     * Complexity: O(1)
+     * @return Number of pipes
+     */
+    uint32_t getNumPipes() const { return arcHead.size() / 2; }
+
+private:
+    bool findAugmentingPath(uint32_t source, uint32_t target, Workspace &ws) const;
+    void initialPotentials(uint32_t source, Workspace &ws) const;
+    bool findCheapestPath(uint32_t source, uint32_t target, Workspace &ws) const;
+
+    uint32_t numNodes = 0;
+    std::vector<uint32_t> arcHead;      // destination of each arc
+    std::vector<double> arcCapacity;    // capacity of each arc
+    std::vector<bool> bidirectionalPipe;
+    std::vector<double> arcCost;        // cost per unit of flow of each arc
+    std::vector<uint32_t> offsets;      // arcs leaving node u are adjacency[offsets[u]..offsets[u + 1]]
+    std::vector<uint32_t> adjacency;
+};
+
+
+#endif //PROJECT1_FLOWNETWORK_H
@@ -0,0 +1,109 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#include "FlowSnapshot.h"
+
+using namespace std;
+
+/** @file FlowSnapshot.cpp
+ *  @brief Implementation of FlowSnapshot class
+ */
+
+/**
+ * Creates a snapshot and indexes its cities and pipes.
+ * Complexity: O(c + p) where c is the number of cities and p is the number of pipes
+ * @param epoch Epoch of the snapshot
+ * @param cities Water received by each city
+ * @param pipes Flow of each pipe
+ */
+FlowSnapshot::FlowSnapshot(uint64_t epoch, std::vector<CityFlow> cities_, std::vector<PipeFlow> pipes_)
+    : epoch(epoch), cities(std::move(cities_)), pipes(std::move(pipes_)) {
+    cityIndex.reserve(cities.size());
+    for(size_t i = 0; i < cities.size(); i++){
+        cityIndex.emplace(cities[i].code, i);
+        totalFlow += cities[i].received;
+    }
+    pipeIndex.reserve(pipes.size());
+    for(size_t i = 0; i < pipes.size(); i++){
+        pipeIndex.emplace(pipeKey(pipes[i].origin, pipes[i].destination), i);
+    }
+}
+
+/**
+ * Calculates the flow deficit of a city.
+ * Complexity: O(1)
+ * @param cityCode Code of the city
+ * @return Deficit of the city (0 if the city is not in the snapshot)
+ */
+double FlowSnapshot::flowDeficit(const std::string &cityCode) const {
+    auto search = cityIndex.find(cityCode);
+    if(search == cityIndex.end()) return 0;
+    const CityFlow &city = cities[search->second];
+    return city.demand - city.received;
+}
+
+/**
+ * Gets the water received by a city.
+ * Complexity: O(1)
+ * @param cityCode Code of the city
+ * @return Water received (0 if the city is not in the snapshot)
+ */
+double FlowSnapshot::receivedFlow(const std::string &cityCode) const {
+    auto search = cityIndex.find(cityCode);
+    return search == cityIndex.end() ? 0 : cities[search->second].received;
+}
+
+/**
+ * Gets the flow of a pipe, seen from the given origin (bidirectional pipes can be asked in both directions).
+ * Complexity: O(1)
+ * @param origin Code of the origin
+ * @param destination Code of the destination
+ * @return Flow from origin to destination (0 if the pipe is not in the snapshot)
+ */
+double FlowSnapshot::pipeFlow(const std::string &origin, const std::string &destination) const {
+    auto search = pipeIndex.find(pipeKey(origin, destination));
+    if(search != pipeIndex.end()) return pipes[search->second].flow;
+
+    search = pipeIndex.find(pipeKey(destination, origin));
+    if(search != pipeIndex.end() && pipes[search->second].bidirectional) return -pipes[search->second].flow;
+    return 0;
+}
+
+/**
+ * Finds the cities that do not receive all the water they need.
+ * Complexity: O(c) where c is the number of cities
+ * @return Vector with a pair code/received water of each city with deficit
+ */
+std::vector<std::pair<std::string, double>> FlowSnapshot::affectedCities() const {
+    vector<pair<string, double>> res;
+    for(const CityFlow &city : cities){
+        if(city.demand - city.received > 0) res.emplace_back(city.code, city.received);
+    }
+    return res;
+}
+
+/**
+ * Gets the water received by every city.
+ * Complexity: O(c) where c is the number of cities
+ * @return Vector with a pair code/received water of each city
+ */
+std::vector<std::pair<std::string, double>> FlowSnapshot::cityFlows() const {
+    vector<pair<string, double>> res;
+    res.reserve(cities.size());
+    for(const CityFlow &city : cities){
+        res.emplace_back(city.code, city.received);
+    }
+    return res;
+}
+
+/**
+ * Builds the key used to index a pipe.
+ * Complexity: O(n) where n is the size of the codes
+ * @param origin Code of the origin
+ * @param destination Code of the destination
+ * @return Key of the pipe
+ */
+std::string FlowSnapshot::pipeKey(const std::string &origin, const std::string &destination) {
+    return origin + '\n' + destination;
+}
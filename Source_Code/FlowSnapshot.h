@@ -0,0 +1,91 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#ifndef PROJECT1_FLOWSNAPSHOT_H
+#define PROJECT1_FLOWSNAPSHOT_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @file FlowSnapshot.h
+ * @brief Definition of class FlowSnapshot.
+ *
+ * \class FlowSnapshot
+ * Immutable copy of the results of a max-flow solve (water received by each city and flow of each pipe).
+ * A snapshot never changes after being built, so any number of threads can query it without locks while
+ * the network is being changed or solved again. Each published snapshot has a bigger epoch than the previous one.
+ */
+class FlowSnapshot {
+public:
+    /**
+     * \struct CityFlow
+     * Water received by a city.
+     */
+    struct CityFlow {
+        std::string code;
+        double demand;
+        double received;
+    };
+
+    /**
+     * \struct PipeFlow
+     * Flow of a pipe (positive from origin to destination, negative only in bidirectional pipes).
+     */
+    struct PipeFlow {
+        std::string origin;
+        std::string destination;
+        double capacity;
+        double flow;
+        bool bidirectional;
+    };
+
+    FlowSnapshot(uint64_t epoch, std::vector<CityFlow> cities, std::vector<PipeFlow> pipes);
+
+    double flowDeficit(const std::string &cityCode) const;
+    double receivedFlow(const std::string &cityCode) const;
+    double pipeFlow(const std::string &origin, const std::string &destination) const;
+    std::vector<std::pair<std::string, double>> affectedCities() const;
+    std::vector<std::pair<std::string, double>> cityFlows() const;
+
+    /**
+     * Gets the epoch of the snapshot (number of the publication that created it).
+     * Complexity: O(1)
+     * @return Epoch of the snapshot
+     */
+    uint64_t getEpoch() const { return epoch; }
+    /**
+     * Gets the total flow that reaches the cities.
+     * Complexity: O(1)
+     * @return Total flow
+     */
+    double getTotalFlow() const { return totalFlow; }
+    /**
+     * Gets the flows of every city.
+     * Complexity: O(1)
+     * @return Flows of the cities
+     */
+    const std::vector<CityFlow> &getCities() const { return cities; }
+    /**
+     * Gets the flows of every pipe.
+     * Complexity: O(1)
+     * @return Flows of the pipes
+     */
+    const std::vector<PipeFlow> &getPipes() const { return pipes; }
+
+private:
+    static std::string pipeKey(const std::string &origin, const std::string &destination);
+
+    const uint64_t epoch;
+    const std::vector<CityFlow> cities;
+    const std::vector<PipeFlow> pipes;
+    double totalFlow = 0;
+    std::unordered_map<std::string, std::size_t> cityIndex;
+    std::unordered_map<std::string, std::size_t> pipeIndex;
+};
+
+
+#endif //PROJECT1_FLOWSNAPSHOT_H
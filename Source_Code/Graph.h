@@ -7,13 +7,21 @@
 #include <iostream>
 #include <vector>
 #include <queue>
+#include <unordered_map>
 #include <limits>
 #include <algorithm>
+#include <cstdint>
+#include <new>
 #include "VertexType.h"
+#include "TraversalWorkspace.h"
+#include "MemoryUsage.h"
 
 template <class T>
 class Edge;
 
+template <class T>
+class Graph;
+
 /************************* Vertex  **************************/
 
 template <class T>
@@ -23,42 +31,30 @@ public:
     T getInfo() const;
     VertexType getType() const;
     std::vector<Edge<T> *> getAdj() const;
-    bool isVisited() const;
-    bool isProcessing() const;
-    unsigned int getIndegree() const;
-    double getDist() const;
-    Edge<T> *getPath() const;
     std::vector<Edge<T> *> getIncoming() const;
+    unsigned int getIndex() const;
+    std::size_t memoryUsage() const;
 
     void setInfo(T info);
-    void setVisited(bool visited);
-    void setProcesssing(bool processing);
-    void setIndegree(unsigned int indegree);
-    void setDist(double dist);
-    void setPath(Edge<T> *path);
+    void setIndex(unsigned int index);
     Edge<T> * addEdge(Vertex<T> *dest, double w);
     bool removeEdge(T in);
+    bool removeEdge(Edge<T> *edge);
     void removeOutgoingEdges();
-    bool operator<(Vertex<T> & vertex) const;
 
 protected:
     T info;                // info node
     std::vector<Edge<T> *> adj;  // outgoing edges
     VertexType type;
 
-
-    // auxiliary fields
-    bool visited = false; // used by DFS, BFS, Prim ...
-    bool processing = false; // used by isDAG (in addition to the visited attribute)
-    unsigned int indegree; // used by topsort
-    double dist = 0;
-    Edge<T> *path = nullptr;
+    // position in the vertex set, used to index the traversal state (see TraversalWorkspace)
+    unsigned int index = 0;
 
     std::vector<Edge<T> *> incoming; // incoming edges
 
-    int queueIndex = 0; 		// required by MutablePriorityQueue and UFDS
-
     void deleteEdge(Edge<T> *edge);
+
+    friend class Graph<T>;
 };
 
 /********************** Edge  ****************************/
@@ -74,24 +70,38 @@ public:
     Vertex<T> * getOrig() const;
     Edge<T> *getReverse() const;
     double getFlow() const;
+    bool isBidirectional() const;
+    Vertex<T> *getOther(const Vertex<T> *v) const;
+    double getResidual(const Vertex<T> *from) const;
+    double getCost() const;
 
     void setSelected(bool selected);
     void setReverse(Edge<T> *reverse);
     void setFlow(double flow);
     void setWeight(double weight);
+    void setBidirectional(bool bidirectional);
+    void setCost(double cost);
+    void addFlowFrom(const Vertex<T> *from, double f);
+
+    static void destroy(Edge<T> *edge);
 
 protected:
     Vertex<T> * dest; // destination vertex
     double weight; // edge weight, can also be used for capacity
-
-    // auxiliary fields
-    bool selected = false;
+    double cost = 0; // cost per unit of flow (pumping energy, head loss...), in either direction
 
     // used for bidirectional edges
     Vertex<T> *orig;
     Edge<T> *reverse = nullptr;
 
-    double flow; // for flow-related problems
+    double flow; // for flow-related problems (negative if a bidirectional edge is used from dest to orig)
+
+    // flags are kept together so the edge has no padding between them
+    bool selected = false; // auxiliary field
+    bool bidirectional = false; // a single edge that can be used both ways, sharing its weight (capacity)
+    bool pooled = false; // lives in the block of a cloned graph (see Graph::cloneFrom), so it is destroyed but not deleted
+
+    friend class Graph<T>;
 };
 
 /********************** Graph  ****************************/
@@ -99,7 +109,12 @@ protected:
 template <class T>
 class Graph {
 public:
+    Graph() = default;
+    Graph(const Graph<T> &other);
+    Graph(Graph<T> &&other) noexcept;
+    Graph<T> &operator=(Graph<T> other);
     ~Graph();
+    void swap(Graph<T> &other) noexcept;
     /*
     * Auxiliary function to find a vertex with a given the content.
     */
@@ -118,25 +133,56 @@ public:
      */
     bool addEdge(const T &sourc, const T &dest, double w);
     bool removeEdge(const T &source, const T &dest);
+    bool removeEdge(Edge<T> *edge);
     bool addBidirectionalEdge(const T &sourc, const T &dest, double w);
+    bool addUndirectedEdge(const T &sourc, const T &dest, double w);
 
     int getNumVertex() const;
+    int getNumEdges() const;
     std::vector<Vertex<T> *> getVertexSet() const;
 
     std:: vector<T> dfs() const;
     std:: vector<T> dfs(const T & source) const;
-    void dfsVisit(Vertex<T> *v,  std::vector<T> & res) const;
+    void dfsVisit(Vertex<T> *v, TraversalWorkspace<T> &ws, std::vector<T> & res) const;
     std::vector<T> bfs(const T & source) const;
 
     bool isDAG() const;
-    bool dfsIsDAG(Vertex<T> *v) const;
+    bool dfsIsDAG(Vertex<T> *v, TraversalWorkspace<T> &ws) const;
     std::vector<T> topsort() const;
+
+    unsigned int scc(std::vector<unsigned int> &component) const;
+
+    void memoryUsage(std::size_t &vertexBytes, std::size_t &edgeBytes) const;
 protected:
+    /**
+     * \struct DfsFrame
+     * Vertex in the explicit stack of the iterative dfs and the position of the next edge to follow.
+     * The edge lists are the ones of the vertex (the graph is not changed during a traversal), not copies.
+     */
+    struct DfsFrame {
+        explicit DfsFrame(Vertex<T> *v) : vertex(v), adj(v->adj), incoming(v->incoming) {}
+        Vertex<T> *vertex;
+        const std::vector<Edge<T> *> &adj;
+        const std::vector<Edge<T> *> &incoming;
+        std::size_t adjPos = 0;
+        std::size_t incomingPos = 0;
+    };
+
+    Vertex<T> *nextUnvisited(DfsFrame &frame, const TraversalWorkspace<T> &ws) const;
+
+    void cloneFrom(const Graph<T> &other);
+    void destroyVertex(Vertex<T> *v);
+
     std::vector<Vertex<T> *> vertexSet;    // vertex set
+    std::unordered_map<T, Vertex<T> *> vertexIndex;    // info -> vertex, keeps findVertex O(1)
 
     double ** distMatrix = nullptr;   // dist matrix for Floyd-Warshall
     int **pathMatrix = nullptr;   // path matrix for Floyd-Warshall
 
+    // vertexes and edges of a clone live in this single allocation (vertexes first, then edges), see cloneFrom
+    char *block = nullptr;
+    std::size_t blockVertexBytes = 0;
+
     /*
      * Finds the index of the vertex with a given content.
      */
@@ -166,7 +212,6 @@ Edge<T> * Vertex<T>::addEdge(Vertex<T> *d, double w) {
     auto newEdge = new Edge<T>(this, d, w);
     adj.push_back(newEdge);
     d->incoming.push_back(newEdge);
-    d->setIndegree(d->getIndegree() + 1);
     return newEdge;
 }
 
@@ -197,6 +242,22 @@ bool Vertex<T>::removeEdge(T in) {
     return removedEdge;
 }
 
+/**
+ * Removes one outgoing edge of a vertex (the other edges to the same destination are kept).
+ * Complexity: O(E) where E is the number of outgoing edges of the vertex / incoming edges of the destination vertex.
+ * @tparam T Type to the class
+ * @param edge Edge to remove
+ * @return true if successful, and false if the edge doesn't leave this vertex.
+ */
+template <class T>
+bool Vertex<T>::removeEdge(Edge<T> *edge) {
+    auto it = std::find(adj.begin(), adj.end(), edge);
+    if (it == adj.end()) return false;
+    adj.erase(it);
+    deleteEdge(edge);
+    return true;
+}
+
 /**
  * Auxiliary function to remove an outgoing edge of a vertex.
  * Complexity: O(E^2) where E is the number of outgoing edges of the source vertex / incoming edges of the destination vertex.
@@ -212,11 +273,6 @@ void Vertex<T>::removeOutgoingEdges() {
     }
 }
 
-template <class T>
-bool Vertex<T>::operator<(Vertex<T> & vertex) const {
-    return this->dist < vertex.dist;
-}
-
 /**
  * Gets the vertex's information.
  * Complexity: O(1)
@@ -251,58 +307,25 @@ std::vector<Edge<T>*> Vertex<T>::getAdj() const {
 }
 
 /**
- * Gets the vertex's visited state.
- * Complexity: O(1)
- * @tparam T Type of the class
- * @return Vertex's visited state
- */
-template <class T>
-bool Vertex<T>::isVisited() const {
-    return this->visited;
-}
-
-/**
- * Gets the vertex's processing state.
- * Complexity: O(1)
- * @tparam T Type of the class
- * @return Vertex's processing state
- */
-template <class T>
-bool Vertex<T>::isProcessing() const {
-    return this->processing;
-}
-
-/**
- * Gets the vertex's indegree.
+ * Gets the vertex's position in the vertex set of its graph.
  * Complexity: O(1)
  * @tparam T Type of the class
- * @return Vertex's indegree.
+ * @return Vertex's index
  */
 template <class T>
-unsigned int Vertex<T>::getIndegree() const {
-    return this->indegree;
+unsigned int Vertex<T>::getIndex() const {
+    return this->index;
 }
 
 /**
- * Gets the vertex's distance from a given vertex.
+ * Gets the memory used by the vertex (the vertex, its info and its edge lists, not the edges themselves).
  * Complexity: O(1)
  * @tparam T Type of the class
- * @return Vertex's distance
+ * @return Bytes used
  */
 template <class T>
-double Vertex<T>::getDist() const {
-    return this->dist;
-}
-
-/**
- * Gets the edge corresponding to a path.
- * Complexity: O(1)
- * @tparam T Type of the class
- * @return Edge corresponding to a path.
- */
-template <class T>
-Edge<T> *Vertex<T>::getPath() const {
-    return this->path;
+std::size_t Vertex<T>::memoryUsage() const {
+    return sizeof(Vertex<T>) + MemoryUsage::heapBytes(info) + MemoryUsage::heapBytes(adj) + MemoryUsage::heapBytes(incoming);
 }
 
 /**
@@ -328,58 +351,14 @@ void Vertex<T>::setInfo(T in) {
 }
 
 /**
- * Sets the vertex's visited state.
- * Complexity: O(1)
- * @tparam T Type of the class
- * @param visited New visited state for the vertex.
- */
-template <class T>
-void Vertex<T>::setVisited(bool visited) {
-    this->visited = visited;
-}
-
-/**
- * Sets the vertex's processing state.
+ * Sets the vertex's position in the vertex set of its graph.
  * Complexity: O(1)
  * @tparam T Type of the class
- * @param processing New processing state for the vertex.
- */
-template <class T>
-void Vertex<T>::setProcesssing(bool processing) {
-    this->processing = processing;
-}
-
-/**
- * Sets the vertex's indegree.
- * Complexity: O(1)
- * @tparam T Type of the class
- * @param indegree New indegree for the vertex.
- */
-template <class T>
-void Vertex<T>::setIndegree(unsigned int indegree) {
-    this->indegree = indegree;
-}
-
-/**
- * Sets the vertex's distance to another vertex.
- * Complexity: O(1)
- * @tparam T Type fo the class.
- * @param dist New distance value.
+ * @param index New index for the vertex.
  */
 template <class T>
-void Vertex<T>::setDist(double dist) {
-    this->dist = dist;
-}
-
-/**
- * Sets the vertex's path.
- * Complexity: O(1)
- * @tparam T Type fo the class.
- * @param path New path.
- */
-template <class T>
-void Vertex<T>::setPath(Edge<T> *path) {
-    this->path = path;
+void Vertex<T>::setIndex(unsigned int index) {
+    this->index = index;
 }
 
 /**
@@ -394,14 +373,14 @@ void Vertex<T>::deleteEdge(Edge<T> *edge) {
     // Remove the corresponding edge from the incoming list
     auto it = dest->incoming.begin();
     while (it != dest->incoming.end()) {
-        if ((*it)->getOrig()->getInfo() == info) {
+        if (*it == edge) {
             it = dest->incoming.erase(it);
         }
         else {
             it++;
         }
     }
-    delete edge;
+    Edge<T>::destroy(edge);
 }
 
 /********************** Edge  ****************************/
@@ -409,6 +388,18 @@ void Vertex<T>::deleteEdge(Edge<T> *edge) {
 template <class T>
 Edge<T>::Edge(Vertex<T> *orig, Vertex<T> *dest, double w): orig(orig), dest(dest), weight(w) {}
 
+/**
+ * Frees an edge, created on its own or in the block of a cloned graph.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param edge Edge to free
+ */
+template <class T>
+void Edge<T>::destroy(Edge<T> *edge) {
+    if (edge->pooled) edge->~Edge();
+    else delete edge;
+}
+
 /**
  * Gets the edge's destination.
  * Complexity: O(1)
@@ -474,6 +465,57 @@ double Edge<T>::getFlow() const {
     return flow;
 }
 
+/**
+ * Checks if the edge can be used both ways (a single edge sharing its weight).
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @return True if the edge is bidirectional, false otherwise
+ */
+template <class T>
+bool Edge<T>::isBidirectional() const {
+    return this->bidirectional;
+}
+
+/**
+ * Gets the endpoint of the edge that is not the given vertex.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param v One of the endpoints of the edge
+ * @return The other endpoint
+ */
+template <class T>
+Vertex<T> *Edge<T>::getOther(const Vertex<T> *v) const {
+    return v == this->orig ? this->dest : this->orig;
+}
+
+/**
+ * Gets the residual capacity of the edge when it is used starting at a given endpoint.
+ * From the origin it is weight - flow. From the destination it is the flow that can be cancelled,
+ * plus the weight if the edge is bidirectional.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param from Endpoint where the edge is used from
+ * @return Residual capacity
+ */
+template <class T>
+double Edge<T>::getResidual(const Vertex<T> *from) const {
+    if (from == this->orig) {
+        return this->weight - this->flow;
+    }
+    return this->bidirectional ? this->weight + this->flow : this->flow;
+}
+
+/**
+ * Gets the cost per unit of flow of the edge.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @return Cost per unit of flow
+ */
+template <class T>
+double Edge<T>::getCost() const {
+    return this->cost;
+}
+
 /**
  * Sets the selected status.
  * Complexity: O(1)
@@ -518,6 +560,46 @@ void Edge<T>::setWeight(double weight) {
     this->weight = weight;
 }
 
+/**
+ * Sets the cost per unit of flow of the edge.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param cost New cost
+ */
+template <class T>
+void Edge<T>::setCost(double cost) {
+    this->cost = cost;
+}
+
+/**
+ * Sets if the edge can be used both ways.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param bidirectional New bidirectional status
+ */
+template <class T>
+void Edge<T>::setBidirectional(bool bidirectional) {
+    this->bidirectional = bidirectional;
+}
+
+/**
+ * Sends flow through the edge starting at a given endpoint (from the destination it cancels flow or,
+ * for bidirectional edges, sends flow from the destination to the origin).
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param from Endpoint where the flow enters the edge
+ * @param f Amount of flow
+ */
+template <class T>
+void Edge<T>::addFlowFrom(const Vertex<T> *from, double f) {
+    if (from == this->orig) {
+        this->flow += f;
+    }
+    else {
+        this->flow -= f;
+    }
+}
+
 /********************** Graph  ****************************/
 
 /**
@@ -531,6 +613,19 @@ int Graph<T>::getNumVertex() const {
     return vertexSet.size();
 }
 
+/**
+ * Gets the number of edges (each edge counts once, bidirectional ones included).
+ * Complexity: O(V) where V is the number of vertexes
+ * @tparam T Type of the class
+ * @return  Number of Edges
+ */
+template <class T>
+int Graph<T>::getNumEdges() const {
+    int numEdges = 0;
+    for(const Vertex<T> *v : vertexSet) numEdges += v->adj.size();
+    return numEdges;
+}
+
 /**
  * Gets the vector with the vertexes.
  * Complexity: O(1)
@@ -544,35 +639,31 @@ std::vector<Vertex<T> *> Graph<T>::getVertexSet() const {
 
 /**
  * Auxiliary function to find a vertex with a given content.
- * Complexity: O(v) where v is the number of vertexes
+ * Complexity: O(1) on average
  * @param in Info of the vertex to find.
  * @return Pointer to the vertex found or nullptr if the vertex doesn't exists.
  */
 template <class T>
 Vertex<T> * Graph<T>::findVertex(const T &in) const {
-    for (auto v : vertexSet)
-        if (v->getInfo() == in)
-            return v;
-    return nullptr;
+    auto search = vertexIndex.find(in);
+    return search == vertexIndex.end() ? nullptr : search->second;
 }
 
 /**
  * Finds the index of the vertex with a given content.
- * Complexity: O(v) where v is the number of vertexes
+ * Complexity: O(1) on average
  * @param in Info of the vertex to find.
  * @return Index of the vertex or -1 if it doesn't exists
  */
 template <class T>
 int Graph<T>::findVertexIdx(const T &in) const {
-    for (unsigned i = 0; i < vertexSet.size(); i++)
-        if (vertexSet[i]->getInfo() == in)
-            return i;
-    return -1;
+    auto v = findVertex(in);
+    return v == nullptr ? -1 : v->getIndex();
 }
 
 /**
  *  Adds a vertex with a given content or info (in) to a graph (this).
- *  Complexity: O(v) where v is the number of vertexes in the graph.
+ *  Complexity: O(1) on average
  *  @param in Info of the vertex.
  *  @param type Type of hte new vertex.
  *  @return true if successful, and false if a vertex with that content already exists.
@@ -581,7 +672,10 @@ template <class T>
 bool Graph<T>::addVertex(const T &in, VertexType type) {
     if (findVertex(in) != nullptr)
         return false;
-    vertexSet.push_back(new Vertex<T>(in,type));
+    auto v = new Vertex<T>(in,type);
+    v->setIndex(vertexSet.size());
+    vertexSet.push_back(v);
+    vertexIndex.emplace(in, v);
     return true;
 }
 
@@ -601,8 +695,13 @@ bool Graph<T>::removeVertex(const T &in) {
             for (auto u : vertexSet) {
                 u->removeEdge(v->getInfo());
             }
-            vertexSet.erase(it);
-            delete v;
+            it = vertexSet.erase(it);
+            vertexIndex.erase(v->getInfo());
+            destroyVertex(v);
+            // the vertexes after the removed one moved one position
+            for (; it != vertexSet.end(); it++) {
+                (*it)->setIndex((*it)->getIndex() - 1);
+            }
             return true;
         }
     }
@@ -612,7 +711,7 @@ bool Graph<T>::removeVertex(const T &in) {
 /**
  * Adds an edge to a graph (this), given the contents of the source and
  * destination vertices and the edge weight (w).
- * Complexity: O(v) where v is the number of vertexes in the graph.
+ * Complexity: O(1) on average
  * @param dest info of the vertex that is the destination of the edge
  * @param sourc info of the vertex that is the source of the edge
  * @param w weight of the new edge.
@@ -645,9 +744,21 @@ bool Graph<T>::removeEdge(const T &sourc, const T &dest) {
     return srcVertex->removeEdge(dest);
 }
 
+/**
+ * Removes one edge from a graph (this), keeping the other edges between the same vertexes.
+ * Complexity: O(E) where E is the number of edges of its source and destination.
+ * @param edge Edge to remove
+ * @return true if successful, and false if the edge is null.
+ */
+template <class T>
+bool Graph<T>::removeEdge(Edge<T> *edge) {
+    if (edge == nullptr) return false;
+    return edge->getOrig()->removeEdge(edge);
+}
+
 /**
  * Adds a bidirectional edge.
- * Complexity: O(V) where v is the number of vertexes.
+ * Complexity: O(1) on average
  * @tparam T Type of class
  * @param sourc Source of the edge
  * @param dest Destination of the edge
@@ -667,6 +778,27 @@ bool Graph<T>::addBidirectionalEdge(const T &sourc, const T &dest, double w) {
     return true;
 }
 
+/**
+ * Adds an undirected edge: a single edge that can be used both ways and shares its weight (capacity).
+ * It is stored in the outgoing edges of the source and in the incoming edges of the destination.
+ * Complexity: O(1) on average
+ * @tparam T Type of class
+ * @param sourc Source of the edge
+ * @param dest Destination of the edge
+ * @param w Weight of the edge
+ * @return False if one of the vertexes (source or destination) doesn't exists. True otherwise
+ */
+template <class T>
+bool Graph<T>::addUndirectedEdge(const T &sourc, const T &dest, double w) {
+    auto v1 = findVertex(sourc);
+    auto v2 = findVertex(dest);
+    if (v1 == nullptr || v2 == nullptr)
+        return false;
+    auto e = v1->addEdge(v2, w);
+    e->setBidirectional(true);
+    return true;
+}
+
 /****************** DFS ********************/
 
 /**
@@ -677,11 +809,10 @@ bool Graph<T>::addBidirectionalEdge(const T &sourc, const T &dest, double w) {
 template <class T>
 std::vector<T> Graph<T>::dfs() const {
     std::vector<T> res;
+    TraversalWorkspace<T> ws(vertexSet.size());
     for (auto v : vertexSet)
-        v->setVisited(false);
-    for (auto v : vertexSet)
-        if (!v->isVisited())
-            dfsVisit(v, res);
+        if (!ws.isVisited(v))
+            dfsVisit(v, ws, res);
     return res;
 }
 
@@ -692,39 +823,65 @@ std::vector<T> Graph<T>::dfs() const {
  */
 template <class T>
 std::vector<T> Graph<T>::dfs(const T & source) const {
-    std::vector<int> res;
+    std::vector<T> res;
     // Get the source vertex
     auto s = findVertex(source);
     if (s == nullptr) {
         return res;
     }
-    // Set that no vertex has been visited yet
-    for (auto v : vertexSet) {
-        v->setVisited(false);
-    }
-    // Perform the actual DFS using recursion
-    dfsVisit(s, res);
+    // No vertex has been visited yet in a new workspace
+    TraversalWorkspace<T> ws(vertexSet.size());
+    // Perform the actual DFS using an explicit stack
+    dfsVisit(s, ws, res);
 
     return res;
 }
 
 /**
- * Auxiliary function that visits a vertex (v) and its adjacent, recursively.
+ * Auxiliary function that visits a vertex (v) and everything reachable from it, in the same order as a recursive dfs.
+ * Uses an explicit stack instead of recursion, so very deep graphs (long chains) don't overflow the call stack.
  * Updates a parameter with the list of visited node contents.
  * Complexity: O(V + E)
- * @param v vertex we are now visiting
+ * @param v vertex where the visit starts
+ * @param ws traversal state (visited vertexes)
  * @param res vector with the vertex visited in DFS order
  */
 template <class T>
-void Graph<T>::dfsVisit(Vertex<T> *v, std::vector<T> & res) const {
-    v->setVisited(true);
+void Graph<T>::dfsVisit(Vertex<T> *v, TraversalWorkspace<T> &ws, std::vector<T> & res) const {
+    std::vector<DfsFrame> stack;
+    ws.setVisited(v, true);
     res.push_back(v->getInfo());
-    for (auto & e : v->getAdj()) {
-        auto w = e->getDest();
-        if (!w->isVisited()) {
-            dfsVisit(w, res);
+    stack.emplace_back(v);
+    while (!stack.empty()) {
+        Vertex<T> *w = nextUnvisited(stack.back(), ws);
+        if (w == nullptr) {
+            stack.pop_back();
+            continue;
         }
+        ws.setVisited(w, true);
+        res.push_back(w->getInfo());
+        stack.emplace_back(w);
+    }
+}
+
+/**
+ * Advances a dfs frame to the next neighbour that wasn't visited yet (outgoing edges first, then bidirectional incoming edges).
+ * Complexity: O(n) where n is the number of edges skipped
+ * @param frame Frame of the vertex being visited
+ * @param ws traversal state (visited vertexes)
+ * @return Next neighbour to visit or nullptr if every neighbour was visited
+ */
+template <class T>
+Vertex<T> *Graph<T>::nextUnvisited(DfsFrame &frame, const TraversalWorkspace<T> &ws) const {
+    while (frame.adjPos < frame.adj.size()) {
+        auto w = frame.adj[frame.adjPos++]->getDest();
+        if (!ws.isVisited(w)) return w;
     }
+    while (frame.incomingPos < frame.incoming.size()) {
+        auto e = frame.incoming[frame.incomingPos++];
+        if (e->isBidirectional() && !ws.isVisited(e->getOrig())) return e->getOrig();
+    }
+    return nullptr;
 }
 
 /****************** BFS ********************/
@@ -737,31 +894,36 @@ void Graph<T>::dfsVisit(Vertex<T> *v, std::vector<T> & res) const {
  */
 template <class T>
 std::vector<T> Graph<T>::bfs(const T & source) const {
-    std::vector<int> res;
+    std::vector<T> res;
     // Get the source vertex
     auto s = findVertex(source);
     if (s == nullptr) {
         return res;
     }
 
-    // Set that no vertex has been visited yet
-    for (auto v : vertexSet) {
-        v->setVisited(false);
-    }
+    // No vertex has been visited yet in a new workspace
+    TraversalWorkspace<T> ws(vertexSet.size());
 
     // Perform the actual BFS using a queue
     std::queue<Vertex<T> *> q;
     q.push(s);
-    s->setVisited(true);
+    ws.setVisited(s, true);
     while (!q.empty()) {
         auto v = q.front();
         q.pop();
         res.push_back(v->getInfo());
         for (auto & e : v->getAdj()) {
             auto w = e->getDest();
-            if ( ! w->isVisited()) {
+            if ( ! ws.isVisited(w)) {
                 q.push(w);
-                w->setVisited(true);
+                ws.setVisited(w, true);
+            }
+        }
+        for (auto & e : v->getIncoming()) {
+            auto w = e->getOrig();
+            if (e->isBidirectional() && ! ws.isVisited(w)) {
+                q.push(w);
+                ws.setVisited(w, true);
             }
         }
     }
@@ -773,43 +935,54 @@ std::vector<T> Graph<T>::bfs(const T & source) const {
  * Performs a depth-first search in a graph (this), to determine if the graph
  * is acyclic (acyclic directed graph or DAG).
  * During the search, a cycle is found if an edge connects to a vertex
- * that is being processed in the stack of recursive calls (see theoretical classes).
+ * that is being processed in the dfs stack (see theoretical classes).
  * Complexity: O(V + E)
  * @return true if the graph is acyclic, and false otherwise.
  */
 
 template <class T>
 bool Graph<T>::isDAG() const {
+    TraversalWorkspace<T> ws(vertexSet.size());
     for (auto v : vertexSet) {
-        v->setVisited(false);
-        v->setProcesssing(false);
-    }
-    for (auto v : vertexSet) {
-        if (! v->isVisited()) {
-            if ( ! dfsIsDAG(v) ) return false;
+        if (! ws.isVisited(v)) {
+            if ( ! dfsIsDAG(v, ws) ) return false;
         }
     }
     return true;
 }
 
 /**
- * Auxiliary function that visits a vertex (v) and its adjacent, recursively.
+ * Auxiliary function that visits a vertex (v) and everything reachable from it, using an explicit stack (same order as a recursive dfs).
  * Complexity: O(V + E)
- * @param v vertex we are visiting
+ * @param v vertex where the visit starts
+ * @param ws traversal state (visited and processing vertexes)
  * @return false (not acyclic) if an edge to a vertex in the stack is found.
  */
 template <class T>
-bool Graph<T>::dfsIsDAG(Vertex<T> *v) const {
-    v->setVisited(true);
-    v->setProcesssing(true);
-    for (auto e : v->getAdj()) {
-        auto w = e->getDest();
-        if (w->isProcessing()) return false;
-        if (! w->isVisited()) {
-            if (! dfsIsDAG(w)) return false;
+bool Graph<T>::dfsIsDAG(Vertex<T> *v, TraversalWorkspace<T> &ws) const {
+    std::vector<DfsFrame> stack;
+    ws.setVisited(v, true);
+    ws.setProcessing(v, true);
+    stack.emplace_back(v);
+    while (!stack.empty()) {
+        DfsFrame &frame = stack.back();
+        if (frame.adjPos < frame.adj.size()) {
+            auto w = frame.adj[frame.adjPos++]->getDest();
+            if (ws.isProcessing(w)) return false;
+            if (! ws.isVisited(w)) {
+                ws.setVisited(w, true);
+                ws.setProcessing(w, true);
+                stack.emplace_back(w);
+            }
+            continue;
+        }
+        // a bidirectional edge is a cycle of two vertexes
+        for (auto e : frame.incoming) {
+            if (e->isBidirectional()) return false;
         }
+        ws.setProcessing(frame.vertex, false);
+        stack.pop_back();
     }
-    v->setProcesssing(false);
     return true;
 }
 
@@ -826,21 +999,22 @@ bool Graph<T>::dfsIsDAG(Vertex<T> *v) const {
 
 template<class T>
 std::vector<T> Graph<T>::topsort() const {
-    std::vector<int> res;
+    std::vector<T> res;
 
-    for (auto v : vertexSet) {
-        v->setIndegree(0);
-    }
+    // every indegree starts at 0 in a new workspace
+    TraversalWorkspace<T> ws(vertexSet.size());
     for (auto v : vertexSet) {
         for (auto e : v->getAdj()) {
-            unsigned int indegree = e->getDest()->getIndegree();
-            e->getDest()->setIndegree(indegree + 1);
+            ws.setIndegree(e->getDest(), ws.getIndegree(e->getDest()) + 1);
+            if (e->isBidirectional()) {
+                ws.setIndegree(v, ws.getIndegree(v) + 1);
+            }
         }
     }
 
     std::queue<Vertex<T> *> q;
     for (auto v : vertexSet) {
-        if (v->getIndegree() == 0) {
+        if (ws.getIndegree(v) == 0) {
             q.push(v);
         }
     }
@@ -851,8 +1025,8 @@ std::vector<T> Graph<T>::topsort() const {
         res.push_back(v->getInfo());
         for(auto e : v->getAdj()) {
             auto w = e->getDest();
-            w->setIndegree(w->getIndegree() - 1);
-            if(w->getIndegree() == 0) {
+            ws.setIndegree(w, ws.getIndegree(w) - 1);
+            if(ws.getIndegree(w) == 0) {
                 q.push(w);
             }
         }
@@ -867,6 +1041,101 @@ std::vector<T> Graph<T>::topsort() const {
     return res;
 }
 
+/****************** Memory ********************/
+/**
+ * Gets the memory used by the graph.
+ * Complexity: O(V) where V is the number of vertexes
+ * @tparam T Type of the class
+ * @param vertexBytes Set to the memory used by the vertexes, the vertex set and the index of the vertexes
+ * @param edgeBytes Set to the memory used by the edges
+ */
+template <class T>
+void Graph<T>::memoryUsage(std::size_t &vertexBytes, std::size_t &edgeBytes) const {
+    vertexBytes = MemoryUsage::heapBytes(vertexSet) + MemoryUsage::heapBytes(vertexIndex);
+    edgeBytes = 0;
+    for (auto v : vertexSet) {
+        vertexBytes += v->memoryUsage();
+        edgeBytes += v->getAdj().size() * sizeof(Edge<T>);
+    }
+    for (const auto &infoVertex : vertexIndex) {
+        vertexBytes += MemoryUsage::heapBytes(infoVertex.first);
+    }
+}
+
+/****************** SCC ********************/
+/**
+ * Finds the strongly connected components of the graph (Tarjan's algorithm, with an explicit stack).
+ * Bidirectional edges are followed both ways, so their endpoints are always in the same component.
+ * Components are numbered in the order they are completed: if a component can reach another one, the other one has a smaller number
+ * (so the numbers, from the biggest to the smallest, are a topological order of the condensed graph).
+ * Complexity: O(V + E)
+ * @param component Filled with the component of each vertex, indexed by the vertex index
+ * @return Number of components
+ */
+template <class T>
+unsigned int Graph<T>::scc(std::vector<unsigned int> &component) const {
+    const unsigned int none = std::numeric_limits<unsigned int>::max();
+    const std::size_t n = vertexSet.size();
+    std::vector<unsigned int> num(n, none), low(n, 0);
+    std::vector<bool> onStack(n, false);
+    std::vector<Vertex<T> *> stack;
+    std::vector<DfsFrame> callStack;
+    unsigned int counter = 0, numComponents = 0;
+    component.assign(n, none);
+
+    for (auto root : vertexSet) {
+        if (num[root->getIndex()] != none) continue;
+        num[root->getIndex()] = low[root->getIndex()] = counter++;
+        stack.push_back(root);
+        onStack[root->getIndex()] = true;
+        callStack.emplace_back(root);
+
+        while (!callStack.empty()) {
+            DfsFrame &frame = callStack.back();
+            unsigned int u = frame.vertex->getIndex();
+            Vertex<T> *w = nullptr;
+            if (frame.adjPos < frame.adj.size()) {
+                w = frame.adj[frame.adjPos++]->getDest();
+            }
+            else if (frame.incomingPos < frame.incoming.size()) {
+                auto e = frame.incoming[frame.incomingPos++];
+                if (!e->isBidirectional()) continue;
+                w = e->getOrig();
+            }
+            else {
+                // every edge was followed, u is the root of a component if it can't reach anything lower in the stack
+                callStack.pop_back();
+                if (low[u] == num[u]) {
+                    Vertex<T> *x;
+                    do {
+                        x = stack.back();
+                        stack.pop_back();
+                        onStack[x->getIndex()] = false;
+                        component[x->getIndex()] = numComponents;
+                    } while (x->getIndex() != u);
+                    numComponents++;
+                }
+                if (!callStack.empty()) {
+                    unsigned int parent = callStack.back().vertex->getIndex();
+                    low[parent] = std::min(low[parent], low[u]);
+                }
+                continue;
+            }
+
+            if (num[w->getIndex()] == none) {
+                num[w->getIndex()] = low[w->getIndex()] = counter++;
+                stack.push_back(w);
+                onStack[w->getIndex()] = true;
+                callStack.emplace_back(w);
+            }
+            else if (onStack[w->getIndex()]) {
+                low[u] = std::min(low[u], num[w->getIndex()]);
+            }
+        }
+    }
+    return numComponents;
+}
+
 inline void deleteMatrix(int **m, int n) {
     if (m != nullptr) {
         for (int i = 0; i < n; i++)
@@ -885,10 +1154,161 @@ inline void deleteMatrix(double **m, int n) {
     }
 }
 
+/****************** Copies ********************/
+/**
+ * Creates a deep copy of a graph (see cloneFrom).
+ * Complexity: O(V + E)
+ * @tparam T Type of the class
+ * @param other Graph to copy
+ */
+template <class T>
+Graph<T>::Graph(const Graph<T> &other) {
+    cloneFrom(other);
+}
+
+/**
+ * Takes the vertexes and edges of a graph, which is left empty.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param other Graph to move
+ */
+template <class T>
+Graph<T>::Graph(Graph<T> &&other) noexcept {
+    swap(other);
+}
+
+/**
+ * Replaces the graph by a copy of another one (or by the other one, if it is moved).
+ * Complexity: O(V + E) (O(1) if the other graph is moved) plus freeing the current vertexes and edges
+ * @tparam T Type of the class
+ * @param other Graph to copy
+ * @return This graph
+ */
+template <class T>
+Graph<T> &Graph<T>::operator=(Graph<T> other) {
+    swap(other);
+    return *this;
+}
+
+/**
+ * Exchanges the vertexes and edges of two graphs.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param other Graph to exchange with
+ */
+template <class T>
+void Graph<T>::swap(Graph<T> &other) noexcept {
+    std::swap(vertexSet, other.vertexSet);
+    std::swap(vertexIndex, other.vertexIndex);
+    std::swap(distMatrix, other.distMatrix);
+    std::swap(pathMatrix, other.pathMatrix);
+    std::swap(block, other.block);
+    std::swap(blockVertexBytes, other.blockVertexBytes);
+}
+
+/**
+ * Fills an empty graph with a copy of another one, with the same vertex order, edge order, weights, costs, flows and reverse edges.
+ * Every vertex and edge is placed in a single allocation: the vertexes keep their index and the edges are numbered by their
+ * position in the outgoing edges, so a pointer of the other graph is remapped through these index tables. Incoming and reverse
+ * edges are remapped with an open addressing table from the edges of the other graph to their number.
+ * The Floyd-Warshall matrices are not copied.
+ * Complexity: O(V + E)
+ * @tparam T Type of the class
+ * @param other Graph to copy
+ */
+template <class T>
+void Graph<T>::cloneFrom(const Graph<T> &other) {
+    std::size_t numVertexes = other.vertexSet.size();
+    std::vector<std::size_t> firstEdge(numVertexes + 1, 0);   // number of the first outgoing edge of each vertex
+    for (std::size_t i = 0; i < numVertexes; i++) {
+        firstEdge[i + 1] = firstEdge[i] + other.vertexSet[i]->adj.size();
+    }
+    std::size_t numEdges = firstEdge[numVertexes];
+    if (numVertexes == 0) return;
+
+    blockVertexBytes = numVertexes * sizeof(Vertex<T>);
+    std::size_t edgeOffset = (blockVertexBytes + alignof(Edge<T>) - 1) / alignof(Edge<T>) * alignof(Edge<T>);
+    block = static_cast<char *>(::operator new(edgeOffset + numEdges * sizeof(Edge<T>)));
+    Vertex<T> *vertexes = reinterpret_cast<Vertex<T> *>(block);
+    Edge<T> *edges = reinterpret_cast<Edge<T> *>(block + edgeOffset);
+
+    // edge of the other graph -> number, Fibonacci hashing of the address with linear probing
+    unsigned int bits = 1;
+    while ((std::size_t(1) << bits) < 2 * numEdges) bits++;
+    std::vector<std::pair<const Edge<T> *, std::size_t>> numbers(std::size_t(1) << bits, {nullptr, 0});
+    auto slot = [&](const Edge<T> *e) {
+        std::size_t pos = (static_cast<uint64_t>(reinterpret_cast<uintptr_t>(e)) * 11400714819323198485ULL) >> (64 - bits);
+        while (numbers[pos].first != nullptr && numbers[pos].first != e) {
+            pos = (pos + 1) & (numbers.size() - 1);
+        }
+        return pos;
+    };
+
+    vertexSet.reserve(numVertexes);
+    vertexIndex.reserve(numVertexes);
+    for (std::size_t i = 0; i < numVertexes; i++) {
+        const Vertex<T> *original = other.vertexSet[i];
+        Vertex<T> *v = new (vertexes + i) Vertex<T>(original->info, original->type);
+        v->index = i;
+        v->adj.reserve(original->adj.size());
+        v->incoming.reserve(original->incoming.size());
+        vertexSet.push_back(v);
+        vertexIndex.emplace(v->info, v);
+    }
+
+    for (std::size_t i = 0; i < numVertexes; i++) {
+        const std::vector<Edge<T> *> &adj = other.vertexSet[i]->adj;
+        for (std::size_t k = 0; k < adj.size(); k++) {
+            Edge<T> *e = new (edges + firstEdge[i] + k) Edge<T>(*adj[k]);
+            e->orig = vertexes + i;
+            e->dest = vertexes + adj[k]->dest->index;
+            e->pooled = true;
+            vertexSet[i]->adj.push_back(e);
+            numbers[slot(adj[k])] = std::make_pair(adj[k], firstEdge[i] + k);
+        }
+    }
+
+    for (std::size_t i = 0; i < numVertexes; i++) {
+        for (auto e : other.vertexSet[i]->incoming) {
+            vertexSet[i]->incoming.push_back(edges + numbers[slot(e)].second);
+        }
+        for (auto e : vertexSet[i]->adj) {
+            if (e->reverse != nullptr) e->reverse = edges + numbers[slot(e->reverse)].second;
+        }
+    }
+}
+
+/**
+ * Frees a vertex (not its edges), created on its own or in the block of a cloned graph.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param v Vertex to free
+ */
+template <class T>
+void Graph<T>::destroyVertex(Vertex<T> *v) {
+    const char *address = reinterpret_cast<const char *>(v);
+    if (block != nullptr && address >= block && address < block + blockVertexBytes) v->~Vertex();
+    else delete v;
+}
+
+/**
+ * Frees every vertex and edge of the graph.
+ * Complexity: O(V + E)
+ * @tparam T Type of the class
+ */
 template <class T>
 Graph<T>::~Graph() {
     deleteMatrix(distMatrix, vertexSet.size());
     deleteMatrix(pathMatrix, vertexSet.size());
+    for (auto v : vertexSet) {
+        for (auto e : v->adj) {
+            Edge<T>::destroy(e);
+        }
+    }
+    for (auto v : vertexSet) {
+        destroyVertex(v);
+    }
+    ::operator delete(block);
 }
 
 #endif /* DA_TP_CLASSES_GRAPH */
\ No newline at end of file
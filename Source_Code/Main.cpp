@@ -4,6 +4,8 @@
 #include <iostream>
 #include "graph.h"
 #include "Menu.h"
+#include "Profiler.h"
+#include <cstdlib>
 /**
  * @file Main.cpp
  * @brief This file contains the main function of the project.
@@ -18,6 +20,15 @@
  */
 
 int main(){
+    //WSM_PROFILE=<file> stores a Chrome trace of the session, WSM_PROFILE_JSON=<file> stores a summary
+    const char *trace = getenv("WSM_PROFILE");
+    const char *summary = getenv("WSM_PROFILE_JSON");
+    Profiler::setEnabled(trace != nullptr || summary != nullptr);
+
     Menu menu;
-    return menu.mainMenu();
+    int res = menu.mainMenu();
+
+    if(trace != nullptr) Profiler::dumpChromeTrace(trace);
+    if(summary != nullptr) Profiler::dumpJson(summary);
+    return res;
 }
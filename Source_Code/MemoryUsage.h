@@ -0,0 +1,73 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#ifndef PROJECT1_MEMORYUSAGE_H
+#define PROJECT1_MEMORYUSAGE_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @file MemoryUsage.h
+ * @brief Definition of class MemoryUsage.
+ *
+ * \class MemoryUsage
+ * Estimates of the heap memory used by the standard containers of the model. The estimates follow the usual layouts
+ * (strings with a small buffer, hash maps with one node per element and an array of buckets) and ignore the allocator overhead.
+ */
+class MemoryUsage {
+public:
+    /**
+     * Gets the heap memory used by a string (0 if it fits in the small string buffer).
+     * Complexity: O(1)
+     * @param s String
+     * @return Bytes used
+     */
+    static std::size_t heapBytes(const std::string &s) {
+        static const std::size_t smallCapacity = std::string().capacity();
+        return s.size() > smallCapacity ? s.size() + 1 : 0;
+    }
+
+    /**
+     * Gets the heap memory used by a value without heap memory of its own (numbers, pointers...).
+     * Complexity: O(1)
+     * @tparam T Type of the value
+     * @return Bytes used (always 0)
+     */
+    template <class T>
+    static std::size_t heapBytes(const T &) {
+        return 0;
+    }
+
+    /**
+     * Gets the heap memory used by a vector (its capacity, not counting the heap memory of the elements).
+     * Complexity: O(1)
+     * @tparam T Type of the elements
+     * @param v Vector
+     * @return Bytes used
+     */
+    template <class T>
+    static std::size_t heapBytes(const std::vector<T> &v) {
+        return v.capacity() * sizeof(T);
+    }
+
+    /**
+     * Gets the heap memory used by a hash map (nodes and buckets, not counting the heap memory of the keys and values).
+     * Complexity: O(1)
+     * @tparam K Type of the keys
+     * @tparam V Type of the values
+     * @param map Hash map
+     * @return Bytes used
+     */
+    template <class K, class V>
+    static std::size_t heapBytes(const std::unordered_map<K, V> &map) {
+        //each node has the next pointer and the cached hash besides the element
+        return map.size() * (sizeof(std::pair<const K, V>) + sizeof(void *) + sizeof(std::size_t)) + map.bucket_count() * sizeof(void *);
+    }
+};
+
+
+#endif //PROJECT1_MEMORYUSAGE_H
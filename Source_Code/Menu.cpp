@@ -3,6 +3,7 @@
 //
 
 #include "Menu.h"
+#include <climits>
 
 using namespace std;
 
@@ -49,6 +50,8 @@ int Menu::inputCheck(int &option, int min, int max) {
  */
 int Menu::mainMenu() {
     cout << "\nWELCOME TO THE WATER SUPPLY MANAGEMENT SYSTEM\n\n";
+    //solves of previous sessions are reused when the same network is solved again
+    system.getSolveCache().setFile("../Source_Code/solves.wsmcache", WaterSupplyManagement::SOLVER_VERSION);
     int s;
     while(true) {
         if (isSystemReset) {
@@ -59,6 +62,8 @@ int Menu::mainMenu() {
                 return EXIT_FAILURE;
             }
             isSystemReset = false;
+            //the edits made while selecting the data can't be undone from the menus
+            system.clearJournal();
         }
 
         cout << "Please insert the number corresponding to the option you want to select\n\n";
@@ -66,11 +71,13 @@ int Menu::mainMenu() {
         cout << "1.Basic Metrics\n";
         cout << "2.Reliability and Sensitivity to Failures\n";
         cout << "3.Reset the system\n";
-        cout << "4.Exit\n\n";
+        cout << "4.Memory usage of the network\n";
+        cout << "5.Change the network (pipes, undo and redo)\n";
+        cout << "6.Exit\n\n";
 
         int option;
 
-        s = inputCheck(option, 1, 4);
+        s = inputCheck(option, 1, 6);
         if (s != 0) {
             cout << "Error found\n";
             return EXIT_FAILURE;
@@ -88,6 +95,12 @@ int Menu::mainMenu() {
                 isSystemReset = true;
                 break;
             case 4:
+                s = memoryUsage();
+                break;
+            case 5:
+                s = editNetwork();
+                break;
+            case 6:
                 //exits the system
                 return EXIT_SUCCESS;
             default:
@@ -116,12 +129,15 @@ int Menu::basicMetrics() {
         cout << "2.Water deficit \n";
         cout << "3.Network Balance \n";
         cout << "4.Store metrics to a file\n";
-        cout << "5.Exit the menu\n";
+        cout << "5.Maximum amount of water each city could receive on its own\n";
+        cout << "6.Change how the water is distributed when it is not enough\n";
+        cout << "7.Pumping load of each station\n";
+        cout << "8.Exit the menu\n";
 
         int s;
         int option;
 
-        s = inputCheck(option, 1, 5);
+        s = inputCheck(option, 1, 8);
         if (s != 0) {
             cout << "Error found\n";
             return EXIT_FAILURE;
@@ -131,7 +147,9 @@ int Menu::basicMetrics() {
         //prepares the system to execute the metrics
         system.createSuperSource();
         system.createSuperSink();
-        system.edmondsKarp("super_source", "super_sink");
+        if(option == 6 && distributionSelection() != 0) return EXIT_FAILURE;
+        system.distributeWater(distributionMode);
+        system.publishSnapshot();
 
         switch(option){
             case 1:
@@ -144,42 +162,42 @@ int Menu::basicMetrics() {
                 networkRebalance();
                 break;
             case 4:
-                cout << "\nThe metrics were stored in a file called metrics.csv\n";
-                system.storeMetricsToFile();
+                storeMetrics();
                 break;
             case 5:
+                isolatedCapacities();
+                break;
+            case 6:
+                //the water was already distributed in the new mode
+                break;
+            case 7:
+                pumpingLoad();
+                break;
+            case 8:
                 return EXIT_SUCCESS;
         }
     }
 }
 
 /**
- * Finds the cities that have water deficit to use in other menus.
- * Complexity: O(n^2)
+ * Finds the cities that have water deficit to use in other menus (read from the last published snapshot).
+ * Complexity: O(n) where n is the number of cities
  * @return Vector with a pair code/flow of each city
  */
 vector<pair<string,double>> Menu::findAffectedCities(){
-    vector<pair<string,double>> res;
-    for(pair<string, City> codeCity : system.getCodeToCity()){
-        double deficit = system.flowDeficit(codeCity.first);
-        if( deficit > 0){
-            res.emplace_back(codeCity.first, codeCity.second.getDemand() - deficit);
-        }
-    }
-    return res;
+    shared_ptr<const FlowSnapshot> snapshot = system.getSnapshot();
+    if(snapshot == nullptr) snapshot = system.publishSnapshot();
+    return snapshot->affectedCities();
 }
 /**
- * Finds the initial flow of each city before removing any reservoir, pipe or station to use in other menus.
- * Complexity: O(n)
+ * Finds the initial flow of each city before removing any reservoir, pipe or station to use in other menus (read from the last published snapshot).
+ * Complexity: O(n) where n is the number of cities
  * @return Vector with a pair code/flow of each city
  */
 std::vector<std::pair<std::string, double>> Menu::findInitialFlows() {
-    vector<pair<string,double>> res;
-    for(pair<string, City> codeCity : system.getCodeToCity()){
-        double deficit = system.flowDeficit(codeCity.first);
-        res.emplace_back(codeCity.first, codeCity.second.getDemand() - deficit);
-    }
-    return res;
+    shared_ptr<const FlowSnapshot> snapshot = system.getSnapshot();
+    if(snapshot == nullptr) snapshot = system.publishSnapshot();
+    return snapshot->cityFlows();
 }
 
 /**
@@ -195,12 +213,14 @@ int Menu::reliabilitySensivityFailure() {
         cout << "2.Delivery capacity of the network if one specific water STATION is out of service (checks one by one) \n";
         cout << "3.PIPELINES, if ruptured, would make it impossible to deliver the desired amount of water to a given city \n";
         cout << "4.Delivery capacity of the network if one specific water STATION is out of service \n";
-        cout << "5.Exit the menu\n";
+        cout << "5.STATIONS and PIPELINES that, if out of service, leave a city without any water \n";
+        cout << "6.Delivery capacity of the network while a RESERVOIR, STATION or PIPE keeps only part of its capacity \n";
+        cout << "7.Exit the menu\n";
 
         int s;
         int option;
 
-        s = inputCheck(option, 1, 5);
+        s = inputCheck(option, 1, 7);
         if (s != 0) {
             cout << "Error found\n";
             return EXIT_FAILURE;
@@ -210,7 +230,8 @@ int Menu::reliabilitySensivityFailure() {
 
         system.createSuperSource();
         system.createSuperSink();
-        system.edmondsKarp("super_source", "super_sink");
+        system.cachedMaxFlow();
+        system.publishSnapshot();
         vector<pair<string,double>> affectedCities = findAffectedCities();
         vector<pair<string,double>> initialFlows = findInitialFlows();
 
@@ -228,6 +249,12 @@ int Menu::reliabilitySensivityFailure() {
                 affectedCitiesStation(affectedCities);
                 break;
             case 5:
+                singlePointsOfFailure();
+                break;
+            case 6:
+                degradationCurve();
+                break;
+            case 7:
                 return EXIT_SUCCESS;
         }
 
@@ -259,6 +286,7 @@ int Menu::maxWater() {
     double waterFlow;
     string code;
     Vertex<string> *v;
+    unordered_map<string, City> codeToCity = system.getCodeToCity();
     switch(option){
         case 1:
             cout << "\nInsert the code of the city \n";
@@ -273,12 +301,13 @@ int Menu::maxWater() {
                 waterFlow += e->getFlow();
             }
             cout << "\nCode, Name, Water Amount \n";
-            cout << code << ", " << system.getCodeToCity().find(code)->second.getName() << ", " << waterFlow << "\n";
+            cout << code << ", " << codeToCity.find(code)->second.getName() << ", " << waterFlow << "\n";
             break;
 
         case 2:
             cout << "\nCode, Name, Water Amount \n";
-            for(pair<string, City> codeCity : system.getCodeToCity()){
+            for(const string &cityCode : system.getCityCodes()){
+                const pair<const string, City> &codeCity = *codeToCity.find(cityCode);
                 v = system.getNetwork().findVertex(codeCity.first);
                 if(v == nullptr) continue;
                 waterFlow = 0;
@@ -303,8 +332,12 @@ int Menu::maxWater() {
 int Menu::waterDeficit() {
     cout << "\nCode , Name,  Water deficit\n";
     double deficit = 0;
-    for(pair<string, City> codeCity : system.getCodeToCity()){
-        deficit = system.flowDeficit(codeCity.first);
+    shared_ptr<const FlowSnapshot> snapshot = system.getSnapshot();
+    if(snapshot == nullptr) snapshot = system.publishSnapshot();
+    unordered_map<string, City> codeToCity = system.getCodeToCity();
+    for(const string &cityCode : system.getCityCodes()){
+        const pair<const string, City> &codeCity = *codeToCity.find(cityCode);
+        deficit = snapshot->flowDeficit(codeCity.first);
         if(deficit > 0){
             cout << codeCity.first << ", " << codeCity.second.getName() << ", " << deficit << '\n';
         }
@@ -324,6 +357,7 @@ int Menu::networkRebalance() {
     double previousAVG = system.avgDiffPipes();
     double previousMaxDiff = system.maxDiffPipes();
     system.networkBalance();
+    system.publishSnapshot();
     double newAVG = system.avgDiffPipes();
     double newMaxDiff = system.maxDiffPipes();
 
@@ -335,6 +369,217 @@ int Menu::networkRebalance() {
     return 0;
 }
 
+/**
+ * Submenu for storing the metrics to a file in the selected format.
+ * Complexity: O(V + E) where E is the number of edges and v is the number of vertexes.
+ * @return If there was not any error 0. Else 1.
+ */
+int Menu::storeMetrics() {
+    cout << "In which format do you want to store the metrics?\n";
+
+    cout << "1.CSV (metrics.csv, metrics_pipes.csv and metrics_reservoirs.csv)\n";
+    cout << "2.JSON (metrics.json)\n";
+    cout << "3.Binary columnar (metrics.wsmc)\n";
+
+    int s;
+    int option;
+
+    s = inputCheck(option, 1, 3);
+    if (s != 0) {
+        cout << "Error found\n";
+        return EXIT_FAILURE;
+    }
+    cout << '\n';
+
+    string filename;
+    MetricsFormat format;
+    switch(option){
+        case 1:
+            filename = "metrics.csv";
+            format = MetricsFormat::CSV;
+            break;
+        case 2:
+            filename = "metrics.json";
+            format = MetricsFormat::JSON;
+            break;
+        default:
+            filename = "metrics.wsmc";
+            format = MetricsFormat::COLUMNAR;
+            break;
+    }
+
+    if(!system.storeMetricsToFile("../Source_Code/" + filename, format)){
+        cout << "\nThe metrics couldn't be stored in a file called " << filename << '\n';
+        return EXIT_FAILURE;
+    }
+    cout << "\nThe metrics were stored in a file called " << filename << '\n';
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Submenu for the maximum amount of water each city could receive if it was the only city being supplied.
+ * Complexity: O(c V E^2 / t) where c is the number of cities, V is the number of vertexes, E is the number of edges and t is the number of threads
+ * @return If there was not any error 0. Else 1.
+ */
+int Menu::isolatedCapacities() {
+    unordered_map<string, City> codeToCity = system.getCodeToCity();
+    cout << "\nCode, Name, Maximum water on its own, Demand\n";
+    for(const pair<string, double> &codeCapacity : system.isolatedCityCapacities()){
+        auto search = codeToCity.find(codeCapacity.first);
+        if(search == codeToCity.end()) continue;
+        cout << codeCapacity.first << ", " << search->second.getName() << ", " << codeCapacity.second << ", " << search->second.getDemand() << '\n';
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Submenu for the memory used by the network model (total and per element) and by its compact copy.
+ * Complexity: O(V log V + E) where E is the number of edges and v is the number of vertexes.
+ * @return If there was not any error 0. Else 1.
+ */
+int Menu::memoryUsage() {
+    WaterSupplyManagement::MemoryReport report = system.memoryReport();
+    auto perElement = [](size_t bytes, size_t count) { return count == 0 ? 0.0 : static_cast<double>(bytes) / count; };
+
+    cout << "\n\tCount, Bytes, Bytes each\n";
+    cout << "Vertexes\t" << report.numVertexes << ", " << report.vertexBytes << ", " << perElement(report.vertexBytes, report.numVertexes) << '\n';
+    cout << "Pipes   \t" << report.numEdges << ", " << report.edgeBytes << ", " << perElement(report.edgeBytes, report.numEdges) << '\n';
+    cout << "Entities\t" << report.numEntities << ", " << report.entityBytes << ", " << perElement(report.entityBytes, report.numEntities) << '\n';
+    cout << "\nTotal: " << report.vertexBytes + report.edgeBytes + report.entityBytes << " bytes\n";
+    cout << "Compact copy of the network: " << report.compactBytes << " bytes\n";
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Submenu for changing the pipes of the network, with undo and redo of the changes (only the ones made after selecting the data).
+ * Complexity: Varies on the changes made (depend on the users choice).
+ * @return If there was not any error 0. Else 1.
+ */
+int Menu::editNetwork() {
+    while(true){
+        cout << "\n CHANGE THE NETWORK \n";
+
+        cout << "1.Delete a pipe\n";
+        cout << "2.Change the capacity of a pipe\n";
+        cout << "3.Undo the last change\n";
+        cout << "4.Redo the last undone change\n";
+        cout << "5.Exit the menu\n";
+
+        int s;
+        int option;
+
+        s = inputCheck(option, 1, 5);
+        if (s != 0) {
+            cout << "Error found\n";
+            return EXIT_FAILURE;
+        }
+        cout << '\n';
+
+        string source;
+        string destination;
+        if(option == 1 || option == 2){
+            cout << "\n Insert the code of the source of the pipe \n";
+            cin >> source;
+            cout << "\n Insert the code of the destination of the pipe \n";
+            cin >> destination;
+        }
+
+        const EditJournal &journal = system.getJournal();
+        switch (option) {
+            case 1:
+                if(!system.deletePipe(source, destination)) cout << "\n This pipe doesn't exists \n";
+                break;
+            case 2: {
+                cout << "\n Insert the new capacity of the pipe \n";
+                int capacity;
+                s = inputCheck(capacity, 0, INT_MAX);
+                if (s != 0) {
+                    cout << "Error found\n";
+                    return EXIT_FAILURE;
+                }
+                if(!system.setPipeCapacity(source, destination, capacity)) cout << "\n This pipe doesn't exists \n";
+                break;
+            }
+            case 3:
+                if(!journal.canUndo()) cout << "There is nothing to undo\n";
+                else{
+                    string description = EditJournal::describe(journal.getEdits()[journal.checkpoint() - 1]);
+                    if(system.undo()) cout << "Undone: " << description << '\n';
+                    else cout << "The " << description << " can't be undone\n";
+                }
+                break;
+            case 4:
+                if(!journal.canRedo()) cout << "There is nothing to redo\n";
+                else{
+                    string description = EditJournal::describe(journal.getEdits()[journal.checkpoint()]);
+                    if(system.redo()) cout << "Redone: " << description << '\n';
+                    else cout << "The " << description << " can't be redone\n";
+                }
+                break;
+            case 5:
+                return EXIT_SUCCESS;
+        }
+    }
+}
+
+/**
+ * Submenu for the pumping load of each station (water sent and its cost) and the operating cost of the network.
+ * Complexity: O(V + E) where E is the number of edges and v is the number of vertexes.
+ * @return If there was not any error 0. Else 1.
+ */
+int Menu::pumpingLoad() {
+    cout << "\nCode, Water pumped, Pumping cost\n";
+    for(const WaterSupplyManagement::StationLoad &load : system.stationPumpingLoad()){
+        cout << load.code << ", " << load.pumped << ", " << load.cost << '\n';
+    }
+    cout << "\nOperating cost of the network: " << system.operatingCost() << '\n';
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Submenu for choosing how the water is distributed by the basic metrics.
+ * Complexity: O(1)
+ * @return If there was not any error 0. Else 1.
+ */
+int Menu::distributionSelection() {
+    cout << "How should the water be distributed when it is not enough for every city?\n";
+
+    cout << "1.Maximum flow (any split)\n";
+    cout << "2.Fair share (every city gets the same fraction of its demand)\n";
+    cout << "3.Priority (cities with the highest priority or population first)\n";
+    cout << "4.Minimum operating cost (cost of each pipe)\n";
+
+    int s;
+    int option;
+
+    s = inputCheck(option, 1, 4);
+    if (s != 0) {
+        cout << "Error found\n";
+        return EXIT_FAILURE;
+    }
+    cout << '\n';
+
+    switch(option){
+        case 1:
+            distributionMode = DistributionMode::MAX_FLOW;
+            break;
+        case 2:
+            distributionMode = DistributionMode::FAIR_SHARE;
+            break;
+        case 3:
+            distributionMode = DistributionMode::PRIORITY;
+            break;
+        case 4:
+            distributionMode = DistributionMode::MIN_COST;
+            break;
+    }
+
+    return EXIT_SUCCESS;
+}
+
 //Reliability and Sensitivity to Failures ===============================================================================
 
 /**
@@ -386,7 +631,9 @@ int Menu::affectCitiesReservoir(vector<pair<string,double>> &previouslyAffected,
 int Menu::affectedCitiesStations(std::vector<std::pair<std::string,double>> &previouslyAffected) {
     vector<std::string> safeToDeleteStations;
 
-    for(auto station: system.getCodeToStation()){
+    unordered_map<string, Station> codeToStation = system.getCodeToStation();
+    for(const string &stationCode : system.getStationCodes()){
+        pair<const string, Station> &station = *codeToStation.find(stationCode);
         vector<std::pair<std::string,double>> affectedCities=system.affectedCitiesStations(station.first,previouslyAffected);
         if(affectedCities.empty()){
             safeToDeleteStations.push_back(station.second.getCode());
@@ -413,7 +660,7 @@ int Menu::affectedCitiesStations(std::vector<std::pair<std::string,double>> &pre
 }
 
 /**
- * Submenu to see the affected cities by removing a station.
+ * Submenu to see the affected cities by removing a station or by reducing its capacity.
  * Complexity: O(V E^2) where V is the number of vertexes and E is the number of edges of the graph.
  * @param previouslyAffected Vector with pairs of city codes and their flow
  * @return If there was not any error 0. Else 1.
@@ -426,7 +673,13 @@ int Menu::affectedCitiesStation(std::vector<std::pair<std::string, double>> &pre
         cout << "Station does not exist\n";
         return EXIT_FAILURE;
     }
-    vector<std::pair<std::string,double>> affectedCities=system.affectedCitiesStations(code,previouslyAffected);
+    int percentage;
+    cout <<"\nPercentage of its capacity the station keeps (0 removes it)\n";
+    if(inputCheck(percentage, 0, 100) != 0){
+        cout << "Error found\n";
+        return EXIT_FAILURE;
+    }
+    vector<std::pair<std::string,double>> affectedCities=system.affectedCitiesStations(code,previouslyAffected,percentage / 100.0);
     if(affectedCities.empty()){
         cout<<"No cities were affected\n";
     }
@@ -480,6 +733,98 @@ int Menu::affectedCitiesPipes(std::vector<std::pair<std::string,double>> &previo
     return EXIT_SUCCESS;
 }
 
+/**
+ * Submenu to see, for each city, the stations and pipes whose failure leaves it without any water (single points of failure).
+ * Found with the dominator tree of the network, without solving any flow.
+ * Complexity: O(E log V + c d) where V is the number of vertexes, E is the number of edges, c is the number of cities and d the depth of the dominator tree
+ * @return If there was not any error 0. Else 1.
+ */
+int Menu::singlePointsOfFailure() {
+    const DominatorTree &dominators = system.getDominators();
+    bool found = false;
+
+    unordered_map<string, City> codeToCity = system.getCodeToCity();
+    for(const string &cityCode : system.getCityCodes()){
+        const pair<const string, City> &codeCity = *codeToCity.find(cityCode);
+        if(!dominators.isReachable(codeCity.first)) continue;
+        vector<string> stations = dominators.criticalStations(codeCity.first);
+        vector<pair<string, string>> pipes = dominators.criticalPipes(codeCity.first);
+        if(stations.empty() && pipes.empty()) continue;
+
+        found = true;
+        cout << codeCity.first << ", " << codeCity.second.getName() << " depends entirely on:\n";
+        for(const string &station : stations){
+            cout << "\tstation " << station << '\n';
+        }
+        for(const auto &pipe : pipes){
+            cout << "\tpipe " << pipe.first << " - " << pipe.second << '\n';
+        }
+    }
+
+    if(!found){
+        cout << "No station or pipe leaves a city without water on its own\n";
+    }
+    return EXIT_SUCCESS;
+}
+
+/**
+ * Submenu to see the water delivered while a reservoir, station or pipe keeps only part of its capacity (from 0% to 100%),
+ * and the cities with a deficit at a chosen percentage.
+ * Complexity: O(V E^2) where V is the number of vertexes and E is the number of edges of the graph.
+ * @return If there was not any error 0. Else 1.
+ */
+int Menu::degradationCurve() {
+    cout << "1.Reservoir or station\n";
+    cout << "2.Pipe\n";
+    int option;
+    if(inputCheck(option, 1, 2) != 0){
+        cout << "Error found\n";
+        return EXIT_FAILURE;
+    }
+
+    string code1, code2;
+    WaterSupplyManagement::DegradationCurve curve;
+    if(option == 1){
+        cout << "\nInput the code of the reservoir or station\n";
+        cin >> code1;
+        if(system.getCodeToReservoir().find(code1) == system.getCodeToReservoir().end() && system.getCodeToStation().find(code1) == system.getCodeToStation().end()){
+            cout << "That reservoir or station does not exist\n";
+            return EXIT_FAILURE;
+        }
+        curve = system.degradationCurve(code1);
+    }
+    else{
+        cout << "\nInput the code of the source of the pipe\n";
+        cin >> code1;
+        cout << "\nInput the code of the destination of the pipe\n";
+        cin >> code2;
+        if(system.findPipe(code1, code2) == nullptr){
+            cout << "That pipe does not exist\n";
+            return EXIT_FAILURE;
+        }
+        curve = system.degradationCurve(code1, code2);
+    }
+
+    cout << "\nCapacity kept | Water delivered\n";
+    for(int percentage = 0; percentage <= 100; percentage += 10){
+        cout << percentage << "% | " << curve.flow(percentage / 100.0) << "\n";
+    }
+    cout << "The water delivered stops growing at " << curve.breakpoint * 100 << "% of the capacity\n";
+
+    int percentage;
+    cout << "\nPercentage of the capacity to see the cities with a deficit\n";
+    if(inputCheck(percentage, 0, 100) != 0){
+        cout << "Error found\n";
+        return EXIT_FAILURE;
+    }
+    vector<pair<string, double>> deficits = curve.deficits(percentage / 100.0);
+    if(deficits.empty()) cout << "No city has a deficit\n";
+    for(const pair<string, double> &city : deficits){
+        cout << system.getCodeToCity()[city.first].getName() << " with a deficit of " << city.second << "\n";
+    }
+    return EXIT_SUCCESS;
+}
+
 //Menu data selection and parsing =======================================================================================
 
 /**
@@ -504,15 +849,14 @@ int Menu::dataSelection() {
     cout << '\n';
 
     system.resetSystem();
-    system.readCities(DataSetSelection::BIG);
-    system.readReservoirs(DataSetSelection::BIG);
-    system.readStations(DataSetSelection::BIG);
+    //the files are read at the same time, the pipes are added after their endpoints are inserted
+    vector<WaterSupplyManagement::PipeRecord> pipes = system.readData(DataSetSelection::BIG);
 
     switch (option) {
         case 1:
             //inserts all the data available
             system.insertAll();
-            system.readPipes(DataSetSelection::BIG);
+            system.addPipes(pipes);
             break;
 
         case 2:
@@ -520,11 +864,17 @@ int Menu::dataSelection() {
             selectCities();
             selectStations();
             selectReservoirs();
-            system.readPipes(DataSetSelection::BIG);
+            system.addPipes(pipes);
             deletePipes();
             break;
     }
 
+    ValidationReport report = system.validate();
+    if (!report.isValid()) {
+        cout << "\n PROBLEMS FOUND IN THE DATA \n";
+        report.print(cout);
+    }
+
     return EXIT_SUCCESS;
 }
 
@@ -24,11 +24,17 @@ public:
     int mainMenu();
     int basicMetrics();
     int reliabilitySensivityFailure();
+    int memoryUsage();
+    int editNetwork();
 
     //Basic metrics
     int maxWater();
     int waterDeficit();
     int networkRebalance();
+    int storeMetrics();
+    int isolatedCapacities();
+    int distributionSelection();
+    int pumpingLoad();
 
     //Reliability and Sensitivity to Failures
 
@@ -36,6 +42,8 @@ public:
     int affectedCitiesStations(std::vector<std::pair<std::string,double>> &previouslyAffected);
     int affectedCitiesPipes(std::vector<std::pair<std::string,double>> &previouslyAffected);
     int affectedCitiesStation(std::vector<std::pair<std::string,double>> &previouslyAffected);
+    int singlePointsOfFailure();
+    int degradationCurve();
 
 
     //Submenus for data selection
@@ -54,6 +62,7 @@ public:
 private:
     WaterSupplyManagement system;
     bool isSystemReset = true;
+    DistributionMode distributionMode = DistributionMode::MAX_FLOW;
 };
 
 
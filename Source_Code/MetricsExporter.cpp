@@ -0,0 +1,381 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#include "MetricsExporter.h"
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+#include <iostream>
+
+using namespace std;
+
+/** @file MetricsExporter.cpp
+ *  @brief Implementation of MetricsExporter class
+ */
+
+//size of the text buffer before it is written to the file
+static const size_t BUFFER_LIMIT = 1 << 16;
+
+/**
+ * Creates an exporter that writes to the given file. JSON and columnar outputs are written to a single file,
+ * CSV outputs use one file per table (see tableFilepath).
+ * Complexity: O(1)
+ * @param filepath Path of the output file
+ * @param format Output format
+ * @param chunkRows Maximum number of rows kept in memory before being written
+ */
+MetricsExporter::MetricsExporter(const std::string &filepath, MetricsFormat format, std::size_t chunkRows)
+    : filepath(filepath), format(format), chunkRows(chunkRows == 0 ? 1 : chunkRows) {
+    if(format == MetricsFormat::CSV) return;
+
+    openStream(filepath);
+    if(format == MetricsFormat::JSON){
+        buffer += "{";
+    }
+    else{
+        uint32_t version = 1;
+        writeRaw("WSMC", 4);
+        writeRaw(&version, sizeof(version));
+    }
+}
+
+/**
+ * Closes the exporter, writing everything that is still buffered.
+ * Complexity: O(n) where n is the number of buffered rows
+ */
+MetricsExporter::~MetricsExporter() {
+    close();
+}
+
+/**
+ * Checks if the output file was successfully opened (always true for CSV before the first table).
+ * Complexity: O(1)
+ * @return True if the output can be written, false otherwise
+ */
+bool MetricsExporter::isOpen() const {
+    if(format == MetricsFormat::CSV && tableCount == 0) return true;
+    return out.is_open() && out.good();
+}
+
+/**
+ * Gets the file used by the CSV format for a given table. The first table is written to the given path,
+ * the others to "<path without extension>_<table>.<extension>".
+ * Complexity: O(n) where n is the size of the path
+ * @param filepath Path given to the exporter
+ * @param table Name of the table
+ * @return Path of the file of the table
+ */
+std::string MetricsExporter::tableFilepath(const std::string &filepath, const std::string &table) {
+    size_t dot = filepath.find_last_of('.');
+    size_t slash = filepath.find_last_of("/\\");
+    if(dot == string::npos || (slash != string::npos && dot < slash)){
+        return filepath + "_" + table;
+    }
+    return filepath.substr(0, dot) + "_" + table + filepath.substr(dot);
+}
+
+/**
+ * Starts a new table. Any previous table is closed.
+ * Complexity: O(c) where c is the number of columns
+ * @param name Name of the table
+ * @param columns Names of the columns
+ * @param types Types of the columns (same size as columns)
+ */
+void MetricsExporter::beginTable(const std::string &name, const std::vector<std::string> &columns_, const std::vector<ColumnType> &types_) {
+    if(inTable) endTable();
+
+    tableName = name;
+    columns = columns_;
+    types = types_;
+    types.resize(columns.size(), ColumnType::TEXT);
+    currentColumn = 0;
+    rowsInChunk = 0;
+    firstRow = true;
+    inTable = true;
+
+    switch (format) {
+        case MetricsFormat::CSV:
+            //every table goes to its own file, the first one keeps the given path
+            if(out.is_open()) out.close();
+            openStream(tableCount == 0 ? filepath : tableFilepath(filepath, name));
+            for(size_t i = 0; i < columns.size(); i++){
+                if(i != 0) buffer += ", ";
+                buffer += escapeCsv(columns[i]);
+            }
+            buffer += '\n';
+            break;
+
+        case MetricsFormat::JSON:
+            if(tableCount != 0) buffer += ",";
+            buffer += "\n\"" + escapeJson(name) + "\": [";
+            break;
+
+        case MetricsFormat::COLUMNAR: {
+            writeString(name);
+            uint32_t numColumns = columns.size();
+            writeRaw(&numColumns, sizeof(numColumns));
+            for(size_t i = 0; i < columns.size(); i++){
+                uint8_t type = types[i] == ColumnType::NUMBER ? 1 : 0;
+                writeRaw(&type, sizeof(type));
+                writeString(columns[i]);
+            }
+            numberColumns.assign(columns.size(), vector<double>());
+            textColumns.assign(columns.size(), vector<string>());
+            for(size_t i = 0; i < columns.size(); i++){
+                if(types[i] == ColumnType::NUMBER) numberColumns[i].reserve(chunkRows);
+                else textColumns[i].reserve(chunkRows);
+            }
+            break;
+        }
+    }
+    tableCount++;
+}
+
+/**
+ * Adds a text value to the next column of the current row.
+ * Complexity: O(n) where n is the size of the value
+ * @param value Value to add
+ */
+void MetricsExporter::addText(const std::string &value) {
+    if(!inTable || currentColumn >= columns.size()) return;
+
+    switch (format) {
+        case MetricsFormat::CSV:
+            if(currentColumn != 0) buffer += ", ";
+            buffer += escapeCsv(value);
+            break;
+        case MetricsFormat::JSON:
+            buffer += currentColumn == 0 ? (firstRow ? "\n {" : ",\n {") : ", ";
+            buffer += "\"" + escapeJson(columns[currentColumn]) + "\": \"" + escapeJson(value) + "\"";
+            break;
+        case MetricsFormat::COLUMNAR:
+            if(types[currentColumn] == ColumnType::TEXT) textColumns[currentColumn].push_back(value);
+            else numberColumns[currentColumn].push_back(0);
+            break;
+    }
+    currentColumn++;
+}
+
+/**
+ * Adds a numeric value to the next column of the current row.
+ * Complexity: O(1)
+ * @param value Value to add
+ */
+void MetricsExporter::addNumber(double value) {
+    if(!inTable || currentColumn >= columns.size()) return;
+
+    char text[32] = "";
+    if(format != MetricsFormat::COLUMNAR || types[currentColumn] == ColumnType::TEXT){
+        if(std::isfinite(value)) snprintf(text, sizeof(text), "%.15g", value);
+        else snprintf(text, sizeof(text), "%s", format == MetricsFormat::JSON ? "null" : "nan");
+    }
+
+    switch (format) {
+        case MetricsFormat::CSV:
+            if(currentColumn != 0) buffer += ", ";
+            buffer += text;
+            break;
+        case MetricsFormat::JSON:
+            buffer += currentColumn == 0 ? (firstRow ? "\n {" : ",\n {") : ", ";
+            buffer += "\"" + escapeJson(columns[currentColumn]) + "\": ";
+            buffer += text;
+            break;
+        case MetricsFormat::COLUMNAR:
+            if(types[currentColumn] == ColumnType::NUMBER) numberColumns[currentColumn].push_back(value);
+            else textColumns[currentColumn].push_back(text);
+            break;
+    }
+    currentColumn++;
+}
+
+/**
+ * Finishes the current row. Missing values are filled with empty texts/zeros.
+ * Complexity: O(c) where c is the number of columns (amortized, chunks are written every chunkRows rows)
+ */
+void MetricsExporter::endRow() {
+    if(!inTable) return;
+    while(currentColumn < columns.size()){
+        if(types[currentColumn] == ColumnType::NUMBER) addNumber(0);
+        else addText("");
+    }
+
+    switch (format) {
+        case MetricsFormat::CSV:
+            buffer += '\n';
+            break;
+        case MetricsFormat::JSON:
+            buffer += "}";
+            break;
+        case MetricsFormat::COLUMNAR:
+            break;
+    }
+    currentColumn = 0;
+    firstRow = false;
+    rowsInChunk++;
+
+    if(format == MetricsFormat::COLUMNAR){
+        if(rowsInChunk >= chunkRows) flushChunk();
+    }
+    else {
+        flushBuffer(false);
+    }
+}
+
+/**
+ * Finishes the current table, writing the rows still in memory.
+ * Complexity: O(n) where n is the number of buffered rows
+ */
+void MetricsExporter::endTable() {
+    if(!inTable) return;
+    if(currentColumn != 0) endRow();
+
+    switch (format) {
+        case MetricsFormat::CSV:
+            flushBuffer(true);
+            break;
+        case MetricsFormat::JSON:
+            buffer += firstRow ? "]" : "\n]";
+            break;
+        case MetricsFormat::COLUMNAR: {
+            flushChunk();
+            uint32_t end = 0;
+            writeRaw(&end, sizeof(end));
+            break;
+        }
+    }
+    inTable = false;
+}
+
+/**
+ * Closes the exporter, finishing the current table and the file.
+ * Complexity: O(n) where n is the number of buffered rows
+ * @return True if every file was opened and completely written, false otherwise
+ */
+bool MetricsExporter::close() {
+    endTable();
+    if(format == MetricsFormat::JSON && out.is_open()){
+        buffer += "\n}\n";
+    }
+    flushBuffer(true);
+    if(out.is_open()){
+        out.close();
+        if(out.fail()) failed = true;
+    }
+    return !failed;
+}
+
+/**
+ * Writes the rows of the current columnar chunk, column by column.
+ * Complexity: O(n) where n is the number of values in the chunk
+ */
+void MetricsExporter::flushChunk() {
+    if(rowsInChunk == 0) return;
+
+    uint32_t rows = rowsInChunk;
+    writeRaw(&rows, sizeof(rows));
+    for(size_t i = 0; i < columns.size(); i++){
+        if(types[i] == ColumnType::NUMBER){
+            writeRaw(numberColumns[i].data(), numberColumns[i].size() * sizeof(double));
+            numberColumns[i].clear();
+        }
+        else{
+            for(const string &value : textColumns[i]) writeString(value);
+            textColumns[i].clear();
+        }
+        flushBuffer(false);
+    }
+    rowsInChunk = 0;
+    flushBuffer(true);
+}
+
+/**
+ * Writes the buffer to the file if it is big enough (or always if forced).
+ * Complexity: O(n) where n is the size of the buffer
+ * @param force If true the buffer is always written
+ */
+void MetricsExporter::flushBuffer(bool force) {
+    if(buffer.empty() || (!force && buffer.size() < BUFFER_LIMIT)) return;
+    if(out.is_open()) out.write(buffer.data(), buffer.size());
+    if(!out.is_open() || out.fail()) failed = true;
+    buffer.clear();
+}
+
+/**
+ * Opens the output stream of the exporter.
+ * Complexity: O(1)
+ * @param path Path of the file to open
+ */
+void MetricsExporter::openStream(const std::string &path) {
+    out.open(path, ios::out | ios::binary | ios::trunc);
+    if(!out.is_open()){
+        cerr << "Error: Unable to open the file " << path << '\n';
+        failed = true;
+    }
+    buffer.reserve(BUFFER_LIMIT + 1024);
+}
+
+/**
+ * Appends raw bytes to the buffer.
+ * Complexity: O(n) where n is the number of bytes
+ * @param data Bytes to append
+ * @param size Number of bytes
+ */
+void MetricsExporter::writeRaw(const void *data, std::size_t size) {
+    buffer.append(static_cast<const char *>(data), size);
+}
+
+/**
+ * Appends a string (uint32 length followed by the bytes) to the buffer.
+ * Complexity: O(n) where n is the size of the string
+ * @param value String to append
+ */
+void MetricsExporter::writeString(const std::string &value) {
+    uint32_t size = value.size();
+    writeRaw(&size, sizeof(size));
+    writeRaw(value.data(), value.size());
+}
+
+/**
+ * Escapes a string to be used inside a JSON string.
+ * Complexity: O(n) where n is the size of the string
+ * @param value String to escape
+ * @return Escaped string
+ */
+std::string MetricsExporter::escapeJson(const std::string &value) {
+    string res;
+    res.reserve(value.size());
+    for(char c : value){
+        switch (c) {
+            case '"': res += "\\\""; break;
+            case '\\': res += "\\\\"; break;
+            case '\n': res += "\\n"; break;
+            case '\r': res += "\\r"; break;
+            case '\t': res += "\\t"; break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20){
+                    char code[8];
+                    snprintf(code, sizeof(code), "\\u%04x", c);
+                    res += code;
+                }
+                else res += c;
+        }
+    }
+    return res;
+}
+
+/**
+ * Escapes a string to be used as a CSV value (quoted only if needed).
+ * Complexity: O(n) where n is the size of the string
+ * @param value String to escape
+ * @return Escaped string
+ */
+std::string MetricsExporter::escapeCsv(const std::string &value) {
+    if(value.find_first_of(",\"\n") == string::npos) return value;
+    string res = "\"";
+    for(char c : value){
+        if(c == '"') res += '"';
+        res += c;
+    }
+    return res + "\"";
+}
@@ -0,0 +1,85 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#ifndef PROJECT1_METRICSEXPORTER_H
+#define PROJECT1_METRICSEXPORTER_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include "MetricsFormat.h"
+
+/**
+ * @file MetricsExporter.h
+ * @brief Definition of class MetricsExporter.
+ *
+ * \class MetricsExporter
+ * Streams tables of metrics (cities, pipes, reservoirs...) to a file in CSV, JSON or a binary columnar format.
+ * Rows are buffered and written in chunks, so the memory used does not depend on the number of rows exported.
+ *
+ * Binary columnar layout (native byte order, little endian on every supported platform):
+ *  - file header: the magic "WSMC" followed by a uint32 version;
+ *  - per table: a uint32 name length and the name, a uint32 column count and, per column, a uint8 type and its name (uint32 length + bytes);
+ *  - per chunk: a uint32 row count followed by every column stored contiguously (NUMBER columns as doubles, TEXT columns as uint32 length + bytes per value);
+ *  - a chunk with a row count of 0 closes the table.
+ */
+class MetricsExporter {
+public:
+    /**
+     * \enum ColumnType
+     * Type of the values stored in a column.
+     */
+    enum class ColumnType{
+        TEXT,
+        NUMBER
+    };
+
+    MetricsExporter(const std::string &filepath, MetricsFormat format, std::size_t chunkRows = 4096);
+    ~MetricsExporter();
+
+    bool isOpen() const;
+
+    void beginTable(const std::string &name, const std::vector<std::string> &columns, const std::vector<ColumnType> &types);
+    void addText(const std::string &value);
+    void addNumber(double value);
+    void endRow();
+    void endTable();
+    bool close();
+
+    static std::string tableFilepath(const std::string &filepath, const std::string &table);
+
+private:
+    void flushChunk();
+    void flushBuffer(bool force);
+    void openStream(const std::string &path);
+    void writeRaw(const void *data, std::size_t size);
+    void writeString(const std::string &value);
+    static std::string escapeJson(const std::string &value);
+    static std::string escapeCsv(const std::string &value);
+
+    std::string filepath;
+    MetricsFormat format;
+    std::size_t chunkRows;
+
+    std::ofstream out;
+    std::string buffer;     // pending text (CSV/JSON) or binary bytes
+    int tableCount = 0;
+    bool failed = false;    // a file couldn't be opened or written
+
+    //current table
+    std::string tableName;
+    std::vector<std::string> columns;
+    std::vector<ColumnType> types;
+    std::size_t currentColumn = 0;
+    std::size_t rowsInChunk = 0;
+    bool firstRow = true;
+    bool inTable = false;
+
+    //columnar chunk storage (one vector per column)
+    std::vector<std::vector<double>> numberColumns;
+    std::vector<std::vector<std::string>> textColumns;
+};
+
+
+#endif //PROJECT1_METRICSEXPORTER_H
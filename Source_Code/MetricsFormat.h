@@ -0,0 +1,19 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#ifndef PROJECT1_METRICSFORMAT_H
+#define PROJECT1_METRICSFORMAT_H
+/**
+ * @file MetricsFormat.h
+ * @brief Contains a enum class to help differentiate the output formats of the metrics exporter
+ *
+ * \enum MetricsFormat
+ * Helps differentiate the output formats of the metrics exporter (text CSV, text JSON or binary columnar)
+ */
+enum class MetricsFormat{
+    CSV,
+    JSON,
+    COLUMNAR
+};
+#endif //PROJECT1_METRICSFORMAT_H
@@ -0,0 +1,218 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#include "Profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/** @file Profiler.cpp
+ *  @brief Implementation of Profiler class
+ */
+
+std::atomic<bool> Profiler::enabled(false);
+std::atomic<uint64_t> Profiler::counters[static_cast<int>(ProfilerCounter::COUNT)];
+
+namespace {
+    //maximum number of events kept for the trace (the totals are always updated)
+    const size_t MAX_EVENTS = 1000000;
+
+    struct TraceEvent {
+        const char *name;
+        const char *category;
+        long long start;    //microseconds since the profiler epoch
+        long long duration; //microseconds
+        size_t thread;
+    };
+
+    struct TimerTotal {
+        uint64_t calls = 0;
+        double totalMs = 0;
+    };
+
+    struct ProfilerData {
+        std::mutex mutex;
+        std::vector<TraceEvent> events;
+        std::map<std::string, TimerTotal> totals;
+        std::map<std::thread::id, size_t> threads;
+        std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+    };
+
+    ProfilerData &data() {
+        static ProfilerData profilerData;
+        return profilerData;
+    }
+}
+
+/**
+ * Starts a timer (only if the profiler is enabled).
+ * Complexity: O(1)
+ * @param name Name of the timed section
+ * @param category Category of the section (loading, solving, balancing, resiliency...)
+ */
+Profiler::ScopedTimer::ScopedTimer(const char *name, const char *category) : name(name), category(category), active(Profiler::isEnabled()) {
+    if(active) start = std::chrono::steady_clock::now();
+}
+
+/**
+ * Stops the timer and records the elapsed time.
+ * Complexity: O(log n) where n is the number of different timer names
+ */
+Profiler::ScopedTimer::~ScopedTimer() {
+    if(active) Profiler::recordEvent(name, category, start, std::chrono::steady_clock::now());
+}
+
+/**
+ * Enables or disables the profiler.
+ * Complexity: O(1)
+ * @param enabled_ New state of the profiler
+ */
+void Profiler::setEnabled(bool enabled_) {
+    enabled.store(enabled_, std::memory_order_relaxed);
+}
+
+/**
+ * Clears every counter, timer and event.
+ * Complexity: O(n) where n is the number of events recorded
+ */
+void Profiler::reset() {
+    for(auto &counter : counters) counter.store(0, std::memory_order_relaxed);
+    ProfilerData &d = data();
+    lock_guard<mutex> lock(d.mutex);
+    d.events.clear();
+    d.totals.clear();
+    d.epoch = std::chrono::steady_clock::now();
+}
+
+/**
+ * Gets the value of a counter.
+ * Complexity: O(1)
+ * @param counter Counter to read
+ * @return Value of the counter
+ */
+uint64_t Profiler::getCount(ProfilerCounter counter) {
+    return counters[static_cast<int>(counter)].load(std::memory_order_relaxed);
+}
+
+/**
+ * Gets the total time spent in the sections with a given name.
+ * Complexity: O(log n) where n is the number of different timer names
+ * @param name Name of the timed section
+ * @return Total time in milliseconds
+ */
+double Profiler::getTotalTime(const std::string &name) {
+    ProfilerData &d = data();
+    lock_guard<mutex> lock(d.mutex);
+    auto search = d.totals.find(name);
+    return search == d.totals.end() ? 0 : search->second.totalMs;
+}
+
+/**
+ * Gets the name of a counter used in the dumps.
+ * Complexity: O(1)
+ * @param counter Counter
+ * @return Name of the counter
+ */
+const char *Profiler::counterName(ProfilerCounter counter) {
+    switch (counter) {
+        case ProfilerCounter::CSV_LINES_READ: return "csv_lines_read";
+        case ProfilerCounter::BFS_SEARCHES: return "bfs_searches";
+        case ProfilerCounter::BFS_VERTICES_VISITED: return "bfs_vertices_visited";
+        case ProfilerCounter::EDGES_SCANNED: return "edges_scanned";
+        case ProfilerCounter::AUGMENTING_PATHS: return "augmenting_paths";
+        case ProfilerCounter::FLOW_ADD_STEPS: return "flow_add_steps";
+        case ProfilerCounter::FLOW_SUB_STEPS: return "flow_sub_steps";
+        case ProfilerCounter::COUNT: break;
+    }
+    return "unknown";
+}
+
+/**
+ * Records a timed section.
+ * Complexity: O(log n) where n is the number of different timer names
+ * @param name Name of the section
+ * @param category Category of the section
+ * @param start Start of the section
+ * @param end End of the section
+ */
+void Profiler::recordEvent(const char *name, const char *category, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    ProfilerData &d = data();
+    lock_guard<mutex> lock(d.mutex);
+
+    TimerTotal &total = d.totals[name];
+    total.calls++;
+    total.totalMs += std::chrono::duration<double, std::milli>(end - start).count();
+
+    if(d.events.size() >= MAX_EVENTS) return;
+    auto thread = d.threads.emplace(std::this_thread::get_id(), d.threads.size()).first->second;
+    d.events.push_back({name, category,
+                        std::chrono::duration_cast<std::chrono::microseconds>(start - d.epoch).count(),
+                        std::chrono::duration_cast<std::chrono::microseconds>(end - start).count(),
+                        thread});
+}
+
+/**
+ * Stores the counters and the timer totals in a JSON file.
+ * Complexity: O(n) where n is the number of different timer names
+ * @param filepath Path of the file
+ * @return True if the file was written, false otherwise
+ */
+bool Profiler::dumpJson(const std::string &filepath) {
+    ofstream fout(filepath);
+    if(!fout) return false;
+
+    fout << "{\n \"counters\": {";
+    for(int i = 0; i < static_cast<int>(ProfilerCounter::COUNT); i++){
+        fout << (i == 0 ? "\n" : ",\n") << "  \"" << counterName(static_cast<ProfilerCounter>(i)) << "\": " << counters[i].load();
+    }
+    fout << "\n },\n \"timers\": {";
+
+    ProfilerData &d = data();
+    lock_guard<mutex> lock(d.mutex);
+    bool first = true;
+    for(const auto &timer : d.totals){
+        fout << (first ? "\n" : ",\n") << "  \"" << timer.first << "\": {\"calls\": " << timer.second.calls
+             << ", \"total_ms\": " << timer.second.totalMs << "}";
+        first = false;
+    }
+    fout << "\n }\n}\n";
+    return static_cast<bool>(fout);
+}
+
+/**
+ * Stores the recorded sections (and the final counter values) as a Chrome trace file.
+ * Complexity: O(n) where n is the number of events recorded
+ * @param filepath Path of the file
+ * @return True if the file was written, false otherwise
+ */
+bool Profiler::dumpChromeTrace(const std::string &filepath) {
+    ofstream fout(filepath);
+    if(!fout) return false;
+
+    ProfilerData &d = data();
+    lock_guard<mutex> lock(d.mutex);
+
+    fout << "{\"traceEvents\": [";
+    long long last = 0;
+    bool first = true;
+    for(const TraceEvent &event : d.events){
+        fout << (first ? "\n" : ",\n") << "{\"name\": \"" << event.name << "\", \"cat\": \"" << event.category
+             << "\", \"ph\": \"X\", \"ts\": " << event.start << ", \"dur\": " << event.duration
+             << ", \"pid\": 1, \"tid\": " << event.thread << "}";
+        last = std::max(last, event.start + event.duration);
+        first = false;
+    }
+    for(int i = 0; i < static_cast<int>(ProfilerCounter::COUNT); i++){
+        fout << (first ? "\n" : ",\n") << "{\"name\": \"" << counterName(static_cast<ProfilerCounter>(i))
+             << "\", \"ph\": \"C\", \"ts\": " << last << ", \"pid\": 1, \"args\": {\"value\": " << counters[i].load() << "}}";
+        first = false;
+    }
+    fout << "\n]}\n";
+    return static_cast<bool>(fout);
+}
@@ -0,0 +1,87 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#ifndef PROJECT1_PROFILER_H
+#define PROJECT1_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * @file Profiler.h
+ * @brief Definition of class Profiler.
+ *
+ * \enum ProfilerCounter
+ * Counters kept by the profiler.
+ */
+enum class ProfilerCounter{
+    CSV_LINES_READ,
+    BFS_SEARCHES,
+    BFS_VERTICES_VISITED,
+    EDGES_SCANNED,
+    AUGMENTING_PATHS,
+    FLOW_ADD_STEPS,
+    FLOW_SUB_STEPS,
+    COUNT
+};
+
+/**
+ * \class Profiler
+ * Lightweight counters and scoped timers used to see where the time goes (loading, solving, balancing and resiliency).
+ * Everything is disabled by default: while disabled a counter or a timer only reads one atomic flag.
+ * The results can be stored as a JSON summary or as a Chrome trace file (chrome://tracing, Perfetto).
+ */
+class Profiler {
+public:
+    /**
+     * \class ScopedTimer
+     * Measures the time between its construction and destruction and records it in the profiler.
+     */
+    class ScopedTimer {
+    public:
+        ScopedTimer(const char *name, const char *category);
+        ~ScopedTimer();
+    private:
+        const char *name;
+        const char *category;
+        bool active;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    static void setEnabled(bool enabled);
+    static void reset();
+    static uint64_t getCount(ProfilerCounter counter);
+    static double getTotalTime(const std::string &name);
+    static bool dumpJson(const std::string &filepath);
+    static bool dumpChromeTrace(const std::string &filepath);
+    static const char *counterName(ProfilerCounter counter);
+
+    /**
+     * Checks if the profiler is recording.
+     * Complexity: O(1)
+     * @return True if enabled, false otherwise
+     */
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * Adds a value to a counter (does nothing while the profiler is disabled).
+     * Complexity: O(1)
+     * @param counter Counter to increment
+     * @param value Value to add
+     */
+    static void count(ProfilerCounter counter, uint64_t value = 1) {
+        if(isEnabled()) counters[static_cast<int>(counter)].fetch_add(value, std::memory_order_relaxed);
+    }
+
+private:
+    static void recordEvent(const char *name, const char *category, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+    static std::atomic<bool> enabled;
+    static std::atomic<uint64_t> counters[static_cast<int>(ProfilerCounter::COUNT)];
+};
+
+
+#endif //PROJECT1_PROFILER_H
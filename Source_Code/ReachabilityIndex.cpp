@@ -0,0 +1,159 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#include "ReachabilityIndex.h"
+
+using namespace std;
+
+/** @file ReachabilityIndex.cpp
+ *  @brief Implementation of ReachabilityIndex class
+ */
+
+/**
+ * Builds the index: finds the strongly connected components, the edges between them and, following the topological order
+ * of the condensed graph, the cities reachable from and the reservoirs that reach each component.
+ * Complexity: O(V + E + C (c + r) / 64) where C is the number of components, c the number of cities and r the number of reservoirs
+ * @param network Water network
+ */
+void ReachabilityIndex::build(const Graph<std::string> &network) {
+    vector<unsigned int> component;
+    numComponents = network.scc(component);
+
+    componentOf.clear();
+    cityCodes.clear();
+    cityBit.clear();
+    reservoirCodes.clear();
+
+    const vector<Vertex<string> *> vertexSet = network.getVertexSet();
+    for(Vertex<string> *v : vertexSet){
+        componentOf.emplace(v->getInfo(), component[v->getIndex()]);
+        if(v->getType() == VertexType::CITIES){
+            cityBit.emplace(v->getInfo(), cityCodes.size());
+            cityCodes.push_back(v->getInfo());
+        }
+        else if(v->getType() == VertexType::RESERVOIR){
+            reservoirCodes.push_back(v->getInfo());
+        }
+    }
+
+    downstream.assign(numComponents, vector<uint64_t>((cityCodes.size() + 63) / 64, 0));
+    upstream.assign(numComponents, vector<uint64_t>((reservoirCodes.size() + 63) / 64, 0));
+
+    //edges of the condensed graph (pipes between different components, both ways for bidirectional ones)
+    vector<vector<unsigned int>> next(numComponents);
+    size_t reservoir = 0;
+    for(Vertex<string> *v : vertexSet){
+        if(v->getType() == VertexType::SUPERSOURCE || v->getType() == VertexType::SUPERSINK) continue;
+        unsigned int c = component[v->getIndex()];
+        if(v->getType() == VertexType::CITIES) setBit(downstream[c], cityBit[v->getInfo()]);
+        if(v->getType() == VertexType::RESERVOIR) setBit(upstream[c], reservoir++);
+
+        for(Edge<string> *e : v->getAdj()){
+            Vertex<string> *w = e->getDest();
+            if(w->getType() == VertexType::SUPERSINK) continue;
+            if(component[w->getIndex()] != c) next[c].push_back(component[w->getIndex()]);
+            if(e->isBidirectional() && component[w->getIndex()] != c) next[component[w->getIndex()]].push_back(c);
+        }
+    }
+
+    //a component only reaches components with smaller numbers
+    for(unsigned int c = 0; c < numComponents; c++){
+        for(unsigned int d : next[c]) merge(downstream[c], downstream[d]);
+    }
+    for(unsigned int c = numComponents; c-- > 0; ){
+        for(unsigned int d : next[c]) merge(upstream[d], upstream[c]);
+    }
+}
+
+/**
+ * Checks if water can go from an element of the network (reservoir, station or city) to a city.
+ * Complexity: O(1) on average
+ * @param elementCode Code of the element
+ * @param cityCode Code of the city
+ * @return True if there is a path from the element to the city, false otherwise (or if any of them isn't in the index)
+ */
+bool ReachabilityIndex::isDownstream(const std::string &elementCode, const std::string &cityCode) const {
+    auto element = componentOf.find(elementCode);
+    auto city = cityBit.find(cityCode);
+    if(element == componentOf.end() || city == cityBit.end()) return false;
+    return testBit(downstream[element->second], city->second);
+}
+
+/**
+ * Gets the cities that can receive water from an element of the network.
+ * Complexity: O(c) where c is the number of cities
+ * @param elementCode Code of the element (reservoir, station or city)
+ * @return Codes of the cities
+ */
+std::vector<std::string> ReachabilityIndex::downstreamCities(const std::string &elementCode) const {
+    vector<string> res;
+    auto element = componentOf.find(elementCode);
+    if(element == componentOf.end()) return res;
+    for(size_t i = 0; i < cityCodes.size(); i++){
+        if(testBit(downstream[element->second], i)) res.push_back(cityCodes[i]);
+    }
+    return res;
+}
+
+/**
+ * Gets the reservoirs that can supply a city.
+ * Complexity: O(r) where r is the number of reservoirs
+ * @param cityCode Code of the city
+ * @return Codes of the reservoirs
+ */
+std::vector<std::string> ReachabilityIndex::suppliers(const std::string &cityCode) const {
+    vector<string> res;
+    auto city = componentOf.find(cityCode);
+    if(city == componentOf.end()) return res;
+    for(size_t i = 0; i < reservoirCodes.size(); i++){
+        if(testBit(upstream[city->second], i)) res.push_back(reservoirCodes[i]);
+    }
+    return res;
+}
+
+/**
+ * Checks if two elements are in the same strongly connected component (water can go both ways between them).
+ * Complexity: O(1) on average
+ * @param code1 Code of the first element
+ * @param code2 Code of the second element
+ * @return True if they are in the same component, false otherwise
+ */
+bool ReachabilityIndex::sameComponent(const std::string &code1, const std::string &code2) const {
+    auto c1 = componentOf.find(code1);
+    auto c2 = componentOf.find(code2);
+    return c1 != componentOf.end() && c2 != componentOf.end() && c1->second == c2->second;
+}
+
+/**
+ * Checks a bit of a bitset.
+ * Complexity: O(1)
+ * @param bits Bitset
+ * @param bit Position of the bit
+ * @return Value of the bit
+ */
+bool ReachabilityIndex::testBit(const std::vector<uint64_t> &bits, std::size_t bit) {
+    return (bits[bit / 64] >> (bit % 64)) & 1;
+}
+
+/**
+ * Sets a bit of a bitset.
+ * Complexity: O(1)
+ * @param bits Bitset
+ * @param bit Position of the bit
+ */
+void ReachabilityIndex::setBit(std::vector<uint64_t> &bits, std::size_t bit) {
+    bits[bit / 64] |= uint64_t(1) << (bit % 64);
+}
+
+/**
+ * Adds every bit of a bitset to another one.
+ * Complexity: O(n / 64) where n is the number of bits
+ * @param bits Bitset that is updated
+ * @param other Bitset to add
+ */
+void ReachabilityIndex::merge(std::vector<uint64_t> &bits, const std::vector<uint64_t> &other) {
+    for(size_t i = 0; i < bits.size(); i++){
+        bits[i] |= other[i];
+    }
+}
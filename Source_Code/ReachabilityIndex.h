@@ -0,0 +1,60 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#ifndef PROJECT1_REACHABILITYINDEX_H
+#define PROJECT1_REACHABILITYINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Graph.h"
+
+/**
+ * @file ReachabilityIndex.h
+ * @brief Definition of class ReachabilityIndex.
+ *
+ * \class ReachabilityIndex
+ * Precomputed reachability of the pipe network. The network is condensed into its strongly connected components
+ * (bidirectional pipes make cycles) and, on the resulting DAG, each component stores the cities it can reach and the reservoirs that can reach it.
+ * Answers "can this element (reservoir, station or pipe end) send water to this city?" and "which reservoirs can supply this city?" without a search.
+ * The super source and the super sink are ignored. The index must be built again when pipes or vertexes are added or removed.
+ */
+class ReachabilityIndex {
+public:
+    ReachabilityIndex() = default;
+
+    void build(const Graph<std::string> &network);
+
+    bool isDownstream(const std::string &elementCode, const std::string &cityCode) const;
+    std::vector<std::string> downstreamCities(const std::string &elementCode) const;
+    std::vector<std::string> suppliers(const std::string &cityCode) const;
+    bool sameComponent(const std::string &code1, const std::string &code2) const;
+
+    /**
+     * Gets the number of strongly connected components of the network (including the super nodes, if any).
+     * Complexity: O(1)
+     * @return Number of components
+     */
+    unsigned int getNumComponents() const { return numComponents; }
+
+private:
+    static bool testBit(const std::vector<uint64_t> &bits, std::size_t bit);
+    static void setBit(std::vector<uint64_t> &bits, std::size_t bit);
+    static void merge(std::vector<uint64_t> &bits, const std::vector<uint64_t> &other);
+
+    unsigned int numComponents = 0;
+    std::unordered_map<std::string, unsigned int> componentOf;
+
+    std::vector<std::string> cityCodes;
+    std::unordered_map<std::string, std::size_t> cityBit;
+    std::vector<std::string> reservoirCodes;
+
+    //bitsets (one bit per city / reservoir) indexed by component
+    std::vector<std::vector<uint64_t>> downstream;
+    std::vector<std::vector<uint64_t>> upstream;
+};
+
+
+#endif //PROJECT1_REACHABILITYINDEX_H
@@ -0,0 +1,291 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#include "SolveCache.h"
+#include <algorithm>
+#include <fstream>
+
+using namespace std;
+
+/** @file SolveCache.cpp
+ *  @brief Implementation of SolveCache class
+ */
+
+static const char FILE_MAGIC[4] = {'W', 'S', 'M', 'S'};
+static const uint32_t FILE_VERSION = 2;
+static const uint64_t HEADER_SIZE = sizeof(FILE_MAGIC) + 2 * sizeof(uint32_t);
+
+/**
+ * Writes the header of a cache file.
+ * Complexity: O(1)
+ * @param fout File, at its start
+ * @param solverVersion Version of the solvers
+ * @return True if it was written, false otherwise
+ */
+static bool writeHeader(std::ostream &fout, uint32_t solverVersion) {
+    fout.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+    fout.write(reinterpret_cast<const char *>(&FILE_VERSION), sizeof(FILE_VERSION));
+    fout.write(reinterpret_cast<const char *>(&solverVersion), sizeof(solverVersion));
+    return static_cast<bool>(fout);
+}
+
+/**
+ * Creates an empty cache (only in memory).
+ * Complexity: O(1)
+ * @param capacity Maximum number of results kept in memory
+ */
+SolveCache::SolveCache(std::size_t capacity) : capacity(capacity == 0 ? 1 : capacity) {}
+
+/**
+ * Finds the result of a key, in memory or else in the file. The result becomes the most recently used.
+ * Complexity: O(n) where n is the number of values of the result
+ * @param key Fingerprint of the question
+ * @param values Where the result is stored (unchanged if there is none)
+ * @return True if the result was found, false otherwise
+ */
+bool SolveCache::find(uint64_t key, std::vector<double> &values) {
+    auto search = index.find(key);
+    if(search != index.end()){
+        entries.splice(entries.begin(), entries, search->second);
+        values = search->second->second;
+        hits++;
+        return true;
+    }
+
+    auto stored = fileIndex.find(key);
+    if(stored != fileIndex.end()){
+        ifstream fin(filepath, ios::in | ios::binary);
+        vector<double> read(stored->second.second);
+        fin.seekg(stored->second.first);
+        if(fin.read(reinterpret_cast<char *>(read.data()), read.size() * sizeof(double))){
+            insert(key, read);
+            values = std::move(read);
+            hits++;
+            return true;
+        }
+    }
+
+    misses++;
+    return false;
+}
+
+/**
+ * Stores the result of a key (in memory and in the file, if there is one). The file is compacted first if the result doesn't
+ * fit in it, a result bigger than half of the file is only kept in memory.
+ * Complexity: O(n) where n is the number of values of the result (O(f) where f is the size of the file when it is compacted)
+ * @param key Fingerprint of the question
+ * @param values Result
+ */
+void SolveCache::store(uint64_t key, const std::vector<double> &values) {
+    insert(key, values);
+    if(filepath.empty() || fileIndex.count(key) != 0) return;
+
+    uint64_t entrySize = 2 * sizeof(uint64_t) + values.size() * sizeof(double);
+    if(HEADER_SIZE + entrySize > maxFileSize / 2) return;
+    if(fileEnd + entrySize > maxFileSize && !compactFile()) return;
+
+    fstream fout(filepath, ios::in | ios::out | ios::binary);
+    if(!fout) return;
+    uint64_t count = values.size();
+    fout.seekp(fileEnd);
+    fout.write(reinterpret_cast<const char *>(&key), sizeof(key));
+    fout.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    fout.write(reinterpret_cast<const char *>(values.data()), values.size() * sizeof(double));
+    if(!fout) return;
+
+    fileIndex[key] = make_pair(fileEnd + sizeof(key) + sizeof(count), count);
+    fileEnd += sizeof(key) + sizeof(count) + values.size() * sizeof(double);
+}
+
+/**
+ * Removes every result kept in memory (the file is not changed).
+ * Complexity: O(n) where n is the number of results in memory
+ */
+void SolveCache::clear() {
+    entries.clear();
+    index.clear();
+}
+
+/**
+ * Uses a file to store the results, reading the results it already has. The file is created if it doesn't exist.
+ * A file that doesn't have the expected header (or was written by other solvers) is started again, an incomplete result at
+ * the end is overwritten and a file bigger than the maximum size is compacted.
+ * Complexity: O(r) where r is the number of results in the file
+ * @param filepath_ Path of the file (empty to stop using a file)
+ * @param solverVersion_ Version of the solvers whose results are stored (see WaterSupplyManagement::SOLVER_VERSION)
+ * @return True if the file can be used, false otherwise
+ */
+bool SolveCache::setFile(const std::string &filepath_, uint32_t solverVersion_) {
+    filepath.clear();
+    fileIndex.clear();
+    fileEnd = 0;
+    solverVersion = solverVersion_;
+    if(filepath_.empty()) return true;
+
+    ifstream fin(filepath_, ios::in | ios::binary);
+    char magic[4] = {};
+    uint32_t version = 0, fileSolverVersion = 0;
+    bool valid = fin.read(magic, sizeof(magic)) && fin.read(reinterpret_cast<char *>(&version), sizeof(version))
+                 && fin.read(reinterpret_cast<char *>(&fileSolverVersion), sizeof(fileSolverVersion))
+                 && equal(magic, magic + 4, FILE_MAGIC) && version == FILE_VERSION && fileSolverVersion == solverVersion;
+
+    if(!valid){
+        fin.close();
+        ofstream fout(filepath_, ios::out | ios::binary | ios::trunc);
+        if(!writeHeader(fout, solverVersion)) return false;
+        fileEnd = HEADER_SIZE;
+    }
+    else{
+        fileEnd = HEADER_SIZE;
+        fin.seekg(0, ios::end);
+        uint64_t fileSize = fin.tellg();
+        fin.seekg(fileEnd);
+
+        uint64_t key, count;
+        while(fin.read(reinterpret_cast<char *>(&key), sizeof(key)) && fin.read(reinterpret_cast<char *>(&count), sizeof(count))){
+            uint64_t offset = fileEnd + sizeof(key) + sizeof(count);
+            if(count > (fileSize - offset) / sizeof(double)) break;
+            fileIndex[key] = make_pair(offset, count);
+            fileEnd = offset + count * sizeof(double);
+            fin.seekg(fileEnd);
+        }
+    }
+
+    filepath = filepath_;
+    return fileEnd <= maxFileSize || compactFile();
+}
+
+/**
+ * Changes the maximum size of the file (the file is compacted when a result doesn't fit anymore).
+ * Complexity: O(f) where f is the size of the file, if it has to be compacted now
+ * @param bytes Maximum size of the file, in bytes
+ */
+void SolveCache::setMaxFileSize(uint64_t bytes) {
+    maxFileSize = bytes;
+    if(!filepath.empty() && fileEnd > maxFileSize) compactFile();
+}
+
+/**
+ * Rewrites the file with only the newest results (the last ones of the file) that fit in half of its maximum size.
+ * Complexity: O(f) where f is the size of the file
+ * @return True if the file was rewritten, false if it couldn't be (the file is not used anymore)
+ */
+bool SolveCache::compactFile() {
+    vector<pair<uint64_t, pair<uint64_t, uint64_t>>> stored(fileIndex.begin(), fileIndex.end());
+    sort(stored.begin(), stored.end(), [](const pair<uint64_t, pair<uint64_t, uint64_t>> &a, const pair<uint64_t, pair<uint64_t, uint64_t>> &b) {
+        return a.second.first > b.second.first;
+    });
+
+    //newest results first
+    vector<pair<uint64_t, vector<double>>> kept;
+    uint64_t size = HEADER_SIZE;
+    ifstream fin(filepath, ios::in | ios::binary);
+    for(const auto &result : stored){
+        uint64_t entrySize = 2 * sizeof(uint64_t) + result.second.second * sizeof(double);
+        if(size + entrySize > maxFileSize / 2) break;
+        vector<double> values(result.second.second);
+        fin.seekg(result.second.first);
+        if(!fin.read(reinterpret_cast<char *>(values.data()), values.size() * sizeof(double))) break;
+        kept.emplace_back(result.first, std::move(values));
+        size += entrySize;
+    }
+    fin.close();
+
+    fileIndex.clear();
+    ofstream fout(filepath, ios::out | ios::binary | ios::trunc);
+    if(!writeHeader(fout, solverVersion)){
+        filepath.clear();
+        fileEnd = 0;
+        return false;
+    }
+    fileEnd = HEADER_SIZE;
+    for(auto it = kept.rbegin(); it != kept.rend(); it++){
+        uint64_t count = it->second.size();
+        fout.write(reinterpret_cast<const char *>(&it->first), sizeof(it->first));
+        fout.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        fout.write(reinterpret_cast<const char *>(it->second.data()), count * sizeof(double));
+        fileIndex[it->first] = make_pair(fileEnd + 2 * sizeof(uint64_t), count);
+        fileEnd += 2 * sizeof(uint64_t) + count * sizeof(double);
+    }
+    if(!fout){
+        filepath.clear();
+        fileIndex.clear();
+        fileEnd = 0;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Changes the maximum number of results kept in memory (the least recently used ones are dropped).
+ * Complexity: O(n) where n is the number of results dropped
+ * @param capacity_ Maximum number of results
+ */
+void SolveCache::setCapacity(std::size_t capacity_) {
+    capacity = capacity_ == 0 ? 1 : capacity_;
+    while(entries.size() > capacity){
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
+
+/**
+ * Adds (or replaces) a result in memory as the most recently used, dropping the least recently used one if it is full.
+ * Complexity: O(n) where n is the number of values of the result
+ * @param key Fingerprint of the question
+ * @param values Result
+ */
+void SolveCache::insert(uint64_t key, const std::vector<double> &values) {
+    auto search = index.find(key);
+    if(search != index.end()){
+        search->second->second = values;
+        entries.splice(entries.begin(), entries, search->second);
+        return;
+    }
+    entries.emplace_front(key, values);
+    index[key] = entries.begin();
+    setCapacity(capacity);
+}
+
+/**
+ * Adds bytes to a FNV-1a hash.
+ * Complexity: O(n) where n is the number of bytes
+ * @param h Current hash (FNV_OFFSET for an empty one)
+ * @param data Bytes to add
+ * @param size Number of bytes
+ * @return New hash
+ */
+uint64_t SolveCache::hash(uint64_t h, const void *data, std::size_t size) {
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for(size_t i = 0; i < size; i++){
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+/**
+ * Adds a string to a FNV-1a hash (its size first, so consecutive strings can't be confused).
+ * Complexity: O(n) where n is the size of the string
+ * @param h Current hash
+ * @param value String to add
+ * @return New hash
+ */
+uint64_t SolveCache::hash(uint64_t h, const std::string &value) {
+    uint64_t size = value.size();
+    h = hash(h, &size, sizeof(size));
+    return hash(h, value.data(), value.size());
+}
+
+/**
+ * Adds a number to a FNV-1a hash.
+ * Complexity: O(1)
+ * @param h Current hash
+ * @param value Number to add
+ * @return New hash
+ */
+uint64_t SolveCache::hash(uint64_t h, double value) {
+    if(value == 0) value = 0; //-0 and 0 are the same number
+    return hash(h, &value, sizeof(value));
+}
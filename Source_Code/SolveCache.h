@@ -0,0 +1,70 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#ifndef PROJECT1_SOLVECACHE_H
+#define PROJECT1_SOLVECACHE_H
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @file SolveCache.h
+ * @brief Definition of class SolveCache.
+ *
+ * \class SolveCache
+ * Results of solves (the flow of every pipe) keyed by a fingerprint of the network and of the question asked (see WaterSupplyManagement::fingerprint).
+ * The most recently used results are kept in memory (least recently used ones are dropped when it is full) and, optionally,
+ * every result is also appended to a file so the same questions are answered without solving in later sessions.
+ * The file is tagged with the version of the solvers that wrote it: results of other versions are discarded. When the file
+ * reaches its maximum size it is compacted, keeping the newest results that fit in half of it.
+ *
+ * File layout (native byte order, little endian on every supported platform):
+ *  - header: the magic "WSMS" followed by a uint32 format version and a uint32 solver version;
+ *  - per result: a uint64 key, a uint64 count and the values as doubles.
+ */
+class SolveCache {
+public:
+    explicit SolveCache(std::size_t capacity = 64);
+
+    bool find(uint64_t key, std::vector<double> &values);
+    void store(uint64_t key, const std::vector<double> &values);
+    void clear();
+
+    bool setFile(const std::string &filepath, uint32_t solverVersion = 0);
+    void setCapacity(std::size_t capacity);
+    void setMaxFileSize(uint64_t bytes);
+
+    std::size_t size() const { return entries.size(); }
+    uint64_t getFileSize() const { return fileEnd; }
+    uint64_t getHits() const { return hits; }
+    uint64_t getMisses() const { return misses; }
+
+    static const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+    static uint64_t hash(uint64_t h, const void *data, std::size_t size);
+    static uint64_t hash(uint64_t h, const std::string &value);
+    static uint64_t hash(uint64_t h, double value);
+
+private:
+    void insert(uint64_t key, const std::vector<double> &values);
+    bool compactFile();
+
+    std::size_t capacity;
+    std::list<std::pair<uint64_t, std::vector<double>>> entries;   // most recently used first
+    std::unordered_map<uint64_t, std::list<std::pair<uint64_t, std::vector<double>>>::iterator> index;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    //results stored in the file
+    std::string filepath;
+    std::unordered_map<uint64_t, std::pair<uint64_t, uint64_t>> fileIndex;   // key -> offset and count of the values
+    uint64_t fileEnd = 0;
+    uint32_t solverVersion = 0;
+    uint64_t maxFileSize = 64ULL << 20;
+};
+
+
+#endif //PROJECT1_SOLVECACHE_H
@@ -1,6 +1,7 @@
 #ifndef PROJECT1_STATION_H
 #define PROJECT1_STATION_H
 #include <string>
+#include <limits>
 /**
  * @file Station.h
  * @brief Definition of class Station.
@@ -11,7 +12,7 @@
 class Station{
     public:
         Station()=default;
-        Station(std::string code_ , int id_) : code(code_) , id(id_) {};
+        Station(std::string code_ , int id_, double capacity_ = std::numeric_limits<double>::infinity()) : code(code_) , id(id_), capacity(capacity_) {};
 
         //Getters ============================================================================
         /**
@@ -26,6 +27,18 @@ class Station{
          * @return Station's code.
          */
         std::string getCode(){return code;}
+        /**
+         * Gets the most water the station can pump.
+         * Complexity: O(1)
+         * @return Station's capacity (infinity if it has no limit)
+         */
+        double getCapacity() const {return capacity;}
+        /**
+         * Checks if the station has a limit on the water it can pump.
+         * Complexity: O(1)
+         * @return True if the capacity is finite and not negative, false otherwise
+         */
+        bool hasCapacity() const {return capacity >= 0 && capacity != std::numeric_limits<double>::infinity();}
 
         //Setters ============================================================================
         /**
@@ -40,6 +53,12 @@ class Station{
          * @param id_ New station id
          */
         void setStationId(int id_){id = id_;}
+        /**
+         * Sets the station's capacity.
+         * Complexity: O(1)
+         * @param capacity_ New capacity (infinity for no limit)
+         */
+        void setCapacity(double capacity_){capacity = capacity_;}
 
         //Operator ===========================================================================
         bool operator==(const Station &other) const{
@@ -48,6 +67,7 @@ class Station{
     private:
         int id;
         std::string code;
+        double capacity = std::numeric_limits<double>::infinity(); //water pumped per unit of time, infinity if unlimited
 };
 
 
@@ -0,0 +1,226 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#ifndef PROJECT1_TRAVERSALWORKSPACE_H
+#define PROJECT1_TRAVERSALWORKSPACE_H
+
+#include <cstdint>
+#include <vector>
+
+template <class T>
+class Vertex;
+
+template <class T>
+class Edge;
+
+/**
+ * @file TraversalWorkspace.h
+ * @brief Definition of class TraversalWorkspace.
+ *
+ * \class TraversalWorkspace
+ * Scratch state of a traversal (visited, processing, indegree, distance and path of each vertex), kept outside the vertexes
+ * so different traversals don't overwrite each other and can run at the same time on the same graph.
+ * The state of a vertex is indexed by its position in the graph. Each value has a generation stamp and only counts if the stamp
+ * is the current generation, so reset() doesn't have to go through the vertexes.
+ */
+template <class T>
+class TraversalWorkspace {
+public:
+    TraversalWorkspace() = default;
+    explicit TraversalWorkspace(std::size_t numVertex);
+
+    void reset(std::size_t numVertex);
+
+    bool isVisited(const Vertex<T> *v) const;
+    bool isProcessing(const Vertex<T> *v) const;
+    unsigned int getIndegree(const Vertex<T> *v) const;
+    double getDist(const Vertex<T> *v) const;
+    Edge<T> *getPath(const Vertex<T> *v) const;
+
+    void setVisited(const Vertex<T> *v, bool visited);
+    void setProcessing(const Vertex<T> *v, bool processing);
+    void setIndegree(const Vertex<T> *v, unsigned int indegree);
+    void setDist(const Vertex<T> *v, double dist);
+    void setPath(const Vertex<T> *v, Edge<T> *path);
+
+protected:
+    /**
+     * \struct Slot
+     * State of a single vertex. A field is only valid if its stamp is the current generation.
+     */
+    struct Slot {
+        uint32_t visitedStamp = 0;
+        uint32_t processingStamp = 0;
+        uint32_t indegreeStamp = 0;
+        uint32_t distStamp = 0;
+        uint32_t pathStamp = 0;
+        unsigned int indegree = 0;
+        double dist = 0;
+        Edge<T> *path = nullptr;
+    };
+
+    std::vector<Slot> slots;
+    uint32_t generation = 1;
+};
+
+/**
+ * Creates a workspace for a graph with a given number of vertexes.
+ * Complexity: O(n) where n is the number of vertexes
+ * @tparam T Type of the class
+ * @param numVertex Number of vertexes of the graph
+ */
+template <class T>
+TraversalWorkspace<T>::TraversalWorkspace(std::size_t numVertex) : slots(numVertex) {}
+
+/**
+ * Clears the state of every vertex (nothing is visited, processing or has a path) and makes room for the vertexes of the graph.
+ * Complexity: O(1) amortized (O(n) when the graph grows or once every 2^32 resets)
+ * @tparam T Type of the class
+ * @param numVertex Number of vertexes of the graph
+ */
+template <class T>
+void TraversalWorkspace<T>::reset(std::size_t numVertex) {
+    if (slots.size() < numVertex) {
+        slots.resize(numVertex);
+    }
+    generation++;
+    if (generation == 0) {
+        // the stamps wrapped around, old values could look current
+        for (auto &slot : slots) {
+            slot = Slot();
+        }
+        generation = 1;
+    }
+}
+
+/**
+ * Gets the vertex's visited state.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param v Vertex
+ * @return Vertex's visited state
+ */
+template <class T>
+bool TraversalWorkspace<T>::isVisited(const Vertex<T> *v) const {
+    return v->getIndex() < slots.size() && slots[v->getIndex()].visitedStamp == generation;
+}
+
+/**
+ * Gets the vertex's processing state.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param v Vertex
+ * @return Vertex's processing state
+ */
+template <class T>
+bool TraversalWorkspace<T>::isProcessing(const Vertex<T> *v) const {
+    return v->getIndex() < slots.size() && slots[v->getIndex()].processingStamp == generation;
+}
+
+/**
+ * Gets the vertex's indegree.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param v Vertex
+ * @return Vertex's indegree (0 if it wasn't set since the last reset)
+ */
+template <class T>
+unsigned int TraversalWorkspace<T>::getIndegree(const Vertex<T> *v) const {
+    if (v->getIndex() >= slots.size() || slots[v->getIndex()].indegreeStamp != generation) return 0;
+    return slots[v->getIndex()].indegree;
+}
+
+/**
+ * Gets the vertex's distance.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param v Vertex
+ * @return Vertex's distance (0 if it wasn't set since the last reset)
+ */
+template <class T>
+double TraversalWorkspace<T>::getDist(const Vertex<T> *v) const {
+    if (v->getIndex() >= slots.size() || slots[v->getIndex()].distStamp != generation) return 0;
+    return slots[v->getIndex()].dist;
+}
+
+/**
+ * Gets the edge used to reach the vertex.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param v Vertex
+ * @return Edge used to reach the vertex (nullptr if it wasn't set since the last reset)
+ */
+template <class T>
+Edge<T> *TraversalWorkspace<T>::getPath(const Vertex<T> *v) const {
+    if (v->getIndex() >= slots.size() || slots[v->getIndex()].pathStamp != generation) return nullptr;
+    return slots[v->getIndex()].path;
+}
+
+/**
+ * Sets the vertex's visited state.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param v Vertex
+ * @param visited New visited state for the vertex
+ */
+template <class T>
+void TraversalWorkspace<T>::setVisited(const Vertex<T> *v, bool visited) {
+    slots.at(v->getIndex()).visitedStamp = visited ? generation : 0;
+}
+
+/**
+ * Sets the vertex's processing state.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param v Vertex
+ * @param processing New processing state for the vertex
+ */
+template <class T>
+void TraversalWorkspace<T>::setProcessing(const Vertex<T> *v, bool processing) {
+    slots.at(v->getIndex()).processingStamp = processing ? generation : 0;
+}
+
+/**
+ * Sets the vertex's indegree.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param v Vertex
+ * @param indegree New indegree for the vertex
+ */
+template <class T>
+void TraversalWorkspace<T>::setIndegree(const Vertex<T> *v, unsigned int indegree) {
+    Slot &slot = slots.at(v->getIndex());
+    slot.indegree = indegree;
+    slot.indegreeStamp = generation;
+}
+
+/**
+ * Sets the vertex's distance.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param v Vertex
+ * @param dist New distance value
+ */
+template <class T>
+void TraversalWorkspace<T>::setDist(const Vertex<T> *v, double dist) {
+    Slot &slot = slots.at(v->getIndex());
+    slot.dist = dist;
+    slot.distStamp = generation;
+}
+
+/**
+ * Sets the edge used to reach the vertex.
+ * Complexity: O(1)
+ * @tparam T Type of the class
+ * @param v Vertex
+ * @param path New path (nullptr clears it)
+ */
+template <class T>
+void TraversalWorkspace<T>::setPath(const Vertex<T> *v, Edge<T> *path) {
+    Slot &slot = slots.at(v->getIndex());
+    slot.path = path;
+    slot.pathStamp = path == nullptr ? 0 : generation;
+}
+
+#endif //PROJECT1_TRAVERSALWORKSPACE_H
@@ -0,0 +1,121 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#include "ValidationReport.h"
+
+using namespace std;
+
+/** @file ValidationReport.cpp
+ *  @brief Implementation of ValidationReport class
+ */
+
+/**
+ * Adds a problem to the report.
+ * Complexity: O(1) amortized
+ * @param type Kind of problem
+ * @param file File where the element comes from
+ * @param line Line of the element in the file (0 if unknown)
+ * @param code Code of the element (origin->destination for pipes)
+ */
+void ValidationReport::add(IssueType type, VertexType file, std::size_t line, const std::string &code) {
+    Issue issue = {type, file, line, code};
+    issues.push_back(issue);
+}
+
+/**
+ * Adds the problems of another report after the ones of this report (the statistics are not changed).
+ * Complexity: O(n) where n is the number of problems of the other report
+ * @param other Report to add
+ */
+void ValidationReport::append(const ValidationReport &other) {
+    issues.insert(issues.end(), other.issues.begin(), other.issues.end());
+}
+
+/**
+ * Removes every problem and resets the statistics.
+ * Complexity: O(n) where n is the number of problems
+ */
+void ValidationReport::clear() {
+    issues.clear();
+    statistics = Statistics();
+}
+
+/**
+ * Counts the problems of a kind.
+ * Complexity: O(n) where n is the number of problems
+ * @param type Kind of problem
+ * @return Number of problems of that kind
+ */
+std::size_t ValidationReport::count(IssueType type) const {
+    size_t res = 0;
+    for(const Issue &issue : issues){
+        if(issue.type == type) res++;
+    }
+    return res;
+}
+
+/**
+ * Prints the statistics, the number of problems of each kind and every problem.
+ * Complexity: O(n) where n is the number of problems
+ * @param os Stream where the report is printed
+ */
+void ValidationReport::print(std::ostream &os) const {
+    os << "Reservoirs: " << statistics.reservoirs << ", stations: " << statistics.stations << ", cities: " << statistics.cities
+       << " (" << statistics.reachableCities << " reachable), pipes: " << statistics.pipes << '\n';
+    os << "Capacity leaving the reservoirs: " << statistics.totalCapacity << '\n';
+    if(isValid()){
+        os << "No problems found\n";
+        return;
+    }
+
+    for(int t = 0; t < static_cast<int>(IssueType::COUNT); t++){
+        size_t n = count(static_cast<IssueType>(t));
+        if(n != 0) os << typeName(static_cast<IssueType>(t)) << ": " << n << '\n';
+    }
+    for(const Issue &issue : issues){
+        os << fileName(issue.file);
+        if(issue.line != 0) os << ", line " << issue.line;
+        os << ": " << typeName(issue.type) << ' ' << issue.code;
+        if(issue.repaired) os << " (repaired)";
+        os << '\n';
+    }
+}
+
+/**
+ * Gets the name of a kind of problem, to show it to the user.
+ * Complexity: O(1)
+ * @param type Kind of problem
+ * @return Name of the kind of problem
+ */
+const char *ValidationReport::typeName(IssueType type) {
+    switch (type) {
+        case IssueType::FILE_NOT_OPENED: return "file not opened";
+        case IssueType::DUPLICATE_CODE: return "duplicate code";
+        case IssueType::DUPLICATE_PIPE: return "duplicate pipe";
+        case IssueType::DANGLING_ENDPOINT: return "pipe endpoint not in the network";
+        case IssueType::NON_POSITIVE_CAPACITY: return "capacity of zero or less";
+        case IssueType::UNREACHABLE_CITY: return "city not reachable from any reservoir";
+        case IssueType::STATION_WITHOUT_OUTFLOW: return "station without outflow";
+        case IssueType::NEGATIVE_COST: return "negative cost";
+        case IssueType::INVALID_STATION_CAPACITY: return "invalid station capacity";
+        case IssueType::COUNT: break;
+    }
+    return "";
+}
+
+/**
+ * Gets the name of the file with the elements of a type.
+ * Complexity: O(1)
+ * @param file Type of the elements of the file
+ * @return Name of the file
+ */
+const char *ValidationReport::fileName(VertexType file) {
+    switch (file) {
+        case VertexType::RESERVOIR: return "Reservoirs file";
+        case VertexType::STATIONS: return "Stations file";
+        case VertexType::CITIES: return "Cities file";
+        case VertexType::PIPE: return "Pipes file";
+        default: return "Network";
+    }
+}
@@ -0,0 +1,94 @@
+//
+// Created by lucas on 19/10/2026.
+//
+
+#ifndef PROJECT1_VALIDATIONREPORT_H
+#define PROJECT1_VALIDATIONREPORT_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "VertexType.h"
+
+/**
+ * @file ValidationReport.h
+ * @brief Definition of class ValidationReport.
+ *
+ * \class ValidationReport
+ * Problems found in the data files and in the loaded network (see WaterSupplyManagement::validate), each one with the file
+ * and line it comes from, plus statistics of the network checked.
+ */
+class ValidationReport {
+public:
+    /**
+     * \enum IssueType
+     * Kind of problem found.
+     */
+    enum class IssueType{
+        FILE_NOT_OPENED,            // nothing was read from the file
+        DUPLICATE_CODE,             // a reservoir, station or city with the code of an earlier one (ignored)
+        DUPLICATE_PIPE,             // a pipe between the same vertexes as an earlier one (added anyway)
+        DANGLING_ENDPOINT,          // a pipe to or from a code that is not in the network (ignored)
+        NON_POSITIVE_CAPACITY,      // a pipe with a capacity of zero or less
+        UNREACHABLE_CITY,           // a city that no reservoir can reach
+        STATION_WITHOUT_OUTFLOW,    // a station with no pipe leaving it
+        NEGATIVE_COST,              // a pipe with a negative cost, which would make the cheapest flow unbounded (ignored)
+        INVALID_STATION_CAPACITY,   // a station with a negative or not a number capacity (read as no limit)
+        COUNT                       // number of types, not a type
+    };
+
+    /**
+     * \struct Issue
+     * A problem, with the file (identified by the type of element it has) and line where it comes from (0 if unknown).
+     */
+    struct Issue {
+        IssueType type;
+        VertexType file;
+        std::size_t line = 0;
+        std::string code;           // code of the element (origin->destination for pipes)
+        bool repaired = false;      // the network was changed to remove the problem
+    };
+
+    /**
+     * \struct Statistics
+     * Size of the network checked.
+     */
+    struct Statistics {
+        std::size_t reservoirs = 0;
+        std::size_t stations = 0;
+        std::size_t cities = 0;
+        std::size_t pipes = 0;
+        std::size_t reachableCities = 0;
+        double totalCapacity = 0;   // of the pipes leaving reservoirs
+    };
+
+    void add(IssueType type, VertexType file, std::size_t line, const std::string &code);
+    void append(const ValidationReport &other);
+    void clear();
+
+    const std::vector<Issue> &getIssues() const { return issues; }
+    std::vector<Issue> &getIssues() { return issues; }
+    std::size_t count(IssueType type) const;
+
+    /**
+     * Checks if no problem was found.
+     * Complexity: O(1)
+     * @return True if there are no issues, false otherwise
+     */
+    bool isValid() const { return issues.empty(); }
+
+    Statistics &getStatistics() { return statistics; }
+    const Statistics &getStatistics() const { return statistics; }
+
+    void print(std::ostream &os) const;
+
+    static const char *typeName(IssueType type);
+    static const char *fileName(VertexType file);
+
+private:
+    std::vector<Issue> issues;
+    Statistics statistics;
+};
+
+
+#endif //PROJECT1_VALIDATIONREPORT_H
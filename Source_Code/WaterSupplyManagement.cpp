@@ -3,8 +3,19 @@
 //
 
 #include "WaterSupplyManagement.h"
+#include "MetricsExporter.h"
+#include "Profiler.h"
+#include "FlowNetwork.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <thread>
 #include <fstream>
 #include <sstream>
+#include <cmath>
 
 using namespace std;
 
@@ -14,7 +25,7 @@ using namespace std;
  * Complexity: O(1)
  * @return Water graph/network
  */
-Graph<std::string> WaterSupplyManagement::getNetwork() const {
+const Graph<std::string> &WaterSupplyManagement::getNetwork() const {
     return network;
 }
 
@@ -87,6 +98,33 @@ unordered_map<std::string, City> WaterSupplyManagement::getCodeToCity() const {
     return codeToCity;
 }
 
+/**
+ * Gets the codes of the reservoirs in the order they were added (file order).
+ * Complexity: O(1)
+ * @return Codes of the reservoirs
+ */
+const std::vector<std::string> &WaterSupplyManagement::getReservoirCodes() const {
+    return reservoirCodes;
+}
+
+/**
+ * Gets the codes of the stations in the order they were added (file order).
+ * Complexity: O(1)
+ * @return Codes of the stations
+ */
+const std::vector<std::string> &WaterSupplyManagement::getStationCodes() const {
+    return stationCodes;
+}
+
+/**
+ * Gets the codes of the cities in the order they were added (file order).
+ * Complexity: O(1)
+ * @return Codes of the cities
+ */
+const std::vector<std::string> &WaterSupplyManagement::getCityCodes() const {
+    return cityCodes;
+}
+
 /**
  * Used to select the path to the desired dataset.
  * Complexity: O(1)
@@ -133,16 +171,131 @@ void WaterSupplyManagement::selectDataSet(DataSetSelection dataset, VertexType t
 }
 
 //data readers =========================================================================
-/** Reads data from the cities file and stores it in a hash map
+/**
+ * Minimum size of each part of a pipes file parsed by its own thread (smaller files are parsed by a single thread).
+ */
+static const size_t PARSE_CHUNK_BYTES = 1 << 18;
+
+/** Reads data from the cities file and stores it in a hash map.
  *  Complexity: O(n)
  */
 void WaterSupplyManagement::readCities(DataSetSelection dataset) {
+    Profiler::ScopedTimer timer("readCities", "loading");
     string filepath;
     selectDataSet(dataset, VertexType::CITIES, &filepath);
 
+    vector<City> cities = parseCities(filepath, &loadReport);
+    for(size_t i = 0; i < cities.size(); i++){
+        recordLoaded(addCity(cities[i]), VertexType::CITIES, i + 2, cities[i].getCode());
+    }
+}
+
+/** Reads data from the reservoirs file and stores it in a hash map
+ *  Complexity: O(n)
+ */
+void WaterSupplyManagement::readReservoirs(DataSetSelection dataset) {
+    Profiler::ScopedTimer timer("readReservoirs", "loading");
+    string filepath;
+    selectDataSet(dataset,VertexType::RESERVOIR, &filepath);
+
+    vector<Reservoir> reservoirs = parseReservoirs(filepath, &loadReport);
+    for(size_t i = 0; i < reservoirs.size(); i++){
+        recordLoaded(addReservoir(reservoirs[i]), VertexType::RESERVOIR, i + 2, reservoirs[i].getCode());
+    }
+}
+
+/** Reads data from the stations file and stores it in a hash map
+ *  Complexity: O(n)
+ */
+void WaterSupplyManagement::readStations(DataSetSelection dataset) {
+    Profiler::ScopedTimer timer("readStations", "loading");
+    string filepath;
+    selectDataSet(dataset,VertexType::STATIONS, &filepath);
+
+    vector<Station> stations = parseStations(filepath, &loadReport);
+    for(size_t i = 0; i < stations.size(); i++){
+        recordLoaded(addStation(stations[i]), VertexType::STATIONS, i + 2, stations[i].getCode());
+    }
+}
+
+/** Reads data from the pipes file and creates edges in the graph with the data read (see parsePipes).
+ *  Complexity: O(n / t + n) where n is the number of pipes and t is the number of threads (parsing is split between the threads, adding is not)
+ *  @param numThreads Maximum number of threads used to parse the file (0 uses one per hardware thread)
+ */
+void WaterSupplyManagement::readPipes(DataSetSelection dataset, unsigned numThreads) {
+    Profiler::ScopedTimer timer("readPipes", "loading");
+    string filepath;
+    selectDataSet(dataset,VertexType::PIPE, &filepath);
+
+    addPipes(parsePipes(filepath, numThreads, &loadReport));
+}
+
+/**
+ * Reads the cities, reservoirs and stations files at the same time (each one by its own thread) and stores them in the hash maps,
+ * in the same order as readCities, readReservoirs and readStations called one after the other.
+ * The pipes file is parsed at the same time, but the pipes are only returned: they can only be added (see addPipes)
+ * after their endpoints are inserted in the network.
+ * Complexity: O(n / t + n) where n is the size of the files and t is the number of threads
+ * @param dataset Which dataset we want (Big/Small)
+ * @param numThreads Maximum number of threads used to parse the pipes file (0 uses one per hardware thread)
+ * @return Pipes of the pipes file, in the order of the file
+ */
+std::vector<WaterSupplyManagement::PipeRecord> WaterSupplyManagement::readData(DataSetSelection dataset, unsigned numThreads) {
+    Profiler::ScopedTimer timer("readData", "loading");
+    string citiesPath, reservoirsPath, stationsPath, pipesPath;
+    selectDataSet(dataset, VertexType::CITIES, &citiesPath);
+    selectDataSet(dataset, VertexType::RESERVOIR, &reservoirsPath);
+    selectDataSet(dataset, VertexType::STATIONS, &stationsPath);
+    selectDataSet(dataset, VertexType::PIPE, &pipesPath);
+
+    //an error in a file is thrown again by the calling thread, after every thread finished
+    vector<City> cities;
+    vector<Reservoir> reservoirs;
+    vector<Station> stations;
+    exception_ptr errors[3];
+    ValidationReport reports[4];
+    vector<thread> threads;
+    threads.emplace_back([&]() { try { cities = parseCities(citiesPath, &reports[0]); } catch(...) { errors[0] = current_exception(); } });
+    threads.emplace_back([&]() { try { reservoirs = parseReservoirs(reservoirsPath, &reports[1]); } catch(...) { errors[1] = current_exception(); } });
+    threads.emplace_back([&]() { try { stations = parseStations(stationsPath, &reports[2]); } catch(...) { errors[2] = current_exception(); } });
+
+    vector<PipeRecord> pipes;
+    exception_ptr pipesError;
+    try { pipes = parsePipes(pipesPath, numThreads, &reports[3]); } catch(...) { pipesError = current_exception(); }
+    for(thread &t : threads) t.join();
+
+    for(const exception_ptr &error : errors){
+        if(error) rethrow_exception(error);
+    }
+    if(pipesError) rethrow_exception(pipesError);
+
+    for(const ValidationReport &report : reports) loadReport.append(report);
+    for(size_t i = 0; i < cities.size(); i++){
+        recordLoaded(addCity(cities[i]), VertexType::CITIES, i + 2, cities[i].getCode());
+    }
+    for(size_t i = 0; i < reservoirs.size(); i++){
+        recordLoaded(addReservoir(reservoirs[i]), VertexType::RESERVOIR, i + 2, reservoirs[i].getCode());
+    }
+    for(size_t i = 0; i < stations.size(); i++){
+        recordLoaded(addStation(stations[i]), VertexType::STATIONS, i + 2, stations[i].getCode());
+    }
+    return pipes;
+}
+
+/** Parses the cities file.
+ *  An optional Priority column after the population gives the priority of the city (see priorityAllocation).
+ *  Complexity: O(n)
+ *  @param filepath Path to the file
+ *  @param report Where a file that can't be opened is reported (optional)
+ *  @return Cities in the order of the file (the city of position i is in line i + 2)
+ */
+std::vector<City> WaterSupplyManagement::parseCities(const std::string &filepath, ValidationReport *report) {
+    vector<City> cities;
     ifstream file(filepath);
     if(!file.is_open()){
         cerr << "Error: Unable to open the file." << '\n';
+        if(report != nullptr) report->add(ValidationReport::IssueType::FILE_NOT_OPENED, VertexType::CITIES, 0, filepath);
+        return {};
     }
 
     string line;
@@ -152,6 +305,7 @@ void WaterSupplyManagement::readCities(DataSetSelection dataset) {
     std::string name, code;
     int id, population, demand;
     while(getline(file,line)){
+        Profiler::count(ProfilerCounter::CSV_LINES_READ);
 
         //get name
         size_t it = line.find_first_of(',');
@@ -174,24 +328,32 @@ void WaterSupplyManagement::readCities(DataSetSelection dataset) {
         line = line.substr(it + 1);
 
         //get population
-        population = stoi(line);
+        it = line.find_first_of(',');
+        population = stoi(line.substr(0,it));
 
-        //construct the city and puts it in the hash table
+        //construct the city
         City city {name, id, code, demand, population};
-        codeToCity.emplace(code, city);
+
+        //get priority (optional)
+        if(it != string::npos && line.find_first_of("0123456789", it) != string::npos) city.setPriority(stod(line.substr(it + 1)));
+        cities.push_back(city);
     }
+    return cities;
 }
 
-/** Reads data from the reservoirs file and stores it in a hash map
+/** Parses the reservoirs file.
  *  Complexity: O(n)
+ *  @param filepath Path to the file
+ *  @param report Where a file that can't be opened is reported (optional)
+ *  @return Reservoirs in the order of the file (the reservoir of position i is in line i + 2)
  */
-void WaterSupplyManagement::readReservoirs(DataSetSelection dataset) {
-    string filepath;
-    selectDataSet(dataset,VertexType::RESERVOIR, &filepath);
-
+std::vector<Reservoir> WaterSupplyManagement::parseReservoirs(const std::string &filepath, ValidationReport *report) {
+    vector<Reservoir> reservoirs;
     ifstream file(filepath);
     if(!file.is_open()){
         cerr << "Error: Unable to open the file." << '\n';
+        if(report != nullptr) report->add(ValidationReport::IssueType::FILE_NOT_OPENED, VertexType::RESERVOIR, 0, filepath);
+        return {};
     }
 
     string line;
@@ -203,6 +365,7 @@ void WaterSupplyManagement::readReservoirs(DataSetSelection dataset) {
     double max_delivery;
 
     while(getline(file, line)){
+        Profiler::count(ProfilerCounter::CSV_LINES_READ);
 
         //get name
         size_t it = line.find_first_of(',');
@@ -227,23 +390,27 @@ void WaterSupplyManagement::readReservoirs(DataSetSelection dataset) {
         //get max delivery
         max_delivery = stod(line);
 
-        //construct the reservoir and emplace it in the hash map
-        Reservoir reservoir {name, municipality, id, code ,max_delivery};
-        codeToReservoir.emplace(code, reservoir);
+        //construct the reservoir
+        reservoirs.push_back(Reservoir {name, municipality, id, code ,max_delivery});
     }
-
+    return reservoirs;
 }
 
-/** Reads data from the stations file and stores it in a hash map
+/** Parses the stations file.
+ *  An optional Capacity column after the code gives the most water the station can pump (see Station::getCapacity);
+ *  a negative capacity is reported and the station gets no limit.
  *  Complexity: O(n)
+ *  @param filepath Path to the file
+ *  @param report Where a file that can't be opened is reported (optional)
+ *  @return Stations in the order of the file (the station of position i is in line i + 2)
  */
-void WaterSupplyManagement::readStations(DataSetSelection dataset) {
-    string filepath;
-    selectDataSet(dataset,VertexType::STATIONS, &filepath);
-
+std::vector<Station> WaterSupplyManagement::parseStations(const std::string &filepath, ValidationReport *report) {
+    vector<Station> stations;
     ifstream file(filepath);
     if(!file.is_open()){
         cerr << "Error: Unable to open the file." << '\n';
+        if(report != nullptr) report->add(ValidationReport::IssueType::FILE_NOT_OPENED, VertexType::STATIONS, 0, filepath);
+        return {};
     }
 
     string line;
@@ -253,6 +420,7 @@ void WaterSupplyManagement::readStations(DataSetSelection dataset) {
     int id;
     string code;
     while(getline(file, line)){
+        Profiler::count(ProfilerCounter::CSV_LINES_READ);
 
         //get id
         size_t it = line.find_first_of(',');
@@ -260,60 +428,230 @@ void WaterSupplyManagement::readStations(DataSetSelection dataset) {
         line = line.substr(it + 1);
 
         //get code
-        code = line;
+        it = line.find_first_of(',');
+        code = line.substr(0,it);
 
-        //construct the station and emplace it in the hash map
+        //construct the station
         Station station {code ,id};
-        codeToStation.emplace(code, station);
+
+        //get capacity (optional), a negative one is reported and ignored
+        if(it != string::npos && line.find_first_of("0123456789", it) != string::npos){
+            double capacity = stod(line.substr(it + 1));
+            if(capacity >= 0) station.setCapacity(capacity);
+            else if(report != nullptr) report->add(ValidationReport::IssueType::INVALID_STATION_CAPACITY, VertexType::STATIONS, stations.size() + 2, code);
+        }
+        stations.push_back(station);
     }
+    return stations;
 }
 
-/** Reads data from the pipes file and creates edges in the graph with the data read
- *  Complexity: O(n)
+/** Parses the pipes file. The file is read at once and split in parts that end at a line break; each part is parsed by
+ *  its own thread and the parts are joined in the order of the file, so the result is the same for any number of threads.
+ *  An optional Cost column after the direction gives the cost per unit of water of the pipe (see minCostAllocation).
+ *  Empty lines are skipped, pipes with a negative cost are skipped and reported.
+ *  Complexity: O(n / t) where n is the size of the file and t is the number of threads
+ *  @param filepath Path to the file
+ *  @param numThreads Maximum number of threads (0 uses one per hardware thread)
+ *  @param report Where a file that can't be opened and the pipes with a negative cost are reported (optional)
+ *  @return Pipes in the order of the file, with their line
  */
-void WaterSupplyManagement::readPipes(DataSetSelection dataset) {
-    string filepath;
-    selectDataSet(dataset,VertexType::PIPE, &filepath);
-
-    ifstream file(filepath);
+std::vector<WaterSupplyManagement::PipeRecord> WaterSupplyManagement::parsePipes(const std::string &filepath, unsigned numThreads, ValidationReport *report) {
+    ifstream file(filepath, ios::in | ios::binary);
     if(!file.is_open()){
         cerr << "Error: Unable to open the file." << '\n';
+        if(report != nullptr) report->add(ValidationReport::IssueType::FILE_NOT_OPENED, VertexType::PIPE, 0, filepath);
+        return {};
+    }
+    file.seekg(0, ios::end);
+    string content(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    file.read(&content[0], content.size());
+
+    size_t begin = content.find('\n'); //header line
+    if(begin == string::npos) return {};
+    begin++;
+
+    //parts of at least PARSE_CHUNK_BYTES, each one starting after a line break
+    if(numThreads == 0) numThreads = max(1u, thread::hardware_concurrency());
+    size_t numParts = min<size_t>(numThreads, max<size_t>(1, (content.size() - begin) / PARSE_CHUNK_BYTES));
+    vector<size_t> bounds(numParts + 1, content.size());
+    bounds[0] = begin;
+    for(size_t k = 1; k < numParts; k++){
+        size_t pos = content.find('\n', max(bounds[k - 1], begin + (content.size() - begin) / numParts * k));
+        bounds[k] = pos == string::npos ? content.size() : pos + 1;
     }
 
-    string line;
-
-    getline(file,line); //header line
-
-    string destCode, origCode;
-    double capacity;
-    int direction;
-
-    while(getline(file, line)){
+    vector<vector<PipeRecord>> parts(numParts);
+    vector<size_t> numLines(numParts, 0);
+    vector<exception_ptr> errors(numParts);
+    auto parsePart = [&](size_t k) {
+        try {
+            size_t pos = bounds[k];
+            while(pos < bounds[k + 1]){
+                size_t end = min(content.find('\n', pos), bounds[k + 1]);
+                numLines[k]++;
+                if(end > pos){
+                    Profiler::count(ProfilerCounter::CSV_LINES_READ);
+                    string line = content.substr(pos, end - pos);
+                    PipeRecord pipe;
+                    pipe.line = numLines[k]; //in the part, the lines before it are added after the join
+
+                    //get origCode
+                    size_t it = line.find_first_of(',');
+                    pipe.origin = line.substr(0,it);
+                    line = line.substr(it + 1);
+
+                    //get destCode
+                    it = line.find_first_of(',');
+                    pipe.destination = line.substr(0,it);
+                    line = line.substr(it + 1);
+
+                    //get capacity
+                    it = line.find_first_of(',');
+                    pipe.capacity = stod(line.substr(0,it));
+                    line = line.substr(it + 1);
+
+                    //get direction
+                    it = line.find_first_of(',');
+                    pipe.direction = stoi(line.substr(0,it));
+
+                    //get cost (optional)
+                    if(it != string::npos && line.find_first_of("0123456789", it) != string::npos) pipe.cost = stod(line.substr(it + 1));
+
+                    parts[k].push_back(std::move(pipe));
+                }
+                pos = end + 1;
+            }
+        } catch(...) {
+            errors[k] = current_exception();
+        }
+    };
+
+    vector<thread> threads;
+    for(size_t k = 1; k < numParts; k++) threads.emplace_back(parsePart, k);
+    parsePart(0);
+    for(thread &t : threads) t.join();
+
+    //deterministic merge: the parts in the order of the file
+    vector<PipeRecord> pipes;
+    size_t numPipes = 0;
+    for(size_t k = 0; k < numParts; k++){
+        if(errors[k]) rethrow_exception(errors[k]);
+        numPipes += parts[k].size();
+    }
+    pipes.reserve(numPipes);
+    size_t linesBefore = 1; //header line
+    for(size_t k = 0; k < numParts; k++){
+        for(PipeRecord &pipe : parts[k]){
+            pipe.line += linesBefore;
+            if(!(pipe.cost >= 0)){
+                if(report != nullptr) report->add(ValidationReport::IssueType::NEGATIVE_COST, VertexType::PIPE, pipe.line, pipe.origin + "->" + pipe.destination);
+                continue;
+            }
+            pipes.push_back(std::move(pipe));
+        }
+        linesBefore += numLines[k];
+    }
+    return pipes;
+}
 
-        //get origCode
-        size_t it = line.find_first_of(',');
-        origCode = line.substr(0,it);
-        line = line.substr(it + 1);
+/**
+ * Adds a city to the hash map and to the ordered list of codes (does nothing if a city with the same code already exists).
+ * Complexity: O(1)
+ * @param city City to add
+ * @return True if the city was added, false if its code already exists
+ */
+bool WaterSupplyManagement::addCity(const City &city) {
+    if(!codeToCity.emplace(city.getCode(), city).second) return false;
+    cityCodes.push_back(city.getCode());
+    return true;
+}
 
-        //get destCode
-        it = line.find_first_of(',');
-        destCode = line.substr(0,it);
-        line = line.substr(it + 1);
+/**
+ * Adds a reservoir to the hash map and to the ordered list of codes (does nothing if a reservoir with the same code already exists).
+ * Complexity: O(1)
+ * @param reservoir Reservoir to add
+ * @return True if the reservoir was added, false if its code already exists
+ */
+bool WaterSupplyManagement::addReservoir(Reservoir reservoir) {
+    if(!codeToReservoir.emplace(reservoir.getCode(), reservoir).second) return false;
+    reservoirCodes.push_back(reservoir.getCode());
+    return true;
+}
 
-        //get capacity
-        it = line.find_first_of(',');
-        capacity = stod(line.substr(0,it));
-        line = line.substr(it + 1);
+/**
+ * Adds a station to the hash map and to the ordered list of codes (does nothing if a station with the same code already exists).
+ * Complexity: O(1)
+ * @param station Station to add
+ * @return True if the station was added, false if its code already exists
+ */
+bool WaterSupplyManagement::addStation(Station station) {
+    if(!codeToStation.emplace(station.getCode(), station).second) return false;
+    stationCodes.push_back(station.getCode());
+    return true;
+}
 
-        //get direction
-        direction = stoi(line);
+/**
+ * Adds a pipe to the network. Both endpoints must already be in the network.
+ * Complexity: O(v) where v is the number of vertexes
+ * @param origCode Code of the origin of the pipe
+ * @param destCode Code of the destination of the pipe
+ * @param capacity Capacity of the pipe
+ * @param direction 1 if the pipe only goes from the origin to the destination, 0 if it goes both ways
+ * (a single bidirectional edge that shares the capacity)
+ * @param cost Cost per unit of water that goes through the pipe (pumping energy, head loss...), can't be negative
+ * @return True if the pipe was added, false if one of the endpoints doesn't exist or the cost is negative
+ */
+bool WaterSupplyManagement::addPipe(const std::string &origCode, const std::string &destCode, double capacity, int direction, double cost) {
+    EditJournal::Edit edit = {EditJournal::EditType::ADD_PIPE, origCode, destCode, VertexType::PIPE, capacity, 0, direction == 0, cost};
+    return applyAndRecord(edit);
+}
 
-        //adds the pipe to the network (and possibly the reverse)
-        network.addEdge(origCode,destCode, capacity);
-        if(direction == 0){
-            network.addEdge(destCode, origCode, capacity);
+/**
+ * Adds parsed pipes to the network (bidirectional if their direction is 0), in order, without recording them in the journal.
+ * Pipes with an endpoint that is not in the network or with a negative cost are skipped. validate reports them (except the pipes
+ * whose endpoints were read but not inserted, when only a selection of the data is loaded) and the pipes that join the same
+ * vertexes in a direction an earlier one already covers (bidirectional pipes cover both).
+ * Complexity: O(n) where n is the number of pipes
+ * @param pipes Pipes to add (see parsePipes)
+ */
+void WaterSupplyManagement::addPipes(const std::vector<PipeRecord> &pipes) {
+    auto isRead = [this](const string &code) {
+        return codeToCity.count(code) != 0 || codeToStation.count(code) != 0 || codeToReservoir.count(code) != 0;
+    };
+    journaling = false;
+    for(const PipeRecord &pipe : pipes){
+        string key = pipe.origin + ',' + pipe.destination;
+        string reverseKey = pipe.destination + ',' + pipe.origin;
+        if(!(pipe.cost >= 0)){
+            loadReport.add(ValidationReport::IssueType::NEGATIVE_COST, VertexType::PIPE, pipe.line, pipe.origin + "->" + pipe.destination);
+        }
+        else if(!addPipe(pipe.origin, pipe.destination, pipe.capacity, pipe.direction, pipe.cost)){
+            if(!isRead(pipe.origin) || !isRead(pipe.destination)){
+                loadReport.add(ValidationReport::IssueType::DANGLING_ENDPOINT, VertexType::PIPE, pipe.line, pipe.origin + "->" + pipe.destination);
+            }
+        }
+        else{
+            bool duplicate = !pipeLines.emplace(key, pipe.line).second;
+            //a bidirectional pipe also goes from the destination to the origin
+            if(pipe.direction == 0 && !pipeLines.emplace(reverseKey, pipe.line).second) duplicate = true;
+            if(duplicate) loadReport.add(ValidationReport::IssueType::DUPLICATE_PIPE, VertexType::PIPE, pipe.line, pipe.origin + "->" + pipe.destination);
         }
     }
+    journaling = true;
+}
+
+/**
+ * Keeps the line where an element was read, or reports it if its code already existed.
+ * Complexity: O(1) on average
+ * @param added True if the element was added
+ * @param file File where the element was read
+ * @param line Line of the element
+ * @param code Code of the element
+ */
+void WaterSupplyManagement::recordLoaded(bool added, VertexType file, std::size_t line, const std::string &code) {
+    if(added) codeLines.emplace(code, line);
+    else loadReport.add(ValidationReport::IssueType::DUPLICATE_CODE, file, line, code);
 }
 
 
@@ -327,15 +665,8 @@ void WaterSupplyManagement::readPipes(DataSetSelection dataset) {
  * @return False if the reservoir already exists. True otherwise.
  */
 bool WaterSupplyManagement::insertReservoir(const string& code) {
-    Vertex<string> *reservoir = network.findVertex(code);
-
-    if(reservoir != nullptr){
-        //reservoir already exists
-        return false;
-    }
-
-    network.addVertex(code, VertexType::RESERVOIR);
-    return true;
+    EditJournal::Edit edit = {EditJournal::EditType::INSERT_VERTEX, code, "", VertexType::RESERVOIR, 0, 0, false, 0};
+    return applyAndRecord(edit);
 }
 
 /**
@@ -345,15 +676,8 @@ bool WaterSupplyManagement::insertReservoir(const string& code) {
  * @return False if the reservoir already exists. True otherwise.
  */
 bool WaterSupplyManagement::insertStation(const std::string& code) {
-    Vertex<string> *station = network.findVertex(code);
-
-    if(station != nullptr){
-        //station already exists
-        return  false;
-    }
-
-    network.addVertex(code, VertexType::STATIONS);
-    return true;
+    EditJournal::Edit edit = {EditJournal::EditType::INSERT_VERTEX, code, "", VertexType::STATIONS, 0, 0, false, 0};
+    return applyAndRecord(edit);
 }
 
 /**
@@ -363,37 +687,32 @@ bool WaterSupplyManagement::insertStation(const std::string& code) {
  * @return False if the city already exists. True otherwise.
  */
 bool WaterSupplyManagement::insertCity(const std::string& code) {
-    Vertex<string> *city = network.findVertex(code);
-
-    if(city != nullptr){
-        //city already exists
-        return false;
-    }
-
-    network.addVertex(code, VertexType::CITIES);
-    return true;
+    EditJournal::Edit edit = {EditJournal::EditType::INSERT_VERTEX, code, "", VertexType::CITIES, 0, 0, false, 0};
+    return applyAndRecord(edit);
 }
 
 /**
- * Inserts all the reservoirs, cities and stations already stored in the hashmaps into the graph
+ * Inserts all the reservoirs, cities and stations already stored in the hashmaps into the graph (not recorded in the journal).
  * Complexity: O(n^2)
  */
 void WaterSupplyManagement::insertAll() {
+    journaling = false;
 
     //insert cities
-    for(pair<string, City> codeCity : codeToCity){
-        insertCity(codeCity.first);
+    for(const string &code : cityCodes){
+        insertCity(code);
     }
 
     //insert stations
-    for(pair<string, Station> codeStation : codeToStation){
-        insertStation(codeStation.first);
+    for(const string &code : stationCodes){
+        insertStation(code);
     }
 
     //insert reservoir
-    for(pair<string, Reservoir> codeReservoir : codeToReservoir){
-        insertReservoir(codeReservoir.first);
+    for(const string &code : reservoirCodes){
+        insertReservoir(code);
     }
+    journaling = true;
 }
 
 //Deletes =============================================================================
@@ -405,17 +724,358 @@ void WaterSupplyManagement::insertAll() {
  * @return  True if the removal was successful, false otherwise
  */
 bool WaterSupplyManagement::deletePipe(const std::string &source, const std::string &dest) {
-    return network.removeEdge(source, dest);
+    //bidirectional pipes are stored only once, possibly in the other direction
+    return removePipe(findPipe(source, dest));
+}
+
+/**
+ * Deletes one pipe of the network (other pipes between the same vertexes are kept).
+ * Complexity: O(e) where e is the number of edges of its endpoints
+ * @param pipe Edge of the pipe
+ * @return True if the removal was successful, false otherwise
+ */
+bool WaterSupplyManagement::removePipe(Edge<std::string> *pipe) {
+    if(pipe == nullptr) return false;
+
+    EditJournal::Edit edit = {EditJournal::EditType::REMOVE_PIPE, pipe->getOrig()->getInfo(), pipe->getDest()->getInfo(), VertexType::PIPE,
+                              pipe->getWeight(), 0, pipe->isBidirectional(), pipe->getCost()};
+    return applyAndRecord(edit);
+}
+
+/**
+ * Changes the capacity of a pipe.
+ * Complexity: O(v + e) where v is the number of vertexes and e is the number of edges of the source.
+ * @param source Source vertex
+ * @param dest Destination vertex
+ * @param capacity New capacity
+ * @return True if the pipe exists, false otherwise
+ */
+bool WaterSupplyManagement::setPipeCapacity(const std::string &source, const std::string &dest, double capacity) {
+    Edge<string> *pipe = findPipe(source, dest);
+    if(pipe == nullptr) return false;
+
+    EditJournal::Edit edit = {EditJournal::EditType::CHANGE_CAPACITY, pipe->getOrig()->getInfo(), pipe->getDest()->getInfo(), VertexType::PIPE,
+                              capacity, pipe->getWeight(), pipe->isBidirectional(), 0};
+    return applyAndRecord(edit);
+}
+
+/**
+ * Changes the most water a station can pump. The solvers respect it (see copyToFlowNetwork), the pipes are not changed.
+ * Complexity: O(1) on average
+ * @param code Code of the station
+ * @param capacity New capacity (infinity for no limit)
+ * @return True if the capacity was changed, false if the station doesn't exist or the capacity is negative (or not a number)
+ */
+bool WaterSupplyManagement::setStationCapacity(const std::string &code, double capacity) {
+    auto search = codeToStation.find(code);
+    if(search == codeToStation.end()) return false;
+    EditJournal::Edit edit = {EditJournal::EditType::CHANGE_STATION_CAPACITY, code, "", VertexType::STATIONS,
+                              capacity, search->second.getCapacity(), false, 0};
+    return applyAndRecord(edit);
+}
+
+/**
+ * Gets the most water a station can pump: its capacity or, for a station with no limit, the most its pipes can carry through it
+ * (the smallest of the capacities of the pipes that reach it and of the pipes that leave it, bidirectional pipes count on both sides).
+ * Complexity: O(d) where d is the degree of the station
+ * @param code Code of the station
+ * @return Capacity of the station (0 if it is not in the network)
+ */
+double WaterSupplyManagement::stationCapacity(const std::string &code) const {
+    auto search = codeToStation.find(code);
+    Vertex<string> *v = network.findVertex(code);
+    if(search == codeToStation.end() || v == nullptr) return 0;
+    if(search->second.hasCapacity()) return search->second.getCapacity();
+
+    double in = 0, out = 0;
+    for(Edge<string> *e : v->getAdj()){
+        out += e->getWeight();
+        if(e->isBidirectional()) in += e->getWeight();
+    }
+    for(Edge<string> *e : v->getIncoming()){
+        in += e->getWeight();
+        if(e->isBidirectional()) out += e->getWeight();
+    }
+    return min(in, out);
+}
+
+/**
+ * Finds the pipe that goes from source to dest (a bidirectional pipe stored from dest to source also counts).
+ * Complexity: O(v + e) where v is the number of vertexes and e is the number of edges of the source.
+ * @param source Source vertex
+ * @param dest Destination vertex
+ * @return The pipe found or nullptr if it doesn't exist
+ */
+Edge<std::string> *WaterSupplyManagement::findPipe(const std::string &source, const std::string &dest) const {
+    Vertex<string> *v = network.findVertex(source);
+    if(v == nullptr) return nullptr;
+    for(Edge<string> *e : v->getAdj()){
+        if(e->getDest()->getInfo() == dest) return e;
+    }
+    for(Edge<string> *e : v->getIncoming()){
+        if(e->isBidirectional() && e->getOrig()->getInfo() == dest) return e;
+    }
+    return nullptr;
 }
 
 //Reset ===============================================================================
 /**
- * Resets the system completely (nodes and edges).
- * Complexity: O(1)
+ * Resets the system completely (nodes, edges and the elements read from the files).
+ * Complexity: O(V + E) where V is the number of vertexes and E is the number of edges
  */
 void WaterSupplyManagement::resetSystem() {
     Graph<string> newSystem;
     network = newSystem;
+    journal.clear();
+    codeToReservoir.clear();
+    codeToStation.clear();
+    codeToCity.clear();
+    reservoirCodes.clear();
+    stationCodes.clear();
+    cityCodes.clear();
+    loadReport.clear();
+    codeLines.clear();
+    pipeLines.clear();
+    topologyChanged();
+}
+
+//Validation ==========================================================================
+/**
+ * Checks the network that was loaded. Reports the problems found while reading the files (files that couldn't be opened,
+ * duplicate codes, duplicate pipes, pipes with a negative cost and pipes with an endpoint that is not in the network) and, in a pass over the network,
+ * pipes with a capacity of zero or less, stations with no pipe leaving them or with a negative capacity and cities that no reservoir can reach.
+ * Each problem has the line where the element was read, if it was read from a file.
+ * Repairing removes the pipes with a capacity of zero or less (they can't carry water) and the limit of the stations with a negative
+ * capacity; the changes can be undone.
+ * Complexity: O(V + E + p) where V is the number of vertexes, E is the number of edges and p is the number of problems
+ * @param repair True to remove the pipes with a capacity of zero or less and the invalid station limits
+ * @return Problems found and statistics of the network
+ */
+ValidationReport WaterSupplyManagement::validate(bool repair) {
+    ValidationReport report = loadReport;
+    ValidationReport::Statistics &stats = report.getStatistics();
+    auto lineOf = [](const unordered_map<string, size_t> &lines, const string &key) {
+        auto search = lines.find(key);
+        return search == lines.end() ? 0 : search->second;
+    };
+
+    //single pass over the vertexes and pipes, the reservoirs start the search of the reachable vertexes
+    const vector<Vertex<string>*> &vertexes = network.getVertexSet();
+    vector<bool> reached(vertexes.size(), false);
+    vector<Vertex<string>*> queue;
+    vector<Edge<string>*> invalidPipes;
+    vector<string> invalidStations;
+    size_t loadIssues = report.getIssues().size();
+    for(Vertex<string> *v : vertexes){
+        VertexType type = v->getType();
+        if(type == VertexType::SUPERSOURCE || type == VertexType::SUPERSINK) continue;
+
+        bool outflow = false;
+        for(Edge<string> *e : v->getAdj()){
+            if(e->getDest()->getType() == VertexType::SUPERSINK) continue;
+            outflow = true;
+            stats.pipes++;
+            if(type == VertexType::RESERVOIR) stats.totalCapacity += e->getWeight();
+            if(e->getWeight() <= 0){
+                string origin = v->getInfo(), destination = e->getDest()->getInfo();
+                report.add(ValidationReport::IssueType::NON_POSITIVE_CAPACITY, VertexType::PIPE, lineOf(pipeLines, origin + ',' + destination),
+                           origin + "->" + destination);
+                invalidPipes.push_back(e);
+            }
+        }
+        for(Edge<string> *e : v->getIncoming()){
+            if(e->isBidirectional()) outflow = true;
+        }
+
+        switch (type) {
+            case VertexType::RESERVOIR:
+                stats.reservoirs++;
+                reached[v->getIndex()] = true;
+                queue.push_back(v);
+                break;
+            case VertexType::STATIONS: {
+                stats.stations++;
+                if(!outflow) report.add(ValidationReport::IssueType::STATION_WITHOUT_OUTFLOW, VertexType::STATIONS, lineOf(codeLines, v->getInfo()), v->getInfo());
+                auto station = codeToStation.find(v->getInfo());
+                if(station != codeToStation.end() && !(station->second.getCapacity() >= 0)){
+                    report.add(ValidationReport::IssueType::INVALID_STATION_CAPACITY, VertexType::STATIONS, lineOf(codeLines, v->getInfo()), v->getInfo());
+                    invalidStations.push_back(v->getInfo());
+                }
+                break;
+            }
+            case VertexType::CITIES:
+                stats.cities++;
+                break;
+            default:
+                break;
+        }
+    }
+
+    //vertexes reachable from a reservoir (pipes with no capacity are followed too, they are reported on their own)
+    for(size_t i = 0; i < queue.size(); i++){
+        Vertex<string> *v = queue[i];
+        auto visit = [&](Vertex<string> *w) {
+            VertexType type = w->getType();
+            if(type == VertexType::SUPERSOURCE || type == VertexType::SUPERSINK || reached[w->getIndex()]) return;
+            reached[w->getIndex()] = true;
+            queue.push_back(w);
+        };
+        for(Edge<string> *e : v->getAdj()) visit(e->getDest());
+        for(Edge<string> *e : v->getIncoming()){
+            if(e->isBidirectional()) visit(e->getOrig());
+        }
+    }
+    for(Vertex<string> *v : vertexes){
+        if(v->getType() != VertexType::CITIES) continue;
+        if(reached[v->getIndex()]) stats.reachableCities++;
+        else report.add(ValidationReport::IssueType::UNREACHABLE_CITY, VertexType::CITIES, lineOf(codeLines, v->getInfo()), v->getInfo());
+    }
+
+    if(repair){
+        for(Edge<string> *pipe : invalidPipes) removePipe(pipe);
+        for(const string &code : invalidStations) setStationCapacity(code, numeric_limits<double>::infinity());
+        //only the problems found in the network (an invalid capacity in the file was already ignored)
+        for(size_t i = loadIssues; i < report.getIssues().size(); i++){
+            ValidationReport::Issue &issue = report.getIssues()[i];
+            if(issue.type == ValidationReport::IssueType::NON_POSITIVE_CAPACITY || issue.type == ValidationReport::IssueType::INVALID_STATION_CAPACITY){
+                issue.repaired = true;
+            }
+        }
+    }
+    return report;
+}
+
+//Edit journal ========================================================================
+/**
+ * Undoes the last edit made to the network. If it can't be reverted, the journal stays where it was, matching the network.
+ * Complexity: O(1) for capacity changes, see applyEdit for the others
+ * @return True if an edit was undone, false if there was none (or it couldn't be reverted)
+ */
+bool WaterSupplyManagement::undo() {
+    const EditJournal::Edit *edit = journal.undo();
+    if(edit == nullptr) return false;
+    if(applyEdit(EditJournal::inverse(*edit))) return true;
+    journal.redo();
+    return false;
+}
+
+/**
+ * Makes again the last edit undone. If it can't be applied, the journal stays where it was, matching the network.
+ * Complexity: O(1) for capacity changes, see applyEdit for the others
+ * @return True if an edit was redone, false if there was none (or it couldn't be applied)
+ */
+bool WaterSupplyManagement::redo() {
+    const EditJournal::Edit *edit = journal.redo();
+    if(edit == nullptr) return false;
+    if(applyEdit(*edit)) return true;
+    journal.undo();
+    return false;
+}
+
+/**
+ * Undoes every edit made after a checkpoint, stopping at the first edit that can't be reverted.
+ * Complexity: O(n) undos where n is the number of edits after the checkpoint
+ * @param checkpoint Checkpoint (see EditJournal::checkpoint)
+ * @return True if the network is back at the checkpoint, false otherwise
+ */
+bool WaterSupplyManagement::rollback(std::size_t checkpoint) {
+    while(journal.checkpoint() > checkpoint){
+        if(!undo()) return false;
+    }
+    return true;
+}
+
+/**
+ * Forgets the edits made so far: they can't be undone anymore (e.g. the data selected by the user when it is loaded).
+ * Complexity: O(n) where n is the number of edits
+ */
+void WaterSupplyManagement::clearJournal() {
+    journal.clear();
+}
+
+/**
+ * Gets the journal with the edits made to the network.
+ * Complexity: O(1)
+ * @return Edit journal
+ */
+const EditJournal &WaterSupplyManagement::getJournal() const {
+    return journal;
+}
+
+/**
+ * Applies an edit and records it in the journal (only if it was applied and the data isn't being loaded).
+ * Complexity: see applyEdit
+ * @param edit Edit
+ * @return True if the edit was applied, false otherwise
+ */
+bool WaterSupplyManagement::applyAndRecord(const EditJournal::Edit &edit) {
+    if(!applyEdit(edit)) return false;
+    if(journaling) journal.record(edit);
+    return true;
+}
+
+/**
+ * Applies an edit to the network, invalidating only what it changes: a capacity doesn't change the reachability index nor the
+ * dominator tree (the solve cache and the snapshots don't need to be invalidated, the cache is keyed by the contents of the network).
+ * A vertex inserted while the super source or super sink exists is connected to it.
+ * Complexity: O(1) for capacity changes, O(v) to insert a vertex or add a pipe, O(e^2) to remove a pipe and O(v^2) to remove a vertex,
+ * where v is the number of vertexes and e is the number of edges of a vertex
+ * @param edit Edit
+ * @return True if the edit was applied, false otherwise
+ */
+bool WaterSupplyManagement::applyEdit(const EditJournal::Edit &edit) {
+    switch (edit.type) {
+        case EditJournal::EditType::INSERT_VERTEX: {
+            if(!network.addVertex(edit.origin, edit.vertexType)) return false;
+            auto reservoir = codeToReservoir.find(edit.origin);
+            if(edit.vertexType == VertexType::RESERVOIR && reservoir != codeToReservoir.end()){
+                network.addEdge("super_source", edit.origin, reservoir->second.getReservoirMaxDelivery());
+            }
+            auto city = codeToCity.find(edit.origin);
+            if(edit.vertexType == VertexType::CITIES && city != codeToCity.end()){
+                network.addEdge(edit.origin, "super_sink", city->second.getDemand());
+            }
+            break;
+        }
+        case EditJournal::EditType::REMOVE_VERTEX:
+            if(!network.removeVertex(edit.origin)) return false;
+            break;
+        case EditJournal::EditType::ADD_PIPE: {
+            if(!(edit.cost >= 0)) return false;
+            bool added = edit.bidirectional ? network.addUndirectedEdge(edit.origin, edit.destination, edit.capacity)
+                                            : network.addEdge(edit.origin, edit.destination, edit.capacity);
+            if(!added) return false;
+            //the new edge is the last one leaving the origin
+            network.findVertex(edit.origin)->getAdj().back()->setCost(edit.cost);
+            break;
+        }
+        case EditJournal::EditType::REMOVE_PIPE: {
+            //only the pipe of the edit, other pipes between the same vertexes are kept
+            Vertex<string> *v = network.findVertex(edit.origin);
+            if(v == nullptr) return false;
+            Edge<string> *pipe = nullptr;
+            for(Edge<string> *e : v->getAdj()){
+                if(e->getDest()->getInfo() == edit.destination && e->getWeight() == edit.capacity
+                   && e->isBidirectional() == edit.bidirectional && e->getCost() == edit.cost) pipe = e;
+            }
+            if(!network.removeEdge(pipe)) return false;
+            break;
+        }
+        case EditJournal::EditType::CHANGE_CAPACITY: {
+            Edge<string> *pipe = findPipe(edit.origin, edit.destination);
+            if(pipe == nullptr) return false;
+            pipe->setWeight(edit.capacity);
+            return true;
+        }
+        case EditJournal::EditType::CHANGE_STATION_CAPACITY: {
+            auto station = codeToStation.find(edit.origin);
+            if(station == codeToStation.end() || !(edit.capacity >= 0)) return false;
+            station->second.setCapacity(edit.capacity);
+            return true;
+        }
+    }
+    topologyChanged();
+    return true;
 }
 
 //super nodes ========================================================
@@ -427,7 +1087,8 @@ void WaterSupplyManagement::resetSystem() {
 void WaterSupplyManagement::createSuperSource() {
     if(network.addVertex("super_source", VertexType::SUPERSOURCE)) {
 
-        for (pair<string, Reservoir> codeReservoir: codeToReservoir) {
+        for (const string &code : reservoirCodes) {
+            pair<const string, Reservoir> &codeReservoir = *codeToReservoir.find(code);
             network.addEdge("super_source", codeReservoir.first, codeReservoir.second.getReservoirMaxDelivery());
         }
     }
@@ -440,7 +1101,8 @@ void WaterSupplyManagement::createSuperSource() {
 void WaterSupplyManagement::createSuperSink() {
     if(network.addVertex("super_sink", VertexType::SUPERSINK)) {
 
-        for (pair<string, City> codeCity: codeToCity) {
+        for (const string &code : cityCodes) {
+            const pair<const string, City> &codeCity = *codeToCity.find(code);
             network.addEdge(codeCity.first, "super_sink", codeCity.second.getDemand());
         }
     }
@@ -467,16 +1129,18 @@ void WaterSupplyManagement::removeSuperSink() {
 /** Function to test the given vertex 'w' and visit it if conditions are met.
  *  Complexity: O(1)
  * @param q queue used in the BFS to find the augmenting path
+ * @param ws traversal state of the search (visited vertexes and paths)
  * @param e edge used to set the path
  * @param w vertex we are testing
  * @param residual  Residual capacity of the edge.
+ * @param delta Minimum residual capacity accepted (0 accepts any positive residual)
  */
-void testAndVisit(std::queue< Vertex<string>*> &q, Edge<string> *e, Vertex<string> *w, double residual) {
-    // Check if the vertex 'w' is not visited and there is residual capacity
-    if (! w->isVisited() && residual > 0) {
+void testAndVisit(std::queue< Vertex<string>*> &q, TraversalWorkspace<string> &ws, Edge<string> *e, Vertex<string> *w, double residual, double delta) {
+    // Check if the vertex 'w' is not visited and there is enough residual capacity
+    if (! ws.isVisited(w) && residual > 0 && residual >= delta) {
     // Mark 'w' as visited, set the path through which it was reached, and enqueue it
-        w->setVisited(true);
-        w->setPath(e);
+        ws.setVisited(w, true);
+        ws.setPath(w, e);
         q.push(w);
     }
 }
@@ -486,32 +1150,38 @@ void testAndVisit(std::queue< Vertex<string>*> &q, Edge<string> *e, Vertex<strin
  * @param g Graph where we are finding the augmenting path
  * @param s Source of the search.
  * @param t Target of the search.
+ * @param ws Traversal state of the search (the paths found are stored here)
+ * @param delta Only edges with a residual capacity of at least delta are used (0 uses every edge with residual capacity)
  * @return  True if a path was found and false otherwise.
  */
-bool findAugmentingPath(Graph<string> *g, Vertex<string> *s, Vertex<string> *t) {
+bool findAugmentingPath(Graph<string> *g, Vertex<string> *s, Vertex<string> *t, TraversalWorkspace<string> &ws, double delta = 0) {
+    Profiler::count(ProfilerCounter::BFS_SEARCHES);
     // Mark all vertices as not visited
-    for(auto v : g->getVertexSet()) {
-        v->setVisited(false);
-    }
+    ws.reset(g->getNumVertex());
     // Mark the source vertex as visited and enqueue it
-    s->setVisited(true);
+    ws.setVisited(s, true);
     std::queue<Vertex<string> *> q;
     q.push(s);
     // BFS to find an augmenting path
-    while( ! q.empty() && ! t->isVisited()) {
+    while( ! q.empty() && ! ws.isVisited(t)) {
         auto v = q.front();
         q.pop();
+        Profiler::count(ProfilerCounter::BFS_VERTICES_VISITED);
+        uint64_t scanned = 0;
     // Process outgoing edges
         for(auto e: v->getAdj()) {
-            testAndVisit(q, e, e->getDest(), e->getWeight() - e->getFlow());
+            testAndVisit(q, ws, e, e->getDest(), e->getResidual(v), delta);
+            scanned++;
         }
-    // Process incoming edges
+    // Process incoming edges (cancel flow or, if bidirectional, send flow back)
         for(auto e: v->getIncoming()) {
-            testAndVisit(q, e, e->getOrig(), e->getFlow());
+            testAndVisit(q, ws, e, e->getOrig(), e->getResidual(v), delta);
+            scanned++;
         }
+        Profiler::count(ProfilerCounter::EDGES_SCANNED, scanned);
     }
     // Return true if a path to the target is found, false otherwise
-    return t->isVisited();
+    return ws.isVisited(t);
 }
 
 
@@ -520,21 +1190,17 @@ bool findAugmentingPath(Graph<string> *g, Vertex<string> *s, Vertex<string> *t)
  *  Complexity: O(n) were n is the number of edges of the path.
  * @param s Source of the path
  * @param t Target of the path
+ * @param ws Traversal state with the path
  * @return  The minimal residual capacity along the path
  */
-double findMinResidualAlongPath(Vertex<string> *s, Vertex<string> *t) {
+double findMinResidualAlongPath(Vertex<string> *s, Vertex<string> *t, const TraversalWorkspace<string> &ws) {
     double f = LONG_LONG_MAX;
     // Traverse the augmenting path to find the minimum residual capacity
     for (auto v = t; v != s; ) {
-        auto e = v->getPath();
-        if (e->getDest() == v) {
-            f = std::min(f, e->getWeight() - e->getFlow());
-            v = e->getOrig();
-        }
-        else {
-            f = std::min(f, e->getFlow());
-            v = e->getDest();
-        }
+        auto e = ws.getPath(v);
+        auto u = e->getOther(v);
+        f = std::min(f, e->getResidual(u));
+        v = u;
     }
     // Return the minimum residual capacity
     return f;
@@ -544,21 +1210,16 @@ double findMinResidualAlongPath(Vertex<string> *s, Vertex<string> *t) {
  *  Complexity: O(n) where n is the number of edges of the path
  * @param s source of the path
  * @param t target of the path
+ * @param ws Traversal state with the path
  * @param f Value of the flow we are augmenting
  */
-void augmentFlowAlongPath(Vertex<string> *s, Vertex<string> *t, double f) {
+void augmentFlowAlongPath(Vertex<string> *s, Vertex<string> *t, const TraversalWorkspace<string> &ws, double f) {
 // Traverse the augmenting path and update the flow values accordingly
     for (auto v = t; v != s; ) {
-        auto e = v->getPath();
-        double flow = e->getFlow();
-        if (e->getDest() == v) {
-            e->setFlow(flow + f);
-            v = e->getOrig();
-        }
-        else {
-            e->setFlow(flow - f);
-            v = e->getDest();
-        }
+        auto e = ws.getPath(v);
+        auto u = e->getOther(v);
+        e->addFlowFrom(u, f);
+        v = u;
     }
 }
 
@@ -569,12 +1230,18 @@ void augmentFlowAlongPath(Vertex<string> *s, Vertex<string> *t, double f) {
  * @param target Finishing point of the algorithm(super sink)
  */
 void WaterSupplyManagement::edmondsKarp(const string& source, const string& target) {
+    Profiler::ScopedTimer timer("edmondsKarp", "solving");
     // Find source and target vertices in the graph
     Vertex<string>* s = network.findVertex(source);
     Vertex<string>* t = network.findVertex(target);
     // Validate source and target vertices
     if (s == nullptr || t == nullptr || s == t)
         throw std::logic_error("Invalid source and/or target vertex");
+    // The capacities of the stations are not in the graph, the flow is found in a copy with the stations split
+    if (s->getType() == VertexType::SUPERSOURCE && t->getType() == VertexType::SUPERSINK && hasStationLimits()) {
+        stationLimitedMaxFlow();
+        return;
+    }
     // Initialize flow on all edges to 0
     for (auto v : network.getVertexSet()) {
         for (auto e: v->getAdj()) {
@@ -582,20 +1249,69 @@ void WaterSupplyManagement::edmondsKarp(const string& source, const string& targ
         }
     }
     // While there is an augmenting path, augment the flow along the path
-    while( findAugmentingPath(&network, s, t) ) {
-        double f = findMinResidualAlongPath(s, t);
-        augmentFlowAlongPath(s, t, f);
+    TraversalWorkspace<string> ws(network.getNumVertex());
+    while( findAugmentingPath(&network, s, t, ws) ) {
+        double f = findMinResidualAlongPath(s, t, ws);
+        augmentFlowAlongPath(s, t, ws, f);
+        Profiler::count(ProfilerCounter::AUGMENTING_PATHS);
     }
 }
 
-//Basic Metrics =====================================================================================
 /**
- * Calculates the flow deficit in a given city.
- * Complexity: O(v) where v is the number of vertexes
- * @param cityCode City we want to analise the flow deficit
- * @return The deficit value
+ * Executes the Edmonds Karp algorithm with capacity scaling. Each phase only augments along paths with a residual
+ * capacity of at least delta, and delta is halved between phases (starting at the largest power of two not bigger than the largest capacity).
+ * A last phase accepts any residual capacity, so non integer capacities also reach the maximum flow.
+ * Finds far less (and bigger) augmenting paths than edmondsKarp when capacities span several orders of magnitude.
+ * Complexity: O(E^2 log C) where E is the number of edges and C is the largest capacity (O(V E^2) for the last phase in the worst case)
+ * @param source Starting point of the algorithm(super source)
+ * @param target Finishing point of the algorithm(super sink)
  */
-double WaterSupplyManagement::flowDeficit(const std::string& cityCode) {
+void WaterSupplyManagement::edmondsKarpScaling(const string& source, const string& target) {
+    Profiler::ScopedTimer timer("edmondsKarpScaling", "solving");
+    // Find source and target vertices in the graph
+    Vertex<string>* s = network.findVertex(source);
+    Vertex<string>* t = network.findVertex(target);
+    // Validate source and target vertices
+    if (s == nullptr || t == nullptr || s == t)
+        throw std::logic_error("Invalid source and/or target vertex");
+    // The capacities of the stations are not in the graph, the flow is found in a copy with the stations split
+    if (s->getType() == VertexType::SUPERSOURCE && t->getType() == VertexType::SUPERSINK && hasStationLimits()) {
+        stationLimitedMaxFlow();
+        return;
+    }
+    // Initialize flow on all edges to 0 and find the largest capacity
+    double maxCapacity = 0;
+    for (auto v : network.getVertexSet()) {
+        for (auto e: v->getAdj()) {
+            e->setFlow(0);
+            maxCapacity = std::max(maxCapacity, e->getWeight());
+        }
+    }
+    double delta = 1;
+    while (delta * 2 <= maxCapacity) {
+        delta *= 2;
+    }
+    // Augment along paths with residual >= delta, halving delta each phase (delta = 0 is the last phase)
+    TraversalWorkspace<string> ws(network.getNumVertex());
+    while (true) {
+        while( findAugmentingPath(&network, s, t, ws, delta) ) {
+            double f = findMinResidualAlongPath(s, t, ws);
+            augmentFlowAlongPath(s, t, ws, f);
+            Profiler::count(ProfilerCounter::AUGMENTING_PATHS);
+        }
+        if (delta == 0) break;
+        delta = delta > 1 ? delta / 2 : 0;
+    }
+}
+
+//Basic Metrics =====================================================================================
+/**
+ * Calculates the flow deficit in a given city.
+ * Complexity: O(v) where v is the number of vertexes
+ * @param cityCode City we want to analise the flow deficit
+ * @return The deficit value
+ */
+double WaterSupplyManagement::flowDeficit(const std::string& cityCode) {
     Vertex<string> *cityVertex = network.findVertex(cityCode);
 
     if(cityVertex == nullptr) {
@@ -607,142 +1323,1208 @@ double WaterSupplyManagement::flowDeficit(const std::string& cityCode) {
     for(auto inc: cityVertex->getIncoming()){
         deficit -= inc->getFlow();
     }
+    //flow sent away through bidirectional pipes
+    for(auto out: cityVertex->getAdj()){
+        if(out->isBidirectional()) deficit += out->getFlow();
+    }
 
     return deficit;
 }
 
 /**
- * Stores the Water supply metrics for every city in the graph to a file.
- * Complexity: O(n) where n is the number os cities.
+ * Stores the water supply metrics of the network (cities, pipes and reservoirs tables) to a file.
+ * The cities table keeps the columns of the original metrics.csv. With the CSV format the pipes and reservoirs
+ * tables are stored in sibling files (metrics_pipes.csv and metrics_reservoirs.csv).
+ * Complexity: O(V + E) where V is the number of vertexes and E is the number of edges.
+ * @param filepath Path of the output file
+ * @param format Format of the output (CSV, JSON or binary columnar)
+ * @return True if the metrics were stored, false if a file couldn't be opened or written
  */
-void WaterSupplyManagement::storeMetricsToFile() {
-    ofstream fout;
+bool WaterSupplyManagement::storeMetricsToFile(const std::string &filepath, MetricsFormat format) {
+    MetricsExporter exporter(filepath, format);
+    if(!exporter.isOpen()) return false;
 
-    fout.open("../Source_Code/metrics.csv");
+    typedef MetricsExporter::ColumnType Col;
 
-    fout << "Code, Received water, Name, Id, Population, Demand\n";
+    //cities table (received water is what is missing from the deficit, it doesn't need the super sink)
+    exporter.beginTable("cities", {"Code", "Received water", "Name", "Id", "Population", "Demand"},
+                        {Col::TEXT, Col::NUMBER, Col::TEXT, Col::NUMBER, Col::NUMBER, Col::NUMBER});
+    for(Vertex<string> *v : network.getVertexSet()){
+        if(v->getType() != VertexType::CITIES) continue;
+        auto search = codeToCity.find(v->getInfo());
+        if(search == codeToCity.end()) continue;
+
+        double received = search->second.getDemand() - flowDeficit(search->first);
+
+        exporter.addText(search->first);
+        exporter.addNumber(received);
+        exporter.addText(search->second.getName());
+        exporter.addNumber(search->second.getId());
+        exporter.addNumber(search->second.getPopulation());
+        exporter.addNumber(search->second.getDemand());
+        exporter.endRow();
+    }
 
-    if(fout){
-        for(pair<string, City> codeCity : codeToCity){
-            Vertex<string> *v = network.findVertex(codeCity.first);
-            if(v == nullptr) continue;
+    //pipes table (super source and super sink edges are not pipes)
+    exporter.beginTable("pipes", {"Origin", "Destination", "Capacity", "Flow", "Direction"},
+                        {Col::TEXT, Col::TEXT, Col::NUMBER, Col::NUMBER, Col::NUMBER});
+    for(Vertex<string> *v : network.getVertexSet()){
+        if(v->getType() == VertexType::SUPERSOURCE) continue;
+        for(Edge<string> *e : v->getAdj()){
+            if(e->getDest()->getType() == VertexType::SUPERSINK) continue;
+            exporter.addText(v->getInfo());
+            exporter.addText(e->getDest()->getInfo());
+            exporter.addNumber(e->getWeight());
+            exporter.addNumber(e->getFlow());
+            exporter.addNumber(e->isBidirectional() ? 0 : 1);
+            exporter.endRow();
+        }
+    }
+
+    //reservoirs table
+    exporter.beginTable("reservoirs", {"Code", "Delivered water", "Name", "Municipality", "Id", "Maximum delivery"},
+                        {Col::TEXT, Col::NUMBER, Col::TEXT, Col::TEXT, Col::NUMBER, Col::NUMBER});
+    for(Vertex<string> *v : network.getVertexSet()){
+        if(v->getType() != VertexType::RESERVOIR) continue;
+        auto search = codeToReservoir.find(v->getInfo());
+        if(search == codeToReservoir.end()) continue;
+
+        double delivered = 0;
+        for(Edge<string> *e : v->getAdj()){
+            delivered += e->getFlow();
+        }
+        //bidirectional pipes stored towards the reservoir deliver their negative flow
+        for(Edge<string> *e : v->getIncoming()){
+            if(e->isBidirectional()) delivered -= e->getFlow();
+        }
+
+        exporter.addText(search->first);
+        exporter.addNumber(delivered);
+        exporter.addText(search->second.getReservoirName());
+        exporter.addText(search->second.getReservoirMunicipality());
+        exporter.addNumber(search->second.getReservoirId());
+        exporter.addNumber(search->second.getReservoirMaxDelivery());
+        exporter.endRow();
+    }
+
+    return exporter.close();
+}
+
+/**
+ * Calculates, for every city, the maximum water it could receive if it was the only city of the network (the other cities only let water pass).
+ * The pipes are copied once to a compact FlowNetwork. A single solve with every city as a sink gives a lower bound for each city
+ * (the water it gets when sharing), and the capacity of its pipes and of the reservoirs that can reach it give an upper bound:
+ * cities whose bounds meet don't need their own solve. The other cities are solved in parallel, each thread reusing its buffers.
+ * Complexity: O(c V E^2 / t) where c is the number of cities that need their own solve, V is the number of vertexes, E is the number of edges and t is the number of threads
+ * @param numThreads Number of threads used (0 uses the number of hardware threads)
+ * @return Code of each city and the maximum water it could receive, sorted by code
+ */
+std::vector<std::pair<std::string, double>> WaterSupplyManagement::isolatedCityCapacities(unsigned int numThreads) {
+    Profiler::ScopedTimer timer("isolatedCityCapacities", "solving");
+
+    FlowCopy copy;
+    copyToFlowNetwork(copy, numeric_limits<double>::infinity());
+    const FlowNetwork &flowNetwork = copy.flowNetwork;
+    const vector<pair<string, uint32_t>> &cities = copy.cities;
+
+    //bounds of each city
+    FlowNetwork::Workspace joint;
+    flowNetwork.maxFlow(copy.source, copy.sink, joint);
+    const ReachabilityIndex &index = getReachability();
+
+    vector<pair<string, double>> res(cities.size());
+    vector<size_t> pending;
+    for(size_t i = 0; i < cities.size(); i++){
+        const string &code = cities[i].first;
+        double lower = flowNetwork.arcFlow(cities[i].second, joint);
+
+        //the pipe to the sink doesn't bring water to the city
+        double upper = flowNetwork.inflowCapacity(copy.node[network.findVertex(code)->getIndex()]);
+        double supply = 0;
+        for(const string &reservoir : index.suppliers(code)){
+            auto search = codeToReservoir.find(reservoir);
+            if(search != codeToReservoir.end()) supply += search->second.getReservoirMaxDelivery();
+        }
+        upper = min(upper, supply);
+
+        res[i] = make_pair(code, lower);
+        if(lower < upper) pending.push_back(i);
+    }
+
+    //every thread takes the next city still to solve
+    if(numThreads == 0) numThreads = max(1u, thread::hardware_concurrency());
+    numThreads = max(1u, min<unsigned int>(numThreads, pending.size()));
+    atomic<size_t> next(0);
+    auto worker = [&]() {
+        FlowNetwork::Workspace ws;
+        for(size_t p = next++; p < pending.size(); p = next++){
+            size_t i = pending[p];
+            res[i].second = flowNetwork.maxFlow(copy.source, copy.node[network.findVertex(cities[i].first)->getIndex()], ws);
+        }
+    };
+    vector<thread> threads;
+    for(unsigned int t = 1; t < numThreads; t++) threads.emplace_back(worker);
+    worker();
+    for(thread &t : threads) t.join();
+
+    return res;
+}
+
+/**
+ * Distributes the water so the shortage is shared fairly: every city receives the same fraction of its demand, as big as possible,
+ * and when some cities can't get more (they are behind a bottleneck) the others keep growing (max-min fair in the fraction of the demand).
+ * The result doesn't depend on the order of the vertexes or of the pipes and its total is still the maximum flow. The flows are stored
+ * in the network (super source and super sink edges included, if they exist).
+ * Each level is found with parametric max flows: the fraction starts at 1 and the min cut of each failed solve gives the next
+ * fraction (Newton's method), which converges in a few solves. The cities behind the cut of the last level are frozen.
+ * Complexity: O(k V E^2) where k is the number of solves (a small multiple of the number of levels), V is the number of vertexes and E is the number of edges
+ * @return Code of each city and the water it receives, sorted by code
+ */
+std::vector<std::pair<std::string, double>> WaterSupplyManagement::fairAllocation() {
+    Profiler::ScopedTimer timer("fairAllocation", "solving");
+    const double EPS = 1e-6;
+
+    FlowCopy copy;
+    copyToFlowNetwork(copy, 0);
+    FlowNetwork &flowNetwork = copy.flowNetwork;
+    const vector<pair<string, uint32_t>> &cities = copy.cities;
+
+    vector<double> demand(cities.size(), 0);
+    vector<double> allocation(cities.size(), 0);
+    vector<bool> active(cities.size(), false);
+    size_t numActive = 0;
+    for(size_t i = 0; i < cities.size(); i++){
+        auto search = codeToCity.find(cities[i].first);
+        if(search != codeToCity.end()) demand[i] = search->second.getDemand();
+        active[i] = demand[i] > 0;
+        if(active[i]) numActive++;
+    }
+
+    FlowNetwork::Workspace ws;
+    vector<bool> sourceSide;
+    while(numActive > 0){
+        //largest fraction the active cities can get on top of the frozen ones
+        double fraction = 1;
+        while(true){
+            double required = 0, frozen = 0, activeDemand = 0;
+            for(size_t i = 0; i < cities.size(); i++){
+                double capacity = active[i] ? fraction * demand[i] : allocation[i];
+                flowNetwork.setCapacity(cities[i].second, capacity);
+                required += capacity;
+                if(active[i]) activeDemand += demand[i];
+                else frozen += allocation[i];
+            }
+            double flow = flowNetwork.maxFlow(copy.source, copy.sink, ws);
+            if(flow >= required - EPS) break;
+
+            //cut = fixed + frozen cities on the source side + fraction * (active demand on the source side), next fraction makes it enough
+            flowNetwork.residualReachable(copy.source, ws, EPS, sourceSide);
+            double sourceSideDemand = 0;
+            for(size_t i = 0; i < cities.size(); i++){
+                if(active[i] && sourceSide[copy.node[network.findVertex(cities[i].first)->getIndex()]]) sourceSideDemand += demand[i];
+            }
+            if(activeDemand - sourceSideDemand <= EPS) break;
+            double next = max(0.0, (flow - fraction * sourceSideDemand - frozen) / (activeDemand - sourceSideDemand));
+            if(next >= fraction) break;
+            fraction = next;
+        }
+
+        //the cities that can't receive more are frozen at this fraction
+        flowNetwork.residualReachable(copy.source, ws, EPS, sourceSide);
+        size_t numFrozen = 0;
+        for(size_t i = 0; i < cities.size(); i++){
+            if(!active[i]) continue;
+            if(fraction >= 1 - EPS || !sourceSide[copy.node[network.findVertex(cities[i].first)->getIndex()]]){
+                allocation[i] = fraction * demand[i];
+                active[i] = false;
+                numFrozen++;
+            }
+        }
+        if(numFrozen == 0){
+            //rounding errors, nothing can grow anyway
+            for(size_t i = 0; i < cities.size(); i++){
+                if(active[i]) allocation[i] = fraction * demand[i];
+                active[i] = false;
+            }
+            numFrozen = numActive;
+        }
+        numActive -= numFrozen;
+    }
+
+    //final solve with every city at its allocation
+    for(size_t i = 0; i < cities.size(); i++) flowNetwork.setCapacity(cities[i].second, allocation[i]);
+    flowNetwork.maxFlow(copy.source, copy.sink, ws);
+    applyFlows(copy, ws);
+
+    vector<pair<string, double>> res;
+    for(const auto &city : cities) res.emplace_back(city.first, flowNetwork.arcFlow(city.second, ws));
+    return res;
+}
+
+/**
+ * Distributes the water preferring the cities with the highest priority (explicit priority column or population): the total is still
+ * the maximum flow, but when there is a shortage it goes to the cities with the lowest priority first.
+ * Solved as a min-cost max flow on the compact copy of the network, where each unit of water received by a city costs minus its priority.
+ * The flows are stored in the network (super source and super sink edges included, if they exist).
+ * Complexity: O(F E log V) where F is the number of augmenting paths, V is the number of vertexes and E is the number of edges
+ * @return Code of each city and the water it receives, sorted by code
+ */
+std::vector<std::pair<std::string, double>> WaterSupplyManagement::priorityAllocation() {
+    Profiler::ScopedTimer timer("priorityAllocation", "solving");
+
+    FlowCopy copy;
+    copyToFlowNetwork(copy, 0);
+    for(const auto &city : copy.cities){
+        auto search = codeToCity.find(city.first);
+        if(search == codeToCity.end()) continue;
+        copy.flowNetwork.setCapacity(city.second, search->second.getDemand());
+        copy.flowNetwork.setCost(city.second, -search->second.getPriority());
+    }
+
+    FlowNetwork::Workspace ws;
+    double cost;
+    copy.flowNetwork.minCostMaxFlow(copy.source, copy.sink, ws, cost);
+    applyFlows(copy, ws);
+
+    vector<pair<string, double>> res;
+    for(const auto &city : copy.cities) res.emplace_back(city.first, copy.flowNetwork.arcFlow(city.second, ws));
+    return res;
+}
+
+/**
+ * Distributes the maximum flow with the smallest operating cost (sum of the water that goes through each pipe times its cost).
+ * Solved as a min-cost max flow on the compact copy of the network (successive shortest paths with potentials).
+ * The flows are stored in the network (super source and super sink edges included, if they exist).
+ * Complexity: O(F E log V) where F is the number of augmenting paths, V is the number of vertexes and E is the number of edges
+ * @return Operating cost of the flow
+ */
+double WaterSupplyManagement::minCostAllocation() {
+    Profiler::ScopedTimer timer("minCostAllocation", "solving");
+
+    FlowCopy copy;
+    copyToFlowNetwork(copy, 0, true);
+    for(const auto &city : copy.cities){
+        auto search = codeToCity.find(city.first);
+        if(search != codeToCity.end()) copy.flowNetwork.setCapacity(city.second, search->second.getDemand());
+    }
+
+    FlowNetwork::Workspace ws;
+    double cost;
+    copy.flowNetwork.minCostMaxFlow(copy.source, copy.sink, ws, cost);
+    applyFlows(copy, ws);
+    return cost;
+}
+
+/**
+ * Calculates the operating cost of the current flow (sum of the water that goes through each pipe times its cost).
+ * Complexity: O(V + E) where V is the number of vertexes and E is the number of edges
+ * @return Operating cost
+ */
+double WaterSupplyManagement::operatingCost() const {
+    double cost = 0;
+    for(Vertex<string> *v : network.getVertexSet()){
+        for(Edge<string> *e : v->getAdj()){
+            cost += std::abs(e->getFlow()) * e->getCost();
+        }
+    }
+    return cost;
+}
+
+/**
+ * Calculates the pumping load of each station with the current flow: the water it sends and the cost of sending it through its pipes
+ * (for a bidirectional pipe, the station the water leaves from).
+ * Complexity: O(V + E) where V is the number of vertexes and E is the number of edges
+ * @return Load of each station, in file order
+ */
+std::vector<WaterSupplyManagement::StationLoad> WaterSupplyManagement::stationPumpingLoad() const {
+    vector<StationLoad> res;
+    for(const string &code : stationCodes){
+        Vertex<string> *v = network.findVertex(code);
+        if(v == nullptr) continue;
+
+        StationLoad load = {code, 0, 0};
+        for(Edge<string> *e : v->getAdj()){
+            if(e->getFlow() <= 0) continue;
+            load.pumped += e->getFlow();
+            load.cost += e->getFlow() * e->getCost();
+        }
+        //bidirectional pipes used from their destination
+        for(Edge<string> *e : v->getIncoming()){
+            if(!e->isBidirectional() || e->getFlow() >= 0) continue;
+            load.pumped -= e->getFlow();
+            load.cost -= e->getFlow() * e->getCost();
+        }
+        res.push_back(load);
+    }
+    return res;
+}
+
+/**
+ * Distributes the water of the network (super source and super sink must exist) in the given mode.
+ * Complexity: see edmondsKarp, fairAllocation, priorityAllocation and minCostAllocation
+ * @param mode How the water is distributed when it is not enough for every city
+ */
+void WaterSupplyManagement::distributeWater(DistributionMode mode) {
+    //the same network was already solved in this mode
+    static const char *const modeNames[] = {"max_flow", "fair_share", "priority", "min_cost"};
+    uint64_t key = fingerprint(modeNames[static_cast<int>(mode)]);
+    vector<double> flows;
+    if(solveCache.find(key, flows) && setEdgeFlows(flows)) return;
+
+    switch (mode) {
+        case DistributionMode::MAX_FLOW:
+            edmondsKarp("super_source", "super_sink");
+            break;
+        case DistributionMode::FAIR_SHARE:
+            fairAllocation();
+            break;
+        case DistributionMode::PRIORITY:
+            priorityAllocation();
+            break;
+        case DistributionMode::MIN_COST:
+            minCostAllocation();
+            break;
+    }
+    solveCache.store(key, edgeFlows());
+}
+
+//Solve cache ===========================================================================================
+/**
+ * Calculates a fingerprint of the network (vertexes, pipes with their capacities, directions and costs, reservoirs' deliveries,
+ * cities' demands and priorities and stations' capacities) and of a question asked about it. Networks that can't be told apart by the solvers
+ * (same vertexes and pipes in the same order) have the same fingerprint, so it is used as the key of the solve cache.
+ * Complexity: O(V + E) where V is the number of vertexes and E is the number of edges
+ * @param scenario Question asked (solver used, element taken out of service...)
+ * @return Fingerprint
+ */
+uint64_t WaterSupplyManagement::fingerprint(const std::string &scenario) const {
+    uint64_t h = SolveCache::FNV_OFFSET;
+    for(Vertex<string> *v : network.getVertexSet()){
+        uint8_t type = static_cast<uint8_t>(v->getType());
+        h = SolveCache::hash(h, v->getInfo());
+        h = SolveCache::hash(h, &type, sizeof(type));
+        uint64_t numEdges = v->getAdj().size();
+        h = SolveCache::hash(h, &numEdges, sizeof(numEdges));
+        for(Edge<string> *e : v->getAdj()){
+            uint8_t bidirectional = e->isBidirectional();
+            h = SolveCache::hash(h, e->getDest()->getInfo());
+            h = SolveCache::hash(h, e->getWeight());
+            h = SolveCache::hash(h, e->getCost());
+            h = SolveCache::hash(h, &bidirectional, sizeof(bidirectional));
+        }
+    }
+    for(const string &code : reservoirCodes){
+        Reservoir reservoir = codeToReservoir.at(code);
+        h = SolveCache::hash(h, reservoir.getReservoirMaxDelivery());
+    }
+    for(const string &code : cityCodes){
+        const City &city = codeToCity.at(code);
+        h = SolveCache::hash(h, city.getDemand());
+        h = SolveCache::hash(h, city.getPriority());
+    }
+    //only the stations with a limit, so the fingerprint of a network without limits doesn't change
+    for(const string &code : stationCodes){
+        const Station &station = codeToStation.at(code);
+        if(!station.hasCapacity()) continue;
+        h = SolveCache::hash(h, code);
+        h = SolveCache::hash(h, station.getCapacity());
+    }
+    return SolveCache::hash(h, scenario);
+}
+
+/**
+ * Gets the flow of every edge (super source and super sink edges included), in the order of the vertex set and of their adjacency.
+ * Complexity: O(V + E) where V is the number of vertexes and E is the number of edges
+ * @return Flows of the edges
+ */
+std::vector<double> WaterSupplyManagement::edgeFlows() const {
+    vector<double> flows;
+    for(Vertex<string> *v : network.getVertexSet()){
+        for(Edge<string> *e : v->getAdj()) flows.push_back(e->getFlow());
+    }
+    return flows;
+}
+
+/**
+ * Sets the flow of every edge, in the same order as edgeFlows.
+ * Complexity: O(V + E) where V is the number of vertexes and E is the number of edges
+ * @param flows Flows of the edges
+ * @return True if the flows were set, false if their number isn't the number of edges (nothing is changed)
+ */
+bool WaterSupplyManagement::setEdgeFlows(const std::vector<double> &flows) {
+    vector<Vertex<string>*> vertexes = network.getVertexSet();
+    size_t numEdges = 0;
+    for(Vertex<string> *v : vertexes) numEdges += v->getAdj().size();
+    if(numEdges != flows.size()) return false;
+
+    size_t i = 0;
+    for(Vertex<string> *v : vertexes){
+        for(Edge<string> *e : v->getAdj()) e->setFlow(flows[i++]);
+    }
+    return true;
+}
+
+/**
+ * Solves the max flow problem from the super source to the super sink (see edmondsKarp), reusing the flows of the solve cache
+ * if the same network was already solved.
+ * Complexity: O(V + E) if the network is in the cache, O(V E^2) otherwise
+ */
+void WaterSupplyManagement::cachedMaxFlow() {
+    distributeWater(DistributionMode::MAX_FLOW);
+}
+
+/**
+ * Gets the cache with the results of the solves.
+ * Complexity: O(1)
+ * @return Solve cache
+ */
+SolveCache &WaterSupplyManagement::getSolveCache() {
+    return solveCache;
+}
+
+//Memory ================================================================================================
+/**
+ * Calculates the memory used by the model: vertexes, edges and entities (reservoirs, stations and cities with their codes),
+ * and the memory the same network would use as a CompactNetwork. The compact copy is only built to be measured, as a reference
+ * for the size of the Graph: it is discarded afterwards and the model keeps using the Graph.
+ * Complexity: O(V log V + E) where V is the number of vertexes and E is the number of edges
+ * @return Memory report
+ */
+WaterSupplyManagement::MemoryReport WaterSupplyManagement::memoryReport() {
+    MemoryReport report = {};
+    report.numVertexes = network.getNumVertex();
+    report.numEdges = network.getNumEdges();
+    network.memoryUsage(report.vertexBytes, report.edgeBytes);
+
+    report.numEntities = codeToReservoir.size() + codeToStation.size() + codeToCity.size();
+    report.entityBytes = MemoryUsage::heapBytes(codeToReservoir) + MemoryUsage::heapBytes(codeToStation) + MemoryUsage::heapBytes(codeToCity)
+                       + MemoryUsage::heapBytes(reservoirCodes) + MemoryUsage::heapBytes(stationCodes) + MemoryUsage::heapBytes(cityCodes);
+    for(auto &codeReservoir : codeToReservoir){
+        report.entityBytes += 2 * MemoryUsage::heapBytes(codeReservoir.first) + MemoryUsage::heapBytes(codeReservoir.second.getReservoirName())
+                            + MemoryUsage::heapBytes(codeReservoir.second.getReservoirMunicipality());
+    }
+    for(auto &codeStation : codeToStation){
+        report.entityBytes += 2 * MemoryUsage::heapBytes(codeStation.first);
+    }
+    for(auto &codeCity : codeToCity){
+        report.entityBytes += 2 * MemoryUsage::heapBytes(codeCity.first) + MemoryUsage::heapBytes(codeCity.second.getName());
+    }
+    //the copies in the ordered code lists
+    for(const vector<string> *codes : {&reservoirCodes, &stationCodes, &cityCodes}){
+        for(const string &code : *codes) report.entityBytes += MemoryUsage::heapBytes(code);
+    }
+
+    CompactNetwork compact;
+    compact.build(network);
+    report.compactBytes = compact.memoryUsage();
+    return report;
+}
+
+//Compact copy of the network ========================================================================================
+/**
+ * Copies the pipes of the network to a FlowNetwork. The super nodes are replaced by a source and a sink of its own, connected
+ * to the reservoirs (with their maximum delivery) and to the cities. Pipe i of the copy is the edge copy.pipes[i].
+ * A station with a capacity is split in two nodes: the pipes reach the first one, leave from the second one (copy.outNode) and a
+ * pipe with the capacity of the station joins them.
+ * With costs, a bidirectional pipe that has a cost also gets a second pipe for the opposite direction (copy.reversePipes), since its
+ * cost depends on the direction of the flow. A cheapest flow never uses both directions, so the capacity is still shared.
+ * A bidirectional pipe of a split station is also copied as two pipes, one per direction: the flow that goes both ways cancels out
+ * (see applyFlows) and cancelling it only lowers the water pumped by the stations, so the capacities are still respected.
+ * Complexity: O(V + E + c log c) where V is the number of vertexes, E is the number of edges and c is the number of cities
+ * @param copy Copy to fill
+ * @param cityCapacity Capacity of the pipes from the cities to the sink
+ * @param withCosts If true the pipes keep their costs, otherwise every pipe has no cost
+ */
+void WaterSupplyManagement::copyToFlowNetwork(FlowCopy &copy, double cityCapacity, bool withCosts) {
+    vector<Vertex<string>*> vertexSet = network.getVertexSet();
+    copy.node.assign(vertexSet.size(), UINT32_MAX);
+    copy.outNode.assign(vertexSet.size(), UINT32_MAX);
+    vector<Vertex<string>*> limited;
+    for(Vertex<string> *v : vertexSet){
+        if(v->getType() == VertexType::SUPERSOURCE || v->getType() == VertexType::SUPERSINK) continue;
+        copy.node[v->getIndex()] = copy.outNode[v->getIndex()] = copy.flowNetwork.addNode();
+        if(v->getType() != VertexType::STATIONS) continue;
+        auto search = codeToStation.find(v->getInfo());
+        if(search != codeToStation.end() && search->second.hasCapacity()){
+            copy.outNode[v->getIndex()] = copy.flowNetwork.addNode();
+            limited.push_back(v);
+        }
+    }
+    copy.source = copy.flowNetwork.addNode();
+    copy.sink = copy.flowNetwork.addNode();
+
+    auto isSplit = [&copy](const Edge<string> *e) {
+        return copy.node[e->getOrig()->getIndex()] != copy.outNode[e->getOrig()->getIndex()]
+               || copy.node[e->getDest()->getIndex()] != copy.outNode[e->getDest()->getIndex()];
+    };
+    for(Vertex<string> *v : vertexSet){
+        if(copy.node[v->getIndex()] == UINT32_MAX) continue;
+        for(Edge<string> *e : v->getAdj()){
+            if(copy.node[e->getDest()->getIndex()] == UINT32_MAX) continue;
+            uint32_t orig = copy.outNode[v->getIndex()], dest = copy.node[e->getDest()->getIndex()];
+            double cost = withCosts ? e->getCost() : 0;
+            copy.flowNetwork.addPipe(orig, dest, e->getWeight(), e->isBidirectional() && cost == 0 && !isSplit(e), cost);
+            copy.pipes.push_back(e);
+        }
+    }
+    for(uint32_t pipe = 0; pipe < copy.pipes.size(); pipe++){
+        Edge<string> *e = copy.pipes[pipe];
+        double cost = withCosts ? e->getCost() : 0;
+        if(!e->isBidirectional() || (cost == 0 && !isSplit(e))) continue;
+        copy.reversePipes.emplace_back(pipe, copy.flowNetwork.getNumPipes());
+        copy.flowNetwork.addPipe(copy.outNode[e->getDest()->getIndex()], copy.node[e->getOrig()->getIndex()], e->getWeight(), false, cost);
+    }
+    for(Vertex<string> *v : limited){
+        copy.stations.emplace_back(v->getInfo(), copy.flowNetwork.getNumPipes());
+        copy.flowNetwork.addPipe(copy.node[v->getIndex()], copy.outNode[v->getIndex()], codeToStation.at(v->getInfo()).getCapacity(), false);
+    }
+
+    for(Vertex<string> *v : vertexSet){
+        if(v->getType() == VertexType::RESERVOIR){
+            auto search = codeToReservoir.find(v->getInfo());
+            copy.reservoirs.emplace_back(v->getInfo(), copy.flowNetwork.getNumPipes());
+            copy.flowNetwork.addPipe(copy.source, copy.node[v->getIndex()], search == codeToReservoir.end() ? 0 : search->second.getReservoirMaxDelivery(), false);
+        }
+        else if(v->getType() == VertexType::CITIES){
+            copy.cities.emplace_back(v->getInfo(), copy.flowNetwork.getNumPipes());
+            copy.flowNetwork.addPipe(copy.node[v->getIndex()], copy.sink, cityCapacity, false);
+        }
+    }
+    copy.flowNetwork.finalize();
+    sort(copy.reservoirs.begin(), copy.reservoirs.end());
+    sort(copy.cities.begin(), copy.cities.end());
+    sort(copy.stations.begin(), copy.stations.end());
+}
+
+/**
+ * Stores the flows of a solved copy in the network. The super source and super sink edges (if they exist) get the flow of the
+ * pipes from the source and to the sink of the copy.
+ * Complexity: O(V + E + r log r) where V is the number of vertexes, E is the number of edges and r is the number of reservoirs
+ * @param copy Copy of the network
+ * @param ws Workspace of the solve
+ */
+void WaterSupplyManagement::applyFlows(const FlowCopy &copy, const FlowNetwork::Workspace &ws) {
+    for(uint32_t pipe = 0; pipe < copy.pipes.size(); pipe++){
+        copy.pipes[pipe]->setFlow(copy.flowNetwork.arcFlow(pipe, ws));
+    }
+    for(const auto &reverse : copy.reversePipes){
+        Edge<string> *e = copy.pipes[reverse.first];
+        e->setFlow(e->getFlow() - copy.flowNetwork.arcFlow(reverse.second, ws));
+    }
+    Vertex<string> *superSource = network.findVertex("super_source");
+    if(superSource != nullptr){
+        for(Edge<string> *e : superSource->getAdj()){
+            auto search = lower_bound(copy.reservoirs.begin(), copy.reservoirs.end(), make_pair(e->getDest()->getInfo(), uint32_t(0)));
+            if(search != copy.reservoirs.end() && search->first == e->getDest()->getInfo()) e->setFlow(copy.flowNetwork.arcFlow(search->second, ws));
+        }
+    }
+    for(const auto &city : copy.cities){
+        Edge<string> *e = findPipe(city.first, "super_sink");
+        if(e != nullptr) e->setFlow(copy.flowNetwork.arcFlow(city.second, ws));
+    }
+}
+
+/**
+ * Checks if a station of the network has a capacity.
+ * Complexity: O(s) where s is the number of stations
+ * @return True if the water pumped by a station is limited, false otherwise
+ */
+bool WaterSupplyManagement::hasStationLimits() const {
+    for(const string &code : stationCodes){
+        if(codeToStation.at(code).hasCapacity() && network.findVertex(code) != nullptr) return true;
+    }
+    return false;
+}
+
+/**
+ * Solves the max flow problem from the super source to the super sink respecting the capacities of the stations, in a copy
+ * of the network where they are split (see copyToFlowNetwork). The flows are stored in the network.
+ * Complexity: O(V E^2) where V is the number of vertexes and E is the number of edges
+ */
+void WaterSupplyManagement::stationLimitedMaxFlow() {
+    FlowCopy copy;
+    copyToFlowNetwork(copy, 0);
+    //each reservoir can send what its edge from the super source allows, each city can receive what its edge to the super sink allows
+    for(const auto &reservoir : copy.reservoirs){
+        Edge<string> *e = findPipe("super_source", reservoir.first);
+        copy.flowNetwork.setCapacity(reservoir.second, e == nullptr ? 0 : e->getWeight());
+    }
+    for(const auto &city : copy.cities){
+        Edge<string> *e = findPipe(city.first, "super_sink");
+        copy.flowNetwork.setCapacity(city.second, e == nullptr ? 0 : e->getWeight());
+    }
+    FlowNetwork::Workspace ws;
+    copy.flowNetwork.maxFlow(copy.source, copy.sink, ws);
+
+    for(Vertex<string> *v : network.getVertexSet()){
+        for(Edge<string> *e : v->getAdj()) e->setFlow(0);
+    }
+    applyFlows(copy, ws);
+}
 
-            fout << codeCity.first << ", ";
-            fout << v->getAdj().at(0)->getFlow() << ", ";
-            fout << codeCity.second.getName() << ", ";
-            fout << codeCity.second.getId() << ", ";
-            fout << codeCity.second.getPopulation() << ", ";
-            fout << codeCity.second.getDemand() << '\n';
+/**
+ * Calculates the water that leaves a vertex (bidirectional pipes used from their destination included).
+ * Complexity: O(d) where d is the degree of the vertex
+ * @param v Vertex
+ * @return Water that leaves the vertex
+ */
+double WaterSupplyManagement::outflow(const Vertex<std::string> *v) {
+    double res = 0;
+    for(Edge<string> *e : v->getAdj()){
+        if(e->getFlow() > 0) res += e->getFlow();
+    }
+    for(Edge<string> *e : v->getIncoming()){
+        if(e->isBidirectional() && e->getFlow() < 0) res -= e->getFlow();
+    }
+    return res;
+}
+
+//Published results =================================================================================
+/**
+ * Copies the current flows (water received by each city and flow of each pipe) to a new immutable snapshot and publishes it,
+ * replacing the previous one. Threads holding the previous snapshot keep using it until they release it.
+ * Should be called by the thread that changes the network, after a solve.
+ * Complexity: O(V + E) where V is the number of vertexes and E is the number of edges
+ * @return Published snapshot
+ */
+std::shared_ptr<const FlowSnapshot> WaterSupplyManagement::publishSnapshot() {
+    vector<FlowSnapshot::CityFlow> cities;
+    cities.reserve(codeToCity.size());
+    for(const string &code : cityCodes){
+        const pair<const string, City> &codeCity = *codeToCity.find(code);
+        double demand = codeCity.second.getDemand();
+        cities.push_back({codeCity.first, demand, demand - flowDeficit(codeCity.first)});
+    }
+
+    //super source and super sink edges are not pipes
+    vector<FlowSnapshot::PipeFlow> pipes;
+    for(Vertex<string> *v : network.getVertexSet()){
+        if(v->getType() == VertexType::SUPERSOURCE) continue;
+        for(Edge<string> *e : v->getAdj()){
+            if(e->getDest()->getType() == VertexType::SUPERSINK) continue;
+            pipes.push_back({v->getInfo(), e->getDest()->getInfo(), e->getWeight(), e->getFlow(), e->isBidirectional()});
         }
     }
 
-    fout.close();
+    shared_ptr<const FlowSnapshot> previous = getSnapshot();
+    uint64_t epoch = previous == nullptr ? 1 : previous->getEpoch() + 1;
+    shared_ptr<const FlowSnapshot> res = make_shared<const FlowSnapshot>(epoch, std::move(cities), std::move(pipes));
+    std::atomic_store(&snapshot, res);
+    return res;
+}
+
+/**
+ * Gets the last published snapshot. Can be called from any thread, even while the network is being solved.
+ * Complexity: O(1)
+ * @return Last published snapshot (nullptr if nothing was published yet)
+ */
+std::shared_ptr<const FlowSnapshot> WaterSupplyManagement::getSnapshot() const {
+    return std::atomic_load(&snapshot);
 }
 
 /**
  * Balances the network water flow in order to minimize the average difference between the pipe capacity and flow.
- * Complexity: O(VE^2 D) where v is the number of vertexes, E is the number of edges and D is unknown (number of times the while loops runs, it depends on the balance of the original graph, worst case is exponential)
+ * Parts of the network that are not connected by pipes are balanced at the same time (see balanceRegion), so a network that is
+ * a single part uses a single thread.
+ * Complexity: O(V + E + M L) where V is the number of vertexes, E is the number of edges, M is the number of moves tried
+ * (it depends on the balance of the original graph, worst case is exponential) and L is the length of their paths
+ * @param numThreads Maximum number of threads (0 uses one per hardware thread)
  */
-void WaterSupplyManagement::networkBalance() {
-    double Avg = avgDiffPipes();
+void WaterSupplyManagement::networkBalance(unsigned int numThreads) {
+    Profiler::ScopedTimer timer("networkBalance", "balancing");
+    balanceRegion(vector<bool>(network.getNumVertex(), true), numThreads);
+}
 
-    resetPath();
-    resetVisited();
+/**
+ * Balances only a region of the network: the reservoirs and stations of the region and their neighbours (for example, the vertexes
+ * whose flow changed after an edit, see changedVertexes). The moves are tried in the same order as networkBalance.
+ * Complexity: O(V + E + M L) where V is the number of vertexes, E is the number of edges, M is the number of moves tried
+ * and L is the length of their paths
+ * @param region Codes of the vertexes of the region
+ * @param numThreads Maximum number of threads (0 uses one per hardware thread)
+ */
+void WaterSupplyManagement::networkBalance(const std::vector<std::string> &region, unsigned int numThreads) {
+    PipeStats stats;
+    networkBalance(region, stats, numThreads);
+}
 
-    //calculates the difference of the pipes that go from the reservoirs
-    for(pair<string,Reservoir> codeR : codeToReservoir){
-        Vertex<string> *v = network.findVertex(codeR.first);
+/**
+ * Balances only a region of the network (see networkBalance) and updates the differences of the pipes of the whole network with the
+ * moves that were kept, so repeated regional balances don't have to go over every pipe (see pipeStats).
+ * Complexity: O(V + E + M L) where V is the number of vertexes, E is the number of edges, M is the number of moves tried
+ * and L is the length of their paths
+ * @param region Codes of the vertexes of the region
+ * @param stats Differences of the pipes before the balance, updated with the ones after it
+ * @param numThreads Maximum number of threads (0 uses one per hardware thread)
+ */
+void WaterSupplyManagement::networkBalance(const std::vector<std::string> &region, PipeStats &stats, unsigned int numThreads) {
+    Profiler::ScopedTimer timer("networkBalance", "balancing");
+    vector<bool> inRegion(network.getNumVertex(), false);
+    for(const string &code : region){
+        Vertex<string> *v = network.findVertex(code);
         if(v == nullptr) continue;
-        if(v->getAdj().size() > 1) {
-            while (true) {
+        inRegion[v->getIndex()] = true;
+        for(Edge<string> *e : v->getAdj()) inRegion[e->getDest()->getIndex()] = true;
+        for(Edge<string> *e : v->getIncoming()) inRegion[e->getOrig()->getIndex()] = true;
+    }
+    stats.sumDiff += balanceRegion(inRegion, numThreads);
+}
 
-                //tries to find a path to subtract flow (smallest difference)
-                if (!flowSub(v)) {
-                    resetFlowChanges(v, 1);
-                    break;
-                }
-                resetPath();
-                resetVisited();
+/**
+ * Finds the vertexes with a pipe whose flow is not the same as in a snapshot (pipes added or removed since the snapshot included).
+ * Complexity: O(V + E) where V is the number of vertexes and E is the number of edges
+ * @param previous Snapshot to compare with
+ * @return Codes of the vertexes, in the order of the vertex set
+ */
+std::vector<std::string> WaterSupplyManagement::changedVertexes(const FlowSnapshot &previous) const {
+    vector<bool> changed(network.getNumVertex(), false);
+    for(Vertex<string> *v : network.getVertexSet()){
+        if(v->getType() == VertexType::SUPERSOURCE) continue;
+        for(Edge<string> *e : v->getAdj()){
+            if(e->getDest()->getType() == VertexType::SUPERSINK) continue;
+            if(previous.pipeFlow(v->getInfo(), e->getDest()->getInfo()) != e->getFlow()){
+                changed[v->getIndex()] = true;
+                changed[e->getDest()->getIndex()] = true;
+            }
+        }
+    }
+    for(const FlowSnapshot::PipeFlow &pipe : previous.getPipes()){
+        if(pipe.flow == 0 || findPipe(pipe.origin, pipe.destination) != nullptr) continue;
+        for(const string *code : {&pipe.origin, &pipe.destination}){
+            Vertex<string> *v = network.findVertex(*code);
+            if(v != nullptr) changed[v->getIndex()] = true;
+        }
+    }
 
-                //tries to find a path to add flow (biggest difference)
-                if (!flowAdd(v)) {
-                    resetFlowChanges(v, -1);
-                    break;
-                }
-                resetPath();
-                resetVisited();
+    vector<string> res;
+    for(Vertex<string> *v : network.getVertexSet()){
+        if(changed[v->getIndex()]) res.push_back(v->getInfo());
+    }
+    return res;
+}
 
-                //calculates the new avg and verifies if it is better or worse than before
-                double newAVG = avgDiffPipes();
-                if(newAVG >= Avg){
-                    break;
-                }
-                Avg = newAVG;
+/**
+ * Balances the reservoirs and then the stations (in file order) that are in a region.
+ * A move only changes pipes connected to its starting vertex and is kept depending on the pipes it changed, so the parts of the network
+ * that are not connected by pipes don't interact: each one is balanced by a single thread, in the same order as a sequential balance,
+ * and the result is the same for any number of threads.
+ * The parts are the unit of work: at most one thread per part is used, and a network connected by pipes is balanced sequentially.
+ * The moves of a connected part may share pipes and the order they are tried in decides which ones are kept, so it is not split.
+ * Complexity: O(V + E + M L) where V is the number of vertexes, E is the number of edges, M is the number of moves tried
+ * and L is the length of their paths
+ * @param inRegion True for the vertexes of the region, indexed by the vertex index
+ * @param numThreads Maximum number of threads (0 uses one per hardware thread)
+ * @return Change of the sum of the differences of the pipes (see pipeStats)
+ */
+double WaterSupplyManagement::balanceRegion(const std::vector<bool> &inRegion, unsigned int numThreads) {
+    //starting vertexes of each part of the network, reservoirs first and then the stations
+    vector<uint32_t> component = pipeComponents();
+    vector<vector<Vertex<string>*>> starts;
+    vector<size_t> startsOf(network.getNumVertex(), SIZE_MAX);
+    for(const vector<string> *codes : {&reservoirCodes, &stationCodes}){
+        for(const string &code : *codes){
+            Vertex<string> *v = network.findVertex(code);
+            if(v == nullptr || !inRegion[v->getIndex()] || numPipes(v) <= 1) continue;
+            size_t &part = startsOf[component[v->getIndex()]];
+            if(part == SIZE_MAX){
+                part = starts.size();
+                starts.emplace_back();
             }
+            starts[part].push_back(v);
+        }
+    }
+    if(starts.empty()) return 0;
+
+    //capacities of the stations, read by the moves (see stationMoves)
+    stationLimit.clear();
+    if(hasStationLimits()){
+        stationLimit.assign(network.getNumVertex(), numeric_limits<double>::infinity());
+        for(const string &code : stationCodes){
+            Vertex<string> *v = network.findVertex(code);
+            if(v != nullptr) stationLimit[v->getIndex()] = codeToStation.at(code).getCapacity();
         }
     }
 
-    //calculates the difference of the pipes that go from the stations
-    for(pair<string,Station> codeS : codeToStation){
-        Vertex<string> *v = network.findVertex(codeS.first);
-        if(v == nullptr) continue;
-        if(v->getAdj().size() > 1) {
-            while (true) {
+    //the biggest parts are taken first so the threads finish at about the same time
+    vector<size_t> order(starts.size());
+    for(size_t i = 0; i < order.size(); i++) order[i] = i;
+    stable_sort(order.begin(), order.end(), [&starts](size_t a, size_t b) { return starts[a].size() > starts[b].size(); });
+
+    if(numThreads == 0) numThreads = max(1u, thread::hardware_concurrency());
+    numThreads = max(1u, min<unsigned int>(numThreads, starts.size()));
+    atomic<size_t> next(0);
+    //change of the differences of each part
+    vector<double> partDiff(starts.size(), 0);
+    auto worker = [&]() {
+        //paths of the moves being tried (one workspace per thread, reset in O(1) between moves)
+        TraversalWorkspace<string> ws(network.getNumVertex());
+        //only the change of the differences matters to keep or undo a move
+        PipeStats stats;
+        for(size_t i = next++; i < order.size(); i = next++){
+            stats.sumDiff = 0;
+            for(Vertex<string> *v : starts[order[i]]){
+                balanceVertex(v, stats, ws);
+            }
+            partDiff[order[i]] = stats.sumDiff;
+        }
+    };
+    vector<thread> threads;
+    for(unsigned int t = 1; t < numThreads; t++) threads.emplace_back(worker);
+    worker();
+    for(thread &t : threads) t.join();
+    stationLimit.clear();
+
+    //added in the order of the parts, so the result doesn't depend on the threads
+    double sumDiff = 0;
+    for(double diff : partDiff) sumDiff += diff;
+    return sumDiff;
+}
 
-                //tries to find a path to subtract flow (smallest difference)
-                if (!flowSub(v)) {
-                    resetFlowChanges(v, 1);
-                    break;
-                }
-                resetPath();
-                resetVisited();
+/**
+ * Splits the network in the parts connected by pipes (the super source and the super sink don't connect them).
+ * Complexity: O(V + E) where V is the number of vertexes and E is the number of edges
+ * @return Part of each vertex, indexed by the vertex index (numbered from 0 in the order of the vertex set)
+ */
+std::vector<uint32_t> WaterSupplyManagement::pipeComponents() const {
+    vector<Vertex<string>*> vertexes = network.getVertexSet();
+    vector<uint32_t> component(vertexes.size(), UINT32_MAX);
+    vector<Vertex<string>*> stack;
+    uint32_t numComponents = 0;
+
+    for(Vertex<string> *start : vertexes){
+        if(component[start->getIndex()] != UINT32_MAX) continue;
+        component[start->getIndex()] = numComponents;
+        VertexType type = start->getType();
+        if(type != VertexType::SUPERSOURCE && type != VertexType::SUPERSINK) stack.push_back(start);
+
+        while(!stack.empty()){
+            Vertex<string> *v = stack.back();
+            stack.pop_back();
+            for(Edge<string> *e : v->getAdj()){
+                Vertex<string> *w = e->getDest();
+                if(component[w->getIndex()] != UINT32_MAX || w->getType() == VertexType::SUPERSINK) continue;
+                component[w->getIndex()] = numComponents;
+                stack.push_back(w);
+            }
+            for(Edge<string> *e : v->getIncoming()){
+                Vertex<string> *w = e->getOrig();
+                if(component[w->getIndex()] != UINT32_MAX || w->getType() == VertexType::SUPERSOURCE) continue;
+                component[w->getIndex()] = numComponents;
+                stack.push_back(w);
+            }
+        }
+        numComponents++;
+    }
+    return component;
+}
 
-                //tries to find a path to add flow (biggest difference)
-                if (!flowAdd(v)) {
-                    resetFlowChanges(v, -1);
-                    break;
-                }
-                resetPath();
-                resetVisited();
 
-                //calculates the new avg and verifies if it is better or worse than before
-                double newAVG = avgDiffPipes();
-                if(newAVG >= Avg){
-                    break;
+//Auxiliary functions to balance the network ============================================================================
+/**
+ * Moves flow from the pipes leaving a vertex with the smallest difference to the ones with the biggest difference,
+ * one unit at a time, while the average difference keeps decreasing. A move that fails, doesn't improve the average or makes a station
+ * pump more than its capacity is undone.
+ * When a move would be repeated with the same paths, all the repetitions are made at once (see repeatableMoves).
+ * Complexity: O(L^2 d D) where L is the length of the paths, d is the degree of their vertexes and D is the number of different moves.
+ * @param v Starting vertex (station or reservoir)
+ * @param stats Differences of the pipes (only the sum is used and updated with the moves that are kept, it can start at 0)
+ * @param ws Traversal state used to store the paths of the moves
+ */
+void WaterSupplyManagement::balanceVertex(Vertex<std::string> *v, PipeStats &stats, TraversalWorkspace<std::string> &ws) {
+    while (true) {
+        double previous = stats.sumDiff;
+
+        //tries to find a path to subtract flow (smallest difference)
+        if (!flowSub(v, ws)) {
+            resetFlowChanges(v, 1, ws);
+            ws.reset(network.getNumVertex());
+            break;
+        }
+        vector<pair<Edge<string>*, Vertex<string>*>> subPath = pathSteps(v, ws);
+        updatePipeStats(stats, subPath, -1);
+        ws.reset(network.getNumVertex());
+
+        //tries to find a path to add flow (biggest difference)
+        if (!flowAdd(v, ws)) {
+            resetFlowChanges(v, -1, ws);
+            ws.reset(network.getNumVertex());
+            revertSteps(subPath, 1);
+            stats.sumDiff = previous;
+            break;
+        }
+        vector<pair<Edge<string>*, Vertex<string>*>> addPath = pathSteps(v, ws);
+        updatePipeStats(stats, addPath, 1);
+        ws.reset(network.getNumVertex());
+
+        //verifies if the new avg is better or worse than before (the number of pipes doesn't change, the sums are enough)
+        //and that no station pumps more than its capacity
+        int stationRepeats = stationMoves(subPath, addPath);
+        if(stats.sumDiff >= previous || stationRepeats < 0){
+            revertSteps(addPath, -1);
+            revertSteps(subPath, 1);
+            stats.sumDiff = previous;
+            break;
+        }
+
+        //the next moves would take the same paths while the same pipes are chosen, they are made at once
+        int repeats = min(repeatableMoves(subPath, addPath, ws), stationRepeats);
+        if(repeats > 0){
+            revertSteps(subPath, -repeats);
+            revertSteps(addPath, repeats);
+            stats.sumDiff += repeats * (stats.sumDiff - previous);
+        }
+    }
+}
+
+/**
+ * Checks the capacities of the stations after a move of balanceVertex. The stations of the path where flow was added pump one more unit
+ * per move (one less for the path where flow was subtracted), except the starting vertex, whose outflow doesn't change.
+ * Complexity: O(L^2 + L d) where L is the length of the paths and d is the degree of their vertexes
+ * @param subPath Steps of the path where flow was subtracted
+ * @param addPath Steps of the path where flow was added
+ * @return -1 if a station pumps more than its capacity, otherwise how many times the move can be repeated before one does
+ */
+int WaterSupplyManagement::stationMoves(const std::vector<std::pair<Edge<std::string>*, Vertex<std::string>*>> &subPath,
+                                        const std::vector<std::pair<Edge<std::string>*, Vertex<std::string>*>> &addPath) const {
+    int res = numeric_limits<int>::max();
+    if(stationLimit.empty()) return res;
+
+    //change of the water pumped by each station per move
+    vector<pair<Vertex<string>*, int>> change;
+    auto count = [&](const vector<pair<Edge<string>*, Vertex<string>*>> &steps, int flow) {
+        for(size_t i = 1; i < steps.size(); i++){
+            Vertex<string> *w = steps[i].second;
+            if(stationLimit[w->getIndex()] == numeric_limits<double>::infinity()) continue;
+            auto search = find_if(change.begin(), change.end(), [w](const pair<Vertex<string>*, int> &c) { return c.first == w; });
+            if(search == change.end()) change.emplace_back(w, flow);
+            else search->second += flow;
+        }
+    };
+    count(addPath, 1);
+    count(subPath, -1);
+
+    for(const pair<Vertex<string>*, int> &c : change){
+        if(c.second <= 0) continue;
+        double spare = stationLimit[c.first->getIndex()] - outflow(c.first);
+        if(spare < 0) return -1;
+        res = min<double>(res, floor(spare / c.second));
+    }
+    return res;
+}
+
+/**
+ * Counts how many times in a row balanceVertex would repeat the move it just made (the same paths, one unit of flow each time).
+ * Each move changes the flows by the same amounts, so the residual of every pipe a vertex of the paths chooses from changes linearly.
+ * A move is repeated while every vertex would still choose the same pipe (same candidates, same minimum/maximum and ties broken the same way),
+ * the paths can still carry the flow and the difference of the bidirectional pipes stays linear (the flow doesn't change direction),
+ * which also makes every repetition improve the average by the same amount as the move made.
+ * Complexity: O(L^2 d) where L is the length of the paths and d is the degree of their vertexes
+ * @param subPath Steps of the path where flow was subtracted
+ * @param addPath Steps of the path where flow was added
+ * @param ws Traversal state (reset at the end)
+ * @return Number of repetitions
+ */
+int WaterSupplyManagement::repeatableMoves(const std::vector<std::pair<Edge<std::string>*, Vertex<std::string>*>> &subPath,
+                                           const std::vector<std::pair<Edge<std::string>*, Vertex<std::string>*>> &addPath, TraversalWorkspace<std::string> &ws) {
+    double limit = numeric_limits<int>::max();
+
+    //flow change of a pipe in a path, in the direction of the pipe
+    auto pathChange = [](const Edge<string> *e, const vector<pair<Edge<string>*, Vertex<string>*>> &steps) {
+        double change = 0;
+        for(const auto &step : steps){
+            if(step.first == e) change += step.second == e->getOrig() ? 1 : -1;
+        }
+        return change;
+    };
+
+    //every vertex of the paths has to choose the same pipe again
+    for(bool adding : {false, true}){
+        const vector<pair<Edge<string>*, Vertex<string>*>> &steps = adding ? addPath : subPath;
+        ws.reset(network.getNumVertex());
+        for(const auto &step : steps){
+            Vertex<string> *u = step.second;
+            Edge<string> *chosen = step.first;
+
+            //residual of a pipe when u chooses, at the move made and its change in each repetition
+            auto residual = [&](const Edge<string> *e, double &slope) {
+                double change = pathChange(e, addPath) - pathChange(e, subPath);
+                double flow = e->getFlow() - change - (adding ? pathChange(e, subPath) : 0);
+                slope = e->getOrig() == u ? -change : change;
+                return e->getOrig() == u ? e->getWeight() - flow : (e->isBidirectional() ? e->getWeight() + flow : flow);
+            };
+            double chosenSlope;
+            double chosenResidual = residual(chosen, chosenSlope);
+
+            //candidates in the order of edgeWithTheMinDiff/edgeWithTheMaxDiff
+            vector<Edge<string>*> candidates = u->getAdj();
+            for(Edge<string> *e : u->getIncoming()) candidates.push_back(e);
+            bool beforeChosen = true;
+            for(Edge<string> *e : candidates){
+                bool outgoing = e->getOrig() == u;
+                if(!outgoing && !e->isBidirectional()) continue;
+                if(ws.getPath(outgoing ? e->getDest() : e->getOrig()) != nullptr) continue;
+
+                double change = pathChange(e, addPath) - pathChange(e, subPath);
+                double flow = e->getFlow() - change - (adding ? pathChange(e, subPath) : 0);
+                if(e->isBidirectional()){
+                    //the flow has to keep the side of 0 that makes it a candidate or not
+                    bool candidate = outgoing ? flow >= 0 : flow <= 0;
+                    double signedFlow = outgoing ? flow : -flow;
+                    double signedChange = outgoing ? change : -change;
+                    if(candidate) limitRepeats(-signedFlow, -signedChange, false, limit);
+                    else{
+                        limitRepeats(signedFlow, signedChange, true, limit);
+                        continue;
+                    }
+                }
+                if(e == chosen){
+                    beforeChosen = false;
+                    continue;
                 }
-                Avg = newAVG;
+
+                double slope;
+                double r = residual(e, slope);
+                //the first pipe with the minimum (subtracting) or maximum (adding) residual is chosen
+                if(adding) limitRepeats(r - chosenResidual, slope - chosenSlope, beforeChosen, limit);
+                else limitRepeats(chosenResidual - r, chosenSlope - slope, beforeChosen, limit);
             }
+
+            //the chosen pipe can still carry the change
+            if(adding) limitRepeats(-chosenResidual, -chosenSlope, true, limit);
+            else limitRepeats(chosenResidual - chosen->getWeight(), chosenSlope, true, limit);
+
+            ws.setPath(u, chosen);
         }
     }
+    ws.reset(network.getNumVertex());
+
+    //the flows stay in the capacity and the bidirectional pipes that count for the average don't change direction
+    for(const vector<pair<Edge<string>*, Vertex<string>*>> *steps : {&subPath, &addPath}){
+        for(const auto &step : *steps){
+            Edge<string> *e = step.first;
+            double change = pathChange(e, addPath) - pathChange(e, subPath);
+            if(change == 0) continue;
+            //flow after the move made and its change in each repetition
+            double flow = e->getFlow();
+            double lower = e->isBidirectional() ? -e->getWeight() : 0;
+            limitRepeats(lower - flow, -change, false, limit);
+            limitRepeats(flow - e->getWeight(), change, false, limit);
+            if(e->isBidirectional() && inPipeStats(e)){
+                double initial = flow - change;
+                if(initial > 0) limitRepeats(-flow, -change, false, limit);
+                if(initial < 0) limitRepeats(flow, change, false, limit);
+            }
+        }
+    }
+
+    return std::max(0, static_cast<int>(limit));
+}
+
+/**
+ * Limits the number of repetitions of a move to the ones where a value that changes linearly stays negative (or not positive).
+ * Complexity: O(1)
+ * @param value Value at the move made (repetition 0)
+ * @param slope Change of the value in each repetition
+ * @param strict True if the value has to be negative, false if it can also be 0
+ * @param limit Maximum number of repetitions (updated)
+ */
+void WaterSupplyManagement::limitRepeats(double value, double slope, bool strict, double &limit) {
+    if(slope <= 0){
+        if(strict ? value >= 0 : value > 0) limit = -1;
+        return;
+    }
+    double repeats = strict ? std::ceil(-value / slope) - 1 : std::floor(-value / slope);
+    limit = std::min(limit, repeats);
 }
 
+/**
+ * Updates the differences of the pipes after flow was added along the steps of a path.
+ * Complexity: O(n) where n is the size of the path
+ * @param stats Differences of the pipes
+ * @param steps Pairs edge/vertex where the flow enters the edge (the flow was already added)
+ * @param flow Amount of flow that was added
+ */
+void WaterSupplyManagement::updatePipeStats(PipeStats &stats, const std::vector<std::pair<Edge<std::string>*, Vertex<std::string>*>> &steps, int flow) {
+    for(const auto &step : steps){
+        Edge<string> *e = step.first;
+        if(!inPipeStats(e)) continue;
+        double previousFlow = e->getFlow() - (step.second == e->getOrig() ? flow : -flow);
+        stats.sumDiff += pipeDiff(e, e->getFlow()) - pipeDiff(e, previousFlow);
+    }
+}
+
+/**
+ * Gets the number of pipes connected to a vertex that can carry water away from it (outgoing and bidirectional incoming pipes).
+ * Complexity: O(n) where n is the number of incoming edges of the vertex
+ * @param v Vertex
+ * @return Number of pipes
+ */
+size_t WaterSupplyManagement::numPipes(Vertex<std::string> *v) {
+    size_t res = v->getAdj().size();
+    for(Edge<string> *e : v->getIncoming()){
+        if(e->isBidirectional()) res++;
+    }
+    return res;
+}
+
+/**
+ * Gets the edges of the path that starts in a vertex (following the path of each vertex) and the vertex where each edge is entered.
+ * Complexity: O(n) where n is the size of the path
+ * @param v Initial vertex
+ * @param ws Traversal state with the path
+ * @return Pairs edge/vertex where the flow enters the edge
+ */
+std::vector<std::pair<Edge<std::string>*, Vertex<std::string>*>> WaterSupplyManagement::pathSteps(Vertex<std::string> *v, const TraversalWorkspace<std::string> &ws) {
+    vector<pair<Edge<string>*, Vertex<string>*>> steps;
+    Vertex<string> *currentVertex = v;
+    size_t maxSteps = network.getNumVertex();
+    while(ws.getPath(currentVertex) != nullptr && steps.size() <= maxSteps){
+        Edge<string> *e = ws.getPath(currentVertex);
+        steps.emplace_back(e, currentVertex);
+        currentVertex = e->getOther(currentVertex);
+    }
+    return steps;
+}
+
+/**
+ * Adds flow along the steps of a path (used to undo flow changes).
+ * Complexity: O(n) where n is the size of the path
+ * @param steps Pairs edge/vertex where the flow enters the edge
+ * @param flow Amount of flow to add
+ */
+void WaterSupplyManagement::revertSteps(const std::vector<std::pair<Edge<std::string>*, Vertex<std::string>*>> &steps, int flow) {
+    for(const auto &step : steps){
+        step.first->addFlowFrom(step.second, flow);
+    }
+}
 
-//Auxiliary functions to balance the network ============================================================================
 /**
  * Adds flow in pipes that have the biggest difference between capacity and flow.
  * Complexity: O(E) where e is the number of edges.
  * @param v Starting vertex (station or reservoir)
+ * @param ws Traversal state where the path is stored
  * @return True if we successfully find a path that can accept more flow and finishes into a sink (city). False, otherwise.
  */
-bool WaterSupplyManagement::flowAdd(Vertex<std::string> *v) {
+bool WaterSupplyManagement::flowAdd(Vertex<std::string> *v, TraversalWorkspace<std::string> &ws) {
     Edge<string> *currentEdge;
     Vertex<string> *currentVertex = v;
 
     while(currentVertex->getType() != VertexType::CITIES){
 
-        currentEdge = edgeWithTheMaxDiff(currentVertex->getAdj());
+        currentEdge = edgeWithTheMaxDiff(currentVertex, ws);
 
         if(currentEdge == nullptr){
             return false;
         }
 
-        if(currentEdge->getWeight() - currentEdge->getFlow() == 0){
+        if(currentEdge->getResidual(currentVertex) == 0){
             return false;
         }
 
-        currentEdge->setFlow(currentEdge->getFlow() + 1);
-        currentVertex->setPath(currentEdge);
-        currentVertex = currentEdge->getDest();
+        currentEdge->addFlowFrom(currentVertex, 1);
+        Profiler::count(ProfilerCounter::FLOW_ADD_STEPS);
+        ws.setPath(currentVertex, currentEdge);
+        currentVertex = currentEdge->getOther(currentVertex);
     }
 
     return true;
@@ -752,29 +2534,32 @@ bool WaterSupplyManagement::flowAdd(Vertex<std::string> *v) {
  * Subtracts flow in pipes that have the lowest difference between capacity and flow.
  * Complexity: O(E) where e is the number of edges.
  * @param v Starting vertex (station or reservoir)
+ * @param ws Traversal state where the path is stored
  * @return True if we successfully find a path where we can subtract flow and finishes into a sink (city). False, otherwise.
  */
-bool WaterSupplyManagement::flowSub(Vertex<std::string> *v) {
+bool WaterSupplyManagement::flowSub(Vertex<std::string> *v, TraversalWorkspace<std::string> &ws) {
     Edge<string> *currentEdge;
     Vertex<string> *currentVertex = v;
 
     while(currentVertex->getType() != VertexType::CITIES){
 
-        currentEdge = edgeWithTheMinDiff(currentVertex->getAdj());
+        currentEdge = edgeWithTheMinDiff(currentVertex, ws);
 
 
+        //every pipe goes back to the path
         if(currentEdge == nullptr){
-            cout << "This should not happen\n";
             return false;
         }
 
-        if(currentEdge->getWeight() - currentEdge->getFlow() == currentEdge->getWeight()){
+        //no flow leaves the vertex through this pipe
+        if(currentEdge->getResidual(currentVertex) >= currentEdge->getWeight()){
             return false;
         }
 
-        currentEdge->setFlow(currentEdge->getFlow() -1);
-        currentVertex->setPath(currentEdge);
-        currentVertex = currentEdge->getDest();
+        currentEdge->addFlowFrom(currentVertex, -1);
+        Profiler::count(ProfilerCounter::FLOW_SUB_STEPS);
+        ws.setPath(currentVertex, currentEdge);
+        currentVertex = currentEdge->getOther(currentVertex);
     }
 
     return true;
@@ -785,14 +2570,15 @@ bool WaterSupplyManagement::flowSub(Vertex<std::string> *v) {
  * Complexity: O(E) where e is the number of edges.
  * @param v Initial vertex
  * @param flow Amount of flow to add
+ * @param ws Traversal state with the path of the changes
  */
-void WaterSupplyManagement::resetFlowChanges(Vertex<std::string> *v, int flow) {
+void WaterSupplyManagement::resetFlowChanges(Vertex<std::string> *v, int flow, TraversalWorkspace<std::string> &ws) {
     Edge<string> *currentEdge;
     Vertex<string> *currentVertex = v;
 
     while(true){
-        currentEdge = currentVertex->getPath();
-        if (currentVertex->isVisited()){
+        currentEdge = ws.getPath(currentVertex);
+        if (ws.isVisited(currentVertex)){
             break;
         }
 
@@ -800,26 +2586,35 @@ void WaterSupplyManagement::resetFlowChanges(Vertex<std::string> *v, int flow) {
             break;
         }
 
-        currentEdge->setFlow(currentEdge->getFlow() + flow);
-        currentVertex->setVisited(true);
-        currentVertex = currentEdge->getDest();
+        currentEdge->addFlowFrom(currentVertex, flow);
+        ws.setVisited(currentVertex, true);
+        currentVertex = currentEdge->getOther(currentVertex);
     }
 
 }
 
 /**
- * Finds the edge with the minimum difference in a selection of edges.
- * Complexity: O(n) where n is size of the vector
- * @param adj Selection of edges to analise
+ * Finds the pipe leaving a vertex with the minimum difference (residual capacity in the direction that leaves the vertex).
+ * The outgoing edges and the bidirectional incoming edges are analised, except the ones that go back to a vertex already in the path
+ * and the bidirectional ones whose flow enters the vertex (a pipe can't have flow both ways).
+ * Complexity: O(n) where n is the number of edges of the vertex
+ * @param v Vertex where the pipes start
+ * @param ws Traversal state with the current path
  * @return edge with the minimum difference in a selection of edges.
  */
-Edge<string>* WaterSupplyManagement::edgeWithTheMinDiff(const std::vector<Edge<std::string> *>& adj) {
+Edge<string>* WaterSupplyManagement::edgeWithTheMinDiff(Vertex<std::string> *v, const TraversalWorkspace<std::string> &ws) {
     double diff = LONG_LONG_MAX;
     Edge<string>* res = nullptr;
 
-    for(Edge<string> *e: adj){
-        if((e->getWeight() - e->getFlow()) < diff){
-            diff = e->getWeight() - e->getFlow();
+    for(Edge<string> *e: v->getAdj()){
+        if(ws.getPath(e->getDest()) == nullptr && (!e->isBidirectional() || e->getFlow() >= 0) && e->getResidual(v) < diff){
+            diff = e->getResidual(v);
+            res = e;
+        }
+    }
+    for(Edge<string> *e: v->getIncoming()){
+        if(e->isBidirectional() && e->getFlow() <= 0 && ws.getPath(e->getOrig()) == nullptr && e->getResidual(v) < diff){
+            diff = e->getResidual(v);
             res = e;
         }
     }
@@ -828,18 +2623,27 @@ Edge<string>* WaterSupplyManagement::edgeWithTheMinDiff(const std::vector<Edge<s
 }
 
 /**
- * Finds the edge with the maximum difference in a selection of edges.
- * Complexity: O(n) where n is size of the vector
- * @param adj Selection of edges to analise
+ * Finds the pipe leaving a vertex with the maximum difference (residual capacity in the direction that leaves the vertex).
+ * The outgoing edges and the bidirectional incoming edges are analised, except the ones that go back to a vertex already in the path
+ * and the bidirectional ones whose flow enters the vertex (a pipe can't have flow both ways).
+ * Complexity: O(n) where n is the number of edges of the vertex
+ * @param v Vertex where the pipes start
+ * @param ws Traversal state with the current path
  * @return edge with the maximum difference in a selection of edges.
  */
-Edge<string>* WaterSupplyManagement::edgeWithTheMaxDiff(const std::vector<Edge<std::string> *>& adj) {
+Edge<string>* WaterSupplyManagement::edgeWithTheMaxDiff(Vertex<std::string> *v, const TraversalWorkspace<std::string> &ws) {
     double diff = 0.0;
     Edge<string>* res = nullptr;
 
-    for(Edge<string> *e: adj){
-        if((e->getWeight() - e->getFlow()) > diff){
-            diff = e->getWeight() - e->getFlow();
+    for(Edge<string> *e: v->getAdj()){
+        if(ws.getPath(e->getDest()) == nullptr && (!e->isBidirectional() || e->getFlow() >= 0) && e->getResidual(v) > diff){
+            diff = e->getResidual(v);
+            res = e;
+        }
+    }
+    for(Edge<string> *e: v->getIncoming()){
+        if(e->isBidirectional() && e->getFlow() <= 0 && ws.getPath(e->getOrig()) == nullptr && e->getResidual(v) > diff){
+            diff = e->getResidual(v);
             res = e;
         }
     }
@@ -847,28 +2651,45 @@ Edge<string>* WaterSupplyManagement::edgeWithTheMaxDiff(const std::vector<Edge<s
     return res;
 }
 
+
+//Reliability and Sensitivity =========================================================================
+
 /**
- * Resets the path in all the vertexes in the graph
- * Complexity: O(v) where v is the number of vertexes
+ * Gets the reachability index of the network (which cities each element can send water to), building it first if the pipes
+ * or the vertexes changed since it was last built.
+ * Complexity: O(1) if the index is up to date, O(V + E + C (c + r) / 64) otherwise (see ReachabilityIndex::build)
+ * @return Reachability index of the network
  */
-void WaterSupplyManagement::resetPath(){
-    for(Vertex<string> *v : network.getVertexSet()){
-        v->setPath(nullptr);
+const ReachabilityIndex &WaterSupplyManagement::getReachability() {
+    if(!reachabilityValid){
+        reachability.build(network);
+        reachabilityValid = true;
     }
+    return reachability;
 }
 
 /**
- * Resets the visited state in all the vertexes in the graph
- * Complexity: O(v) where v is the number of vertexes
+ * Gets the dominator tree of the network (which reservoirs, stations and pipes every path to a city goes through), building it first if the pipes
+ * or the vertexes changed since it was last built.
+ * Complexity: O(1) if the tree is up to date, O(E log V) otherwise (see DominatorTree::build)
+ * @return Dominator tree of the network
  */
-void WaterSupplyManagement::resetVisited() {
-    for(Vertex<string> *v : network.getVertexSet()){
-        v->setVisited(false);
+const DominatorTree &WaterSupplyManagement::getDominators() {
+    if(!dominatorsValid){
+        dominators.build(network);
+        dominatorsValid = true;
     }
+    return dominators;
 }
 
-
-//Reliability and Sensitivity =========================================================================
+/**
+ * Marks the structures computed from the topology of the network (reachability index and dominator tree) as outdated.
+ * Complexity: O(1)
+ */
+void WaterSupplyManagement::topologyChanged() {
+    reachabilityValid = false;
+    dominatorsValid = false;
+}
 
 /**
  * Gets the Cities that were affected (water supply not being met) by removing a given reservoir.
@@ -878,6 +2699,7 @@ void WaterSupplyManagement::resetVisited() {
  * @return  Code of the cities that were affected by the removal of the reservoir.
  */
 vector<pair<string,double>> WaterSupplyManagement::affectedCitiesReservoir(const string& reservoirCode, vector<pair<string,double>> &previouslyAffected) {
+    Profiler::ScopedTimer timer("affectedCitiesReservoir", "resiliency");
     vector<pair<string,double>> res;
 
     //Values that will be used to restore the graph in the end
@@ -885,16 +2707,20 @@ vector<pair<string,double>> WaterSupplyManagement::affectedCitiesReservoir(const
     Vertex<string> *v = network.findVertex(reservoirCode);
     if(v == nullptr)
         return res;
+    //only the cities that can receive water from the reservoir can be affected
+    const ReachabilityIndex &index = getReachability();
     for(Edge<string> *e: v->getAdj()){
         weights.push_back(e->getWeight());
         e->setWeight(0);
     }
 
     //calculates the new flow (assumes that already exists a super_source and a super_sink)
-    edmondsKarp("super_source", "super_sink");
+    cachedMaxFlow();
 
     //verifies the cities with deficit and verifies if they were already with a deficit
-    for(pair<string, City> codeCity : codeToCity){
+    for(const string &code : cityCodes){
+        const pair<const string, City> &codeCity = *codeToCity.find(code);
+        if(!index.isDownstream(reservoirCode, codeCity.first)) continue;
         double deficit = flowDeficit(codeCity.first);
         if(deficit > 0){
             bool isPrevAffect = false;
@@ -925,26 +2751,56 @@ vector<pair<string,double>> WaterSupplyManagement::affectedCitiesReservoir(const
 
 
 /**
- * Gets the Cities that were affected (water supply not being met) by removing a given station.
+ * Gets the Cities that were affected (water supply not being met) by removing a given station or by reducing what it can pump
+ * to a fraction of its capacity (see stationCapacity).
  * Complexity: O(V E^2) where V is the number of vertexes and E is the number of edges of the graph.
  * @param stationCode Code of the station to be removed
  * @param previouslyAffected Vector with the code of the cities that were already with a water deficit before removing the reservoir and their flow
+ * @param remaining Fraction of the capacity the station keeps (0 removes it)
  * @return  Code of the cities that were affected by the removal of the reservoir.
  */
-std::vector<std::pair<std::string,double>> WaterSupplyManagement::affectedCitiesStations(const std::string& stationCode, const std::vector<std::pair<std::string,double>> &previouslyAffected){
+std::vector<std::pair<std::string,double>> WaterSupplyManagement::affectedCitiesStations(const std::string& stationCode, const std::vector<std::pair<std::string,double>> &previouslyAffected,
+                                                                                         double remaining){
+    Profiler::ScopedTimer timer("affectedCitiesStations", "resiliency");
     vector<std::pair<std::string,double>> res;
 
     Vertex<string>* station=network.findVertex(stationCode);
+    if(station == nullptr)
+        return res;
+
+    //only the cities that can receive water from the station can be affected (none: no need to solve again)
+    const ReachabilityIndex &index = getReachability();
+    if(index.downstreamCities(stationCode).empty())
+        return res;
+
+    //pipes that leave the station (outgoing and bidirectional incoming ones), closed if the station is removed
+    vector<Edge<string>*> pipes;
+    if(remaining <= 0){
+        pipes = station->getAdj();
+        for(Edge<string>* e: station->getIncoming()){
+            if(e->isBidirectional()) pipes.push_back(e);
+        }
+    }
     vector<double> weights;
-    for(Edge<string>* e: station->getAdj()){
+    for(Edge<string>* e: pipes){
         weights.push_back(e->getWeight());
         e->setWeight(0);
     }
 
-    edmondsKarp("super_source","super_sink");
+    //otherwise the station only pumps part of its capacity
+    double capacity = numeric_limits<double>::infinity();
+    auto search = codeToStation.find(stationCode);
+    if(remaining > 0 && search != codeToStation.end()){
+        capacity = search->second.getCapacity();
+        search->second.setCapacity(remaining * stationCapacity(stationCode));
+    }
+
+    cachedMaxFlow();
 
     //verifies the cities with deficit and verifies if they were already with a deficit
-    for(pair<string, City> codeCity : codeToCity){
+    for(const string &code : cityCodes){
+        const pair<const string, City> &codeCity = *codeToCity.find(code);
+        if(!index.isDownstream(stationCode, codeCity.first)) continue;
         double deficit = flowDeficit(codeCity.first);
         if(deficit > 0){
             bool prevAffected= false;
@@ -966,12 +2822,13 @@ std::vector<std::pair<std::string,double>> WaterSupplyManagement::affectedCities
         }
     }
 
-    //restores the Weights of the adj pipes
+    //restores the Weights of the pipes and the capacity of the station
     int i = 0;
-    for(Edge<string> *e: station->getAdj()){
+    for(Edge<string> *e: pipes){
         e->setWeight(weights.at(i));
         i++;
     }
+    if(remaining > 0 && search != codeToStation.end()) search->second.setCapacity(capacity);
 
     return res;
 }
@@ -986,35 +2843,34 @@ std::vector<std::pair<std::string,double>> WaterSupplyManagement::affectedCities
  * @return  foreach pipe that is crucial, returns the cities that affects by removing it and the deficit of each one.
  */
 vector<pair<string, double>> WaterSupplyManagement::crucialPipelines(const string &source, const string &dest,vector<pair<std::string,double>> &previouslyAffected) {
+    Profiler::ScopedTimer timer("crucialPipelines", "resiliency");
     vector<pair<string, double>> res;
-    bool bidirectional = false;
 
-    double weight = 0;
+    //Find the pipeline (bidirectional pipelines are a single edge, possibly stored from dest to source)
+    Edge<string> *pipe = findPipe(source, dest);
+    if (pipe == nullptr) return res;
 
-    for (auto vertex : network.getVertexSet()){
-        for (auto edge : vertex->getAdj()){
-            if (dest == edge->getDest()->getInfo() && source == edge->getOrig()->getInfo()) weight = edge->getWeight();
-        }
-    }
-
-    //Remove pipeline and check if its bidirectional and check for changes in cities
+    string orig = pipe->getOrig()->getInfo();
+    string destination = pipe->getDest()->getInfo();
+    bool bidirectional = pipe->isBidirectional();
+    double weight = pipe->getWeight();
 
-    network.removeEdge(source,dest);
+    //only the cities that can receive water through the pipe can be affected
+    const ReachabilityIndex &index = getReachability();
 
-    for (auto vertex : network.getVertexSet()){
-        for (auto edge : vertex->getAdj()){
-            if (source == edge->getDest()->getInfo() && dest == edge->getOrig()->getInfo()) bidirectional = true;
-        }
-    }
+    //Close the pipeline (no capacity, the same as removing it) and check for changes in cities.
+    //The edges keep their order, so the restored network has the same fingerprint as before (see fingerprint).
 
-    if (bidirectional) network.removeEdge(dest,source);
+    pipe->setWeight(0);
 
     //calculate new flow without pipeline
 
-    edmondsKarp("super_source", "super_sink");
+    cachedMaxFlow();
 
     //verifies the cities with deficit and verifies if they were already with a deficit
-    for(pair<string, City> codeCity : codeToCity){
+    for(const string &code : cityCodes){
+        const pair<const string, City> &codeCity = *codeToCity.find(code);
+        if(!index.isDownstream(destination, codeCity.first) && !(bidirectional && index.isDownstream(orig, codeCity.first))) continue;
         double deficit = flowDeficit(codeCity.first);
         if(deficit > 0){
             bool isPrevAffect = false;
@@ -1035,47 +2891,192 @@ vector<pair<string, double>> WaterSupplyManagement::crucialPipelines(const strin
 
 
 
-    //restore the pipeline that was removed
+    //restore the capacity of the pipeline
+
+    pipe->setWeight(weight);
+
+    return res;
+}
+
+/**
+ * Calculates the water delivered while a reservoir or a station keeps only part of its capacity (see DegradationCurve).
+ * The capacity of a reservoir is its maximum delivery, the one of a station is given by stationCapacity.
+ * The flows of the network are not changed.
+ * Complexity: O(V E^2) where V is the number of vertexes and E is the number of edges (one max flow and the flow it adds)
+ * @param code Code of the reservoir or station
+ * @return Curve of the delivered water (flat if there is no such reservoir or station)
+ */
+WaterSupplyManagement::DegradationCurve WaterSupplyManagement::degradationCurve(const std::string &code) {
+    Profiler::ScopedTimer timer("degradationCurve", "resiliency");
+    FlowCopy copy;
+    vector<uint32_t> element;
+    double capacity = 0;
+
+    auto reservoir = codeToReservoir.find(code);
+    auto station = codeToStation.find(code);
+    if(reservoir != codeToReservoir.end()){
+        copyToFlowNetwork(copy, 0);
+        auto search = lower_bound(copy.reservoirs.begin(), copy.reservoirs.end(), make_pair(code, uint32_t(0)));
+        if(search != copy.reservoirs.end() && search->first == code) element.push_back(search->second);
+        capacity = reservoir->second.getReservoirMaxDelivery();
+    }
+    else if(station != codeToStation.end() && network.findVertex(code) != nullptr){
+        //a station without a limit is split with the most its pipes can carry, which doesn't change the flow
+        double limit = station->second.getCapacity();
+        capacity = stationCapacity(code);
+        station->second.setCapacity(capacity);
+        copyToFlowNetwork(copy, 0);
+        station->second.setCapacity(limit);
+        auto search = lower_bound(copy.stations.begin(), copy.stations.end(), make_pair(code, uint32_t(0)));
+        if(search != copy.stations.end() && search->first == code) element.push_back(search->second);
+    }
+    else copyToFlowNetwork(copy, 0);
+
+    return solveDegradation(copy, element, capacity);
+}
+
+/**
+ * Calculates the water delivered while a pipe keeps only part of its capacity (see DegradationCurve).
+ * The flows of the network are not changed.
+ * Complexity: O(V E^2) where V is the number of vertexes and E is the number of edges (one max flow and the flow it adds)
+ * @param source Code of the origin of the pipe
+ * @param dest Code of the destination of the pipe
+ * @return Curve of the delivered water (flat if there is no such pipe)
+ */
+WaterSupplyManagement::DegradationCurve WaterSupplyManagement::degradationCurve(const std::string &source, const std::string &dest) {
+    Profiler::ScopedTimer timer("degradationCurve", "resiliency");
+    FlowCopy copy;
+    copyToFlowNetwork(copy, 0);
+
+    //the pipe and, if it was split in two directions, the one for the opposite direction
+    vector<uint32_t> element;
+    Edge<string> *e = findPipe(source, dest);
+    for(uint32_t pipe = 0; e != nullptr && pipe < copy.pipes.size(); pipe++){
+        if(copy.pipes[pipe] == e) element.push_back(pipe);
+    }
+    for(const auto &reverse : copy.reversePipes){
+        if(!element.empty() && reverse.first == element[0]) element.push_back(reverse.second);
+    }
+
+    return solveDegradation(copy, element, e == nullptr ? 0 : e->getWeight());
+}
+
+/**
+ * Finds the curve of the delivered water when the capacity of some pipes of a copy goes from 0 to a given capacity: one max flow
+ * without them, then the flow their capacity adds (augmenting paths from the first flow). Each path adds to the element
+ * at most the water it adds to the total, so the second flow also fits in the capacity of the breakpoint.
+ * Complexity: O(V E^2) where V is the number of vertexes and E is the number of edges
+ * @param copy Copy of the network (the cities' pipes get their demand)
+ * @param element Pipes of the copy whose capacity changes
+ * @param capacity Capacity of the element at 100%
+ * @return Curve of the delivered water
+ */
+WaterSupplyManagement::DegradationCurve WaterSupplyManagement::solveDegradation(FlowCopy &copy, const std::vector<uint32_t> &element, double capacity) {
+    DegradationCurve curve;
+    curve.capacity = capacity;
+    for(const auto &city : copy.cities){
+        auto search = codeToCity.find(city.first);
+        double demand = search == codeToCity.end() ? 0 : search->second.getDemand();
+        copy.flowNetwork.setCapacity(city.second, demand);
+        curve.cities.push_back(city.first);
+        curve.demand.push_back(demand);
+    }
+
+    FlowNetwork::Workspace ws;
+    for(uint32_t pipe : element) copy.flowNetwork.setCapacity(pipe, 0);
+    curve.zeroFlow = copy.flowNetwork.maxFlow(copy.source, copy.sink, ws);
+    for(const auto &city : copy.cities) curve.zeroDelivered.push_back(copy.flowNetwork.arcFlow(city.second, ws));
+
+    for(uint32_t pipe : element) copy.flowNetwork.setCapacity(pipe, capacity);
+    curve.fullFlow = curve.zeroFlow + copy.flowNetwork.augmentFlow(copy.source, copy.sink, ws);
+    for(const auto &city : copy.cities) curve.breakDelivered.push_back(copy.flowNetwork.arcFlow(city.second, ws));
 
-    network.addEdge(source,dest,weight);
+    curve.breakpoint = capacity > 0 ? min(1.0, (curve.fullFlow - curve.zeroFlow) / capacity) : 0;
+    return curve;
+}
 
-    if (bidirectional) network.addEdge(dest,source,weight);
+/**
+ * Gets the water delivered when the element keeps a fraction of its capacity.
+ * Complexity: O(1)
+ * @param remaining Fraction of the capacity (0 to 1)
+ * @return Delivered water
+ */
+double WaterSupplyManagement::DegradationCurve::flow(double remaining) const {
+    return min(fullFlow, zeroFlow + max(0.0, remaining) * capacity);
+}
 
+/**
+ * Gets the cities with a water deficit when the element keeps a fraction of its capacity.
+ * Complexity: O(c) where c is the number of cities
+ * @param remaining Fraction of the capacity (0 to 1)
+ * @return Code of each city with a deficit and its deficit
+ */
+std::vector<std::pair<std::string,double>> WaterSupplyManagement::DegradationCurve::deficits(double remaining) const {
+    const double EPS = 1e-9;
+    double t = remaining >= breakpoint ? 1 : max(0.0, remaining) / breakpoint;
+    vector<pair<string, double>> res;
+    for(size_t i = 0; i < cities.size(); i++){
+        double delivered = (1 - t) * zeroDelivered[i] + t * breakDelivered[i];
+        if(demand[i] - delivered > EPS) res.emplace_back(cities[i], demand[i] - delivered);
+    }
     return res;
 }
 
 //auxiliary metrics ==================================================================================
 /**
- * Calculates the average difference between the capacity and flow of each pipe.
+ * Calculates the average difference between the capacity and flow of each pipe (bidirectional pipes count once per direction).
  * Complexity: O(VE) where v is the number of vertexes (except the cities) and E is the number of edges
  * @return The average difference between the capacity and flow of each pipe
  */
 double WaterSupplyManagement::avgDiffPipes() {
-    int numPipes = 0;
-    double sumDiff = 0.0;
+    return pipeStats().average();
+}
 
-    //calculates the difference of the pipes that go from the reservoirs
-    for(pair<string,Reservoir> codeR : codeToReservoir){
-        Vertex<string> *v = network.findVertex(codeR.first);
-        for(Edge<string> *e : v->getAdj()){
-            numPipes++;
-            sumDiff += e->getWeight() - e->getFlow();
-        }
-    }
+/**
+ * Calculates the sum of the differences between the capacity and flow of the pipes that leave reservoirs and stations
+ * (bidirectional pipes count once per direction) and the number of differences.
+ * Complexity: O(VE) where v is the number of vertexes (except the cities) and E is the number of edges
+ * @return Differences of the pipes
+ */
+WaterSupplyManagement::PipeStats WaterSupplyManagement::pipeStats() const {
+    PipeStats stats;
 
-    //calculates the difference of the pipes that go from the stations
-    for(pair<string,Station> codeS : codeToStation){
-        Vertex<string> *v = network.findVertex(codeS.first);
-        for(Edge<string> *e : v->getAdj()){
-            numPipes++;
-            sumDiff += e->getWeight() - e->getFlow();
+    //calculates the difference of the pipes that go from the reservoirs and then from the stations
+    for(const vector<string> *codes : {&reservoirCodes, &stationCodes}){
+        for(const string &code : *codes){
+            Vertex<string> *v = network.findVertex(code);
+            if(v == nullptr) continue;
+            for(Edge<string> *e : v->getAdj()){
+                //one difference per direction for bidirectional pipes
+                stats.numPipes += e->isBidirectional() ? 2 : 1;
+                stats.sumDiff += pipeDiff(e, e->getFlow());
+            }
         }
     }
+    return stats;
+}
 
-    double avg = sumDiff/numPipes;
-
-    return avg;
+/**
+ * Gets the difference between the capacity and a flow of a pipe. A bidirectional pipe has one difference per direction,
+ * only one of them has flow.
+ * Complexity: O(1)
+ * @param e Pipe
+ * @param flow Flow of the pipe
+ * @return Difference (sum of both directions for bidirectional pipes)
+ */
+double WaterSupplyManagement::pipeDiff(const Edge<std::string> *e, double flow) {
+    return e->isBidirectional() ? 2 * e->getWeight() - std::abs(flow) : e->getWeight() - flow;
+}
 
+/**
+ * Checks if a pipe counts for the average difference (it leaves a reservoir or a station).
+ * Complexity: O(1)
+ * @param e Pipe
+ * @return True if the pipe counts, false otherwise
+ */
+bool WaterSupplyManagement::inPipeStats(const Edge<std::string> *e) {
+    VertexType type = e->getOrig()->getType();
+    return type == VertexType::RESERVOIR || type == VertexType::STATIONS;
 }
 
 /**
@@ -1087,21 +3088,25 @@ double WaterSupplyManagement::maxDiffPipes() {
     double maxDiff = 0.0;
 
     //calculates the difference of the pipes that go from the reservoirs
-    for(pair<string,Reservoir> codeR : codeToReservoir){
-        Vertex<string> *v = network.findVertex(codeR.first);
+    for(const string &code : reservoirCodes){
+        Vertex<string> *v = network.findVertex(code);
         for(Edge<string> *e : v->getAdj()){
-            if (e->getWeight() - e->getFlow() > maxDiff){
-                maxDiff = e->getWeight() - e->getFlow();
+            //the direction of a bidirectional pipe without flow has the biggest difference
+            double diff = e->isBidirectional() ? e->getWeight() : e->getWeight() - e->getFlow();
+            if (diff > maxDiff){
+                maxDiff = diff;
             }
         }
     }
 
     //calculates the difference of the pipes that go from the stations
-    for(pair<string,Station> codeS : codeToStation){
-        Vertex<string> *v = network.findVertex(codeS.first);
+    for(const string &code : stationCodes){
+        Vertex<string> *v = network.findVertex(code);
         for(Edge<string> *e : v->getAdj()){
-            if (e->getWeight() - e->getFlow() > maxDiff){
-                maxDiff = e->getWeight() - e->getFlow();
+            //the direction of a bidirectional pipe without flow has the biggest difference
+            double diff = e->isBidirectional() ? e->getWeight() : e->getWeight() - e->getFlow();
+            if (diff > maxDiff){
+                maxDiff = diff;
             }
         }
     }
@@ -11,6 +11,17 @@
 #include "Station.h"
 #include "City.h"
 #include "DataSetSelection.h"
+#include "MetricsFormat.h"
+#include "DistributionMode.h"
+#include "FlowSnapshot.h"
+#include "ReachabilityIndex.h"
+#include "DominatorTree.h"
+#include "FlowNetwork.h"
+#include "SolveCache.h"
+#include "EditJournal.h"
+#include "CompactNetwork.h"
+#include "ValidationReport.h"
+#include <memory>
 
 class WaterSupplyManagement {
     /**
@@ -22,12 +33,89 @@ class WaterSupplyManagement {
  * Stores a network graph and some unordered maps to help find the information related to each vertex.
  */
 public:
+    /**
+     * \struct StationLoad
+     * Water pumped by a station and the cost of pumping it (see stationPumpingLoad).
+     */
+    struct StationLoad {
+        std::string code;
+        double pumped;
+        double cost;
+    };
+
+    /**
+     * \struct MemoryReport
+     * Memory used by the model, in bytes (see memoryReport).
+     */
+    struct MemoryReport {
+        std::size_t numVertexes;
+        std::size_t vertexBytes;    // vertexes, their edge lists and the index of the vertexes
+        std::size_t numEdges;
+        std::size_t edgeBytes;
+        std::size_t numEntities;
+        std::size_t entityBytes;    // reservoirs, stations and cities (hash maps and ordered codes)
+        std::size_t compactBytes;   // the same network as a CompactNetwork (measured only, for comparison)
+    };
+
+    /**
+     * \struct PipeStats
+     * Sum of the differences between the capacity and flow of the pipes that leave reservoirs and stations, and the number of differences
+     * (see avgDiffPipes). Kept up to date move by move while balancing, so it can be computed once and passed to each regional balance.
+     */
+    struct PipeStats {
+        double sumDiff = 0;
+        std::size_t numPipes = 0;
+        double average() const { return sumDiff / numPipes; }
+    };
+
+    /**
+     * \struct PipeRecord
+     * A line of the pipes file, parsed but not yet added to the network (see parsePipes and addPipes).
+     */
+    struct PipeRecord {
+        std::string origin;
+        std::string destination;
+        double capacity = 0;
+        int direction = 1;
+        double cost = 0;
+        std::size_t line = 0;   // line of the file (0 if unknown)
+    };
+
+    /**
+     * \struct DegradationCurve
+     * Water delivered while a reservoir, station or pipe keeps only a fraction of its capacity (see degradationCurve).
+     * The max flow only grows with the capacity of one element, one unit per unit, until a cut without it is full, so the
+     * whole curve is given by its value without the element and its breakpoint. Each city gets the water of one of the
+     * max flows of that fraction (interpolated between the flows found without the element and at the breakpoint).
+     */
+    struct DegradationCurve {
+        double capacity = 0;                    // capacity of the element at 100%
+        double zeroFlow = 0;                    // water delivered without the element
+        double fullFlow = 0;                    // water delivered at 100%
+        double breakpoint = 0;                  // fraction of the capacity from which the delivered water doesn't grow
+        std::vector<std::string> cities;        // codes, sorted
+        std::vector<double> demand;
+        std::vector<double> zeroDelivered;      // water delivered to each city without the element
+        std::vector<double> breakDelivered;     // water delivered to each city at the breakpoint
+        double flow(double remaining) const;
+        std::vector<std::pair<std::string,double>> deficits(double remaining) const;
+    };
+
+    //version of the solvers' results, to be changed when they can give other flows for the same network (see SolveCache)
+    static const uint32_t SOLVER_VERSION = 1;
+
     WaterSupplyManagement()= default;
     //data readers
     void readReservoirs(DataSetSelection dataset);
     void readStations(DataSetSelection dataset);
     void readCities(DataSetSelection dataset);
-    void readPipes(DataSetSelection dataset);
+    void readPipes(DataSetSelection dataset, unsigned numThreads = 0);
+    std::vector<PipeRecord> readData(DataSetSelection dataset, unsigned numThreads = 0);
+    bool addCity(const City &city);
+    bool addReservoir(Reservoir reservoir);
+    bool addStation(Station station);
+    bool addPipe(const std::string &origCode, const std::string &destCode, double capacity, int direction, double cost = 0);
+    void addPipes(const std::vector<PipeRecord> &pipes);
 
     //data inserts and deletes (to help filter the network)
     bool insertReservoir(const std::string& code);
@@ -35,10 +123,24 @@ public:
     bool insertCity(const std::string& code);
     void insertAll();
     bool deletePipe(const std::string &source, const std::string &dest);
+    bool setPipeCapacity(const std::string &source, const std::string &dest, double capacity);
+    bool setStationCapacity(const std::string &code, double capacity);
+    double stationCapacity(const std::string &code) const;
+    Edge<std::string> *findPipe(const std::string &source, const std::string &dest) const;
 
     //System reset
     void resetSystem();
 
+    //Validation
+    ValidationReport validate(bool repair = false);
+
+    //Edit journal
+    bool undo();
+    bool redo();
+    bool rollback(std::size_t checkpoint);
+    void clearJournal();
+    const EditJournal &getJournal() const;
+
     //Getters
     void getCity(const std::string& code, City *city) const;
     void getReservoir(const std::string& code, Reservoir *reservoir) const;
@@ -46,7 +148,10 @@ public:
     std::unordered_map<std::string, Reservoir> getCodeToReservoir() const;
     std::unordered_map<std::string, Station> getCodeToStation() const;
     std::unordered_map<std::string, City> getCodeToCity() const;
-    Graph<std::string> getNetwork() const;
+    const std::vector<std::string> &getReservoirCodes() const;
+    const std::vector<std::string> &getStationCodes() const;
+    const std::vector<std::string> &getCityCodes() const;
+    const Graph<std::string> &getNetwork() const;
 
     //super nodes
     void createSuperSource();
@@ -56,40 +161,133 @@ public:
 
     //EdmundsKarp
     void edmondsKarp(const std::string& source, const std::string& target);
+    void edmondsKarpScaling(const std::string& source, const std::string& target);
 
     //Auxiliary Metrics
     double avgDiffPipes();
     double maxDiffPipes();
 
     //auxiliary functions to balance the network
-    Edge<std::string> *edgeWithTheMaxDiff(const std::vector<Edge<std::string>*>& adj);
-    Edge<std::string> *edgeWithTheMinDiff(const std::vector<Edge<std::string>*>& adj);
-    void resetFlowChanges(Vertex<std::string> *v, int flow);
-    bool flowAdd(Vertex<std::string> *v);
-    bool flowSub(Vertex<std::string> *v);
-    void resetPath();
-    void resetVisited();
+    Edge<std::string> *edgeWithTheMaxDiff(Vertex<std::string> *v, const TraversalWorkspace<std::string> &ws);
+    Edge<std::string> *edgeWithTheMinDiff(Vertex<std::string> *v, const TraversalWorkspace<std::string> &ws);
+    void resetFlowChanges(Vertex<std::string> *v, int flow, TraversalWorkspace<std::string> &ws);
+    void balanceVertex(Vertex<std::string> *v, PipeStats &stats, TraversalWorkspace<std::string> &ws);
+    int repeatableMoves(const std::vector<std::pair<Edge<std::string>*, Vertex<std::string>*>> &subPath,
+                        const std::vector<std::pair<Edge<std::string>*, Vertex<std::string>*>> &addPath, TraversalWorkspace<std::string> &ws);
+    int stationMoves(const std::vector<std::pair<Edge<std::string>*, Vertex<std::string>*>> &subPath,
+                     const std::vector<std::pair<Edge<std::string>*, Vertex<std::string>*>> &addPath) const;
+    static void limitRepeats(double value, double slope, bool strict, double &limit);
+    static void updatePipeStats(PipeStats &stats, const std::vector<std::pair<Edge<std::string>*, Vertex<std::string>*>> &steps, int flow);
+    static size_t numPipes(Vertex<std::string> *v);
+    std::vector<std::pair<Edge<std::string>*, Vertex<std::string>*>> pathSteps(Vertex<std::string> *v, const TraversalWorkspace<std::string> &ws);
+    void revertSteps(const std::vector<std::pair<Edge<std::string>*, Vertex<std::string>*>> &steps, int flow);
+    bool flowAdd(Vertex<std::string> *v, TraversalWorkspace<std::string> &ws);
+    bool flowSub(Vertex<std::string> *v, TraversalWorkspace<std::string> &ws);
 
 
     //Basic metrics
     double flowDeficit(const std::string& cityCode );
-    void networkBalance();
-    void storeMetricsToFile();
+    void networkBalance(unsigned int numThreads = 0);
+    void networkBalance(const std::vector<std::string> &region, unsigned int numThreads = 0);
+    void networkBalance(const std::vector<std::string> &region, PipeStats &stats, unsigned int numThreads = 0);
+    PipeStats pipeStats() const;
+    std::vector<std::string> changedVertexes(const FlowSnapshot &previous) const;
+    bool storeMetricsToFile(const std::string &filepath = "../Source_Code/metrics.csv", MetricsFormat format = MetricsFormat::CSV);
+    std::vector<std::pair<std::string, double>> isolatedCityCapacities(unsigned int numThreads = 0);
+    std::vector<std::pair<std::string, double>> fairAllocation();
+    std::vector<std::pair<std::string, double>> priorityAllocation();
+    double minCostAllocation();
+    void distributeWater(DistributionMode mode);
+    double operatingCost() const;
+    std::vector<StationLoad> stationPumpingLoad() const;
+
+    //Memory
+    MemoryReport memoryReport();
+
+    //Solve cache
+    uint64_t fingerprint(const std::string &scenario = "") const;
+    std::vector<double> edgeFlows() const;
+    bool setEdgeFlows(const std::vector<double> &flows);
+    void cachedMaxFlow();
+    SolveCache &getSolveCache();
+
+    //Published results (can be read from any thread)
+    std::shared_ptr<const FlowSnapshot> publishSnapshot();
+    std::shared_ptr<const FlowSnapshot> getSnapshot() const;
 
     //Reliability and Sensitivity
+    const ReachabilityIndex &getReachability();
+    const DominatorTree &getDominators();
 
     std::vector<std::pair<std::string,double>> affectedCitiesReservoir(const std::string& reservoirCode, std::vector<std::pair<std::string,double>> &previouslyAffected);
-    std::vector<std::pair<std::string,double>> affectedCitiesStations(const std::string& stationCode, const std::vector<std::pair<std::string,double>> &previouslyAffected);
+    std::vector<std::pair<std::string,double>> affectedCitiesStations(const std::string& stationCode, const std::vector<std::pair<std::string,double>> &previouslyAffected,
+                                                                      double remaining = 0);
     std::vector<std::pair<std::string, double>> crucialPipelines(const std::string &source, const std::string &dest,std::vector<std::pair<std::string,double>> &previouslyAffected);
+    DegradationCurve degradationCurve(const std::string &code);
+    DegradationCurve degradationCurve(const std::string &source, const std::string &dest);
 
 
 
     static void selectDataSet(DataSetSelection dataset, VertexType type, std::string *filepath);
+    static std::vector<City> parseCities(const std::string &filepath, ValidationReport *report = nullptr);
+    static std::vector<Reservoir> parseReservoirs(const std::string &filepath, ValidationReport *report = nullptr);
+    static std::vector<Station> parseStations(const std::string &filepath, ValidationReport *report = nullptr);
+    static std::vector<PipeRecord> parsePipes(const std::string &filepath, unsigned numThreads = 0, ValidationReport *report = nullptr);
 private:
+    /**
+     * \struct FlowCopy
+     * Copy of the network used by the FlowNetwork solvers (see copyToFlowNetwork).
+     */
+    struct FlowCopy {
+        FlowNetwork flowNetwork;
+        std::vector<uint32_t> node;                                 // node of each vertex (by index), UINT32_MAX for the super nodes
+        std::vector<uint32_t> outNode;                              // node the pipes leaving each vertex start from (see copyToFlowNetwork)
+        std::vector<Edge<std::string>*> pipes;                      // edge of each pipe of the copy
+        std::vector<std::pair<uint32_t, uint32_t>> reversePipes;    // bidirectional pipe split in two directions and the pipe for the opposite one
+        std::vector<std::pair<std::string, uint32_t>> reservoirs;   // code and pipe from the source, sorted by code
+        std::vector<std::pair<std::string, uint32_t>> cities;       // code and pipe to the sink, sorted by code
+        std::vector<std::pair<std::string, uint32_t>> stations;     // code and pipe joining the two nodes of each split station, sorted by code
+        uint32_t source = 0;
+        uint32_t sink = 0;
+    };
+
+    void copyToFlowNetwork(FlowCopy &copy, double cityCapacity, bool withCosts = false);
+    void applyFlows(const FlowCopy &copy, const FlowNetwork::Workspace &ws);
+    bool hasStationLimits() const;
+    void stationLimitedMaxFlow();
+    static double outflow(const Vertex<std::string> *v);
+    bool removePipe(Edge<std::string> *pipe);
+    DegradationCurve solveDegradation(FlowCopy &copy, const std::vector<uint32_t> &element, double capacity);
+    void topologyChanged();
+    bool applyAndRecord(const EditJournal::Edit &edit);
+    bool applyEdit(const EditJournal::Edit &edit);
+    void recordLoaded(bool added, VertexType file, std::size_t line, const std::string &code);
+    double balanceRegion(const std::vector<bool> &inRegion, unsigned int numThreads);
+    std::vector<uint32_t> pipeComponents() const;
+    static double pipeDiff(const Edge<std::string> *e, double flow);
+    static bool inPipeStats(const Edge<std::string> *e);
+
     Graph<std::string> network;
     std::unordered_map<std::string, Reservoir> codeToReservoir;
     std::unordered_map<std::string, Station> codeToStation;
     std::unordered_map<std::string, City> codeToCity;
+    //codes in the order they were added, every loop over the elements uses them so the results don't depend on the hash maps
+    std::vector<std::string> reservoirCodes;
+    std::vector<std::string> stationCodes;
+    std::vector<std::string> cityCodes;
+    std::shared_ptr<const FlowSnapshot> snapshot; //only accessed with std::atomic_load/std::atomic_store
+    ReachabilityIndex reachability;
+    bool reachabilityValid = false; //false when pipes or vertexes changed since the index was built
+    DominatorTree dominators;
+    bool dominatorsValid = false;
+    SolveCache solveCache;
+    EditJournal journal;
+    bool journaling = true;     // false while the data is loaded, only the edits of the user can be undone
+    //problems found while reading the files and where each element was read (see validate)
+    ValidationReport loadReport;
+    std::unordered_map<std::string, std::size_t> codeLines;
+    std::unordered_map<std::string, std::size_t> pipeLines;   // "origin,destination" -> line
+    std::vector<double> stationLimit;   // capacity of each vertex (by index) while balancing, empty if no station has a limit
 };
 
 
@@ -5,6 +5,19 @@
 
 #include <gtest/gtest.h>
 #include "WaterSupplyManagement.h"
+#include "MetricsExporter.h"
+#include "Profiler.h"
+#include "ReachabilityIndex.h"
+#include "SolveCache.h"
+#include <fstream>
+#include <cstdint>
+#include <random>
+#include <cmath>
+#include <thread>
+#include <atomic>
+#include <unordered_set>
+#include <map>
+#include <sstream>
 
 WaterSupplyManagement testSystem;
 
@@ -146,7 +159,8 @@ TEST(data_readers, readPipes){
         size += vertex->getAdj().size();
     }
 
-    EXPECT_EQ(size, 51);
+    //bidirectional pipes are a single edge
+    EXPECT_EQ(size, 42);
 
     Vertex<std::string> *v1 = testSystem.getNetwork().findVertex("R_1");
     Vertex<std::string> *v2 = testSystem.getNetwork().findVertex("PS_3");
@@ -164,11 +178,15 @@ TEST(data_readers, readPipes){
         }
     }
 
-    for(auto e : v3->getAdj()){
-        if(e->getDest()->getInfo() == "PS_3"){
+    bool found = false;
+    for(auto e : v3->getIncoming()){
+        if(e->getOrig()->getInfo() == "PS_3"){
+            EXPECT_TRUE(e->isBidirectional());
             EXPECT_EQ(e->getWeight(), 250);
+            found = true;
         }
     }
+    EXPECT_TRUE(found);
 }
 
 TEST(createSuper, createSuperSource){
@@ -298,14 +316,19 @@ TEST(graphResiliency, affectedCitiesReservoir){
     std::vector<std::pair<std::string, double>> previouslyAffected {std::make_pair("C_6",664)};
     std::vector<std::pair<std::string, double>> res = testSystem.affectedCitiesReservoir("R_4", previouslyAffected);
 
-    EXPECT_EQ(res.size(), 3);
+    //bidirectional pipes share their capacity, so the max-flow split (and which cities lose water) changed,
+    //the total deficit does not depend on the split
+    double totalDeficit = 0;
+    for(const auto &city : res) totalDeficit += city.second;
+    EXPECT_EQ(res.size(), 2);
+    EXPECT_EQ(totalDeficit, 574);
     EXPECT_EQ(testSystem.getNetwork().getVertexSet().size(), 28);
     EXPECT_EQ(w,testSystem.getNetwork().findVertex("R_4")->getAdj().at(0)->getWeight() );
 
     previouslyAffected = {std::make_pair("C_2",33)};
     res = testSystem.affectedCitiesReservoir("R_4", previouslyAffected);
 
-    EXPECT_EQ(res.size(), 3);
+    EXPECT_EQ(res.size(), 2);
 }
 
 TEST(resets, vertexreset){
@@ -417,4 +440,1829 @@ TEST(basicMetrics, rebalanceBig){
 
     EXPECT_EQ(avgFinal < avgInitial, true);
     EXPECT_EQ(difFinal <= difInitial, true);
-}
\ No newline at end of file
+}
+
+TEST(metricsExporter, citiesWithoutSuperSink){
+    cleanSystem();
+
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+
+    //no super sink, so the cities may have no outgoing edges
+    EXPECT_TRUE(testSystem.storeMetricsToFile("metrics_test.csv", MetricsFormat::CSV));
+    //a file that can't be created is reported
+    for(MetricsFormat format : {MetricsFormat::CSV, MetricsFormat::JSON, MetricsFormat::COLUMNAR}){
+        EXPECT_FALSE(testSystem.storeMetricsToFile("missing_directory/metrics_test.csv", format));
+    }
+
+    std::ifstream cities("metrics_test.csv");
+    std::ifstream pipes("metrics_test_pipes.csv");
+    std::ifstream reservoirs("metrics_test_reservoirs.csv");
+    std::string line;
+    int numCities = 0, numPipes = 0, numReservoirs = 0;
+    std::getline(cities, line);
+    EXPECT_EQ(line, "Code, Received water, Name, Id, Population, Demand");
+    while(std::getline(cities, line)) numCities++;
+    std::getline(pipes, line);
+    while(std::getline(pipes, line)) numPipes++;
+    std::getline(reservoirs, line);
+    while(std::getline(reservoirs, line)) numReservoirs++;
+    cities.close();
+    pipes.close();
+    reservoirs.close();
+    std::remove("metrics_test.csv");
+    std::remove("metrics_test_pipes.csv");
+    std::remove("metrics_test_reservoirs.csv");
+
+    EXPECT_EQ(numCities, 10);
+    EXPECT_EQ(numPipes, 42);
+    EXPECT_EQ(numReservoirs, 4);
+}
+
+TEST(metricsExporter, bidirectionalPipes){
+    cleanSystem();
+    //R_A (10) = C_1 (demand 6), stored with the city as the origin, and R_A -> C_2 (demand 4)
+    testSystem.addReservoir(Reservoir("A", "A", 1, "R_A", 10));
+    testSystem.addCity(City("C1", 1, "C_1", 6, 100));
+    testSystem.addCity(City("C2", 2, "C_2", 4, 100));
+    testSystem.insertAll();
+    testSystem.addPipe("C_1", "R_A", 10, 0);
+    testSystem.addPipe("R_A", "C_2", 10, 1);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+    testSystem.edmondsKarp("super_source", "super_sink");
+    ASSERT_NEAR(testSystem.findPipe("C_1", "R_A")->getFlow(), -6, 1e-6);
+
+    ASSERT_TRUE(testSystem.storeMetricsToFile("metrics_bidirectional.csv", MetricsFormat::CSV));
+    std::map<std::string, double> water;
+    for(const char *path : {"metrics_bidirectional.csv", "metrics_bidirectional_reservoirs.csv"}){
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        while(std::getline(file, line)){
+            std::stringstream fields(line);
+            std::string code, value;
+            std::getline(fields, code, ',');
+            std::getline(fields, value, ',');
+            water[code] = std::stod(value);
+        }
+        file.close();
+    }
+    for(const char *path : {"metrics_bidirectional.csv", "metrics_bidirectional_pipes.csv", "metrics_bidirectional_reservoirs.csv"}){
+        std::remove(path);
+    }
+
+    EXPECT_NEAR(water["C_1"], 6, 1e-6);
+    EXPECT_NEAR(water["C_2"], 4, 1e-6);
+    EXPECT_NEAR(water["R_A"], 10, 1e-6);
+}
+
+TEST(metricsExporter, columnarChunks){
+    {
+        MetricsExporter exporter("metrics_test.wsmc", MetricsFormat::COLUMNAR, 3);
+        exporter.beginTable("values", {"Name", "Value"}, {MetricsExporter::ColumnType::TEXT, MetricsExporter::ColumnType::NUMBER});
+        for(int i = 0; i < 7; i++){
+            exporter.addText("v" + std::to_string(i));
+            exporter.addNumber(i * 1.5);
+            exporter.endRow();
+        }
+    }
+
+    std::ifstream file("metrics_test.wsmc", std::ios::binary);
+    char magic[4];
+    uint32_t version, size, numColumns;
+    file.read(magic, 4);
+    file.read(reinterpret_cast<char *>(&version), sizeof(version));
+    EXPECT_EQ(std::string(magic, 4), "WSMC");
+    EXPECT_EQ(version, 1);
+
+    file.read(reinterpret_cast<char *>(&size), sizeof(size));
+    std::string name(size, ' ');
+    file.read(&name[0], size);
+    EXPECT_EQ(name, "values");
+    file.read(reinterpret_cast<char *>(&numColumns), sizeof(numColumns));
+    EXPECT_EQ(numColumns, 2);
+    for(uint32_t i = 0; i < numColumns; i++){
+        uint8_t type;
+        file.read(reinterpret_cast<char *>(&type), sizeof(type));
+        file.read(reinterpret_cast<char *>(&size), sizeof(size));
+        file.ignore(size);
+    }
+
+    //chunks of 3, 3 and 1 rows followed by the end of the table
+    std::vector<uint32_t> chunks;
+    std::vector<double> values;
+    while(true){
+        uint32_t rows;
+        file.read(reinterpret_cast<char *>(&rows), sizeof(rows));
+        if(!file || rows == 0) break;
+        chunks.push_back(rows);
+        for(uint32_t i = 0; i < rows; i++){
+            file.read(reinterpret_cast<char *>(&size), sizeof(size));
+            file.ignore(size);
+        }
+        for(uint32_t i = 0; i < rows; i++){
+            double value;
+            file.read(reinterpret_cast<char *>(&value), sizeof(value));
+            values.push_back(value);
+        }
+    }
+    file.close();
+    std::remove("metrics_test.wsmc");
+
+    EXPECT_EQ(chunks, std::vector<uint32_t>({3, 3, 1}));
+    ASSERT_EQ(values.size(), 7);
+    EXPECT_EQ(values.at(6), 9);
+}
+
+TEST(profiler, countersAndTimers){
+    Profiler::reset();
+    Profiler::setEnabled(true);
+    cleanSystem();
+
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+    testSystem.edmondsKarp("super_source", "super_sink");
+    Profiler::setEnabled(false);
+
+    //12 stations + 4 reservoirs + 10 cities + 42 pipes
+    EXPECT_EQ(Profiler::getCount(ProfilerCounter::CSV_LINES_READ), 68);
+    EXPECT_GT(Profiler::getCount(ProfilerCounter::AUGMENTING_PATHS), 0);
+    EXPECT_EQ(Profiler::getCount(ProfilerCounter::BFS_SEARCHES), Profiler::getCount(ProfilerCounter::AUGMENTING_PATHS) + 1);
+    EXPECT_GT(Profiler::getCount(ProfilerCounter::EDGES_SCANNED), 0);
+    EXPECT_GE(Profiler::getTotalTime("edmondsKarp"), 0);
+    EXPECT_TRUE(Profiler::dumpJson("profile_test.json"));
+    EXPECT_TRUE(Profiler::dumpChromeTrace("profile_test_trace.json"));
+    for(const char *path : {"profile_test.json", "profile_test_trace.json"}){
+        std::ifstream file(path);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        EXPECT_FALSE(content.empty());
+        EXPECT_NE(content.find("edmondsKarp"), std::string::npos);
+        file.close();
+        std::remove(path);
+    }
+
+    //disabled profiler doesn't count
+    uint64_t paths = Profiler::getCount(ProfilerCounter::AUGMENTING_PATHS);
+    testSystem.edmondsKarp("super_source", "super_sink");
+    EXPECT_EQ(Profiler::getCount(ProfilerCounter::AUGMENTING_PATHS), paths);
+    Profiler::reset();
+}
+
+/**
+ * Builds a layered synthetic network (reservoirs -> layers of stations -> cities) with capacities spread
+ * between 1 and 10^4 (log-uniform), with the super source and super sink already created.
+ */
+void buildWideRangeNetwork(WaterSupplyManagement &system, int numReservoirs, int layers, int width, int numCities, unsigned seed){
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> exponent(0, 4);
+    std::uniform_int_distribution<int> pick(0, width - 1);
+    auto capacity = [&](){ return std::round(std::pow(10, exponent(gen))); };
+
+    for(int i = 1; i <= numReservoirs; i++){
+        system.addReservoir(Reservoir("R" + std::to_string(i), "M", i, "R_" + std::to_string(i), capacity()));
+    }
+    for(int l = 0; l < layers; l++){
+        for(int i = 0; i < width; i++){
+            int id = l * width + i + 1;
+            system.addStation(Station("PS_" + std::to_string(id), id));
+        }
+    }
+    for(int i = 1; i <= numCities; i++){
+        system.addCity(City("City" + std::to_string(i), i, "C_" + std::to_string(i), (int) capacity(), 1000));
+    }
+    system.insertAll();
+
+    auto station = [&](int layer, int i){ return "PS_" + std::to_string(layer * width + i + 1); };
+    for(int i = 1; i <= numReservoirs; i++){
+        for(int k = 0; k < 3; k++) system.addPipe("R_" + std::to_string(i), station(0, pick(gen)), capacity(), 1);
+    }
+    for(int l = 0; l + 1 < layers; l++){
+        for(int i = 0; i < width; i++){
+            for(int k = 0; k < 3; k++) system.addPipe(station(l, i), station(l + 1, pick(gen)), capacity(), k == 0 ? 0 : 1);
+        }
+    }
+    for(int i = 1; i <= numCities; i++){
+        for(int k = 0; k < 3; k++) system.addPipe(station(layers - 1, pick(gen)), "C_" + std::to_string(i), capacity(), 1);
+    }
+    system.createSuperSource();
+    system.createSuperSink();
+}
+
+/**
+ * Sum of the flow that reaches the super sink.
+ */
+double totalFlow(const WaterSupplyManagement &system){
+    double total = 0;
+    for(auto e : system.getNetwork().findVertex("super_sink")->getIncoming()){
+        total += e->getFlow();
+    }
+    return total;
+}
+
+TEST(edmundsKarp, scalingSmall){
+    cleanSystem();
+
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+
+    testSystem.edmondsKarp("super_source", "super_sink");
+    double plainFlow = totalFlow(testSystem);
+
+    //the split between cities may differ, the maximum flow doesn't
+    testSystem.edmondsKarpScaling("super_source", "super_sink");
+    EXPECT_EQ(totalFlow(testSystem), plainFlow);
+}
+
+TEST(edmundsKarp, scalingBenchmarkWideRange){
+    cleanSystem();
+    buildWideRangeNetwork(testSystem, 20, 8, 40, 30, 7);
+
+    Profiler::reset();
+    Profiler::setEnabled(true);
+
+    testSystem.edmondsKarp("super_source", "super_sink");
+    double plainFlow = totalFlow(testSystem);
+    uint64_t plainPaths = Profiler::getCount(ProfilerCounter::AUGMENTING_PATHS);
+
+    testSystem.edmondsKarpScaling("super_source", "super_sink");
+    double scalingFlow = totalFlow(testSystem);
+    uint64_t scalingPaths = Profiler::getCount(ProfilerCounter::AUGMENTING_PATHS) - plainPaths;
+
+    Profiler::setEnabled(false);
+    Profiler::reset();
+
+    EXPECT_EQ(plainFlow, scalingFlow);
+    EXPECT_GT(scalingFlow, 0);
+    //with capacities over a wide range the scaling phases need fewer augmenting paths
+    EXPECT_GT(scalingPaths, 0);
+    EXPECT_LT(scalingPaths, plainPaths);
+}
+
+TEST(flowSnapshot, matchesSolvedNetwork){
+    cleanSystem();
+
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+    testSystem.edmondsKarp("super_source", "super_sink");
+
+    EXPECT_EQ(testSystem.getSnapshot(), nullptr);
+    std::shared_ptr<const FlowSnapshot> snapshot = testSystem.publishSnapshot();
+    EXPECT_EQ(snapshot->getEpoch(), 1);
+    EXPECT_EQ(testSystem.getSnapshot(), snapshot);
+    EXPECT_EQ(snapshot->getTotalFlow(), totalFlow(testSystem));
+    EXPECT_EQ(snapshot->getPipes().size(), 42);
+
+    for(const auto &codeCity : testSystem.getCodeToCity()){
+        EXPECT_EQ(snapshot->flowDeficit(codeCity.first), testSystem.flowDeficit(codeCity.first));
+    }
+    Edge<std::string> *pipe = testSystem.findPipe("PS_4", "PS_5");
+    ASSERT_NE(pipe, nullptr);
+    ASSERT_TRUE(pipe->isBidirectional());
+    EXPECT_EQ(snapshot->pipeFlow(pipe->getOrig()->getInfo(), pipe->getDest()->getInfo()), pipe->getFlow());
+    EXPECT_EQ(snapshot->pipeFlow(pipe->getDest()->getInfo(), pipe->getOrig()->getInfo()), -pipe->getFlow());
+
+    //the published results don't change with the network
+    double deficit = snapshot->flowDeficit("C_6");
+    std::vector<std::pair<std::string, double>> previouslyAffected;
+    testSystem.affectedCitiesReservoir("R_4", previouslyAffected);
+    EXPECT_EQ(snapshot->flowDeficit("C_6"), deficit);
+    EXPECT_EQ(testSystem.publishSnapshot()->getEpoch(), 2);
+}
+
+TEST(flowSnapshot, concurrentReaders){
+    cleanSystem();
+
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+    testSystem.edmondsKarp("super_source", "super_sink");
+    testSystem.publishSnapshot();
+
+    std::atomic<bool> done(false);
+    std::atomic<int> inconsistent(0);
+    std::atomic<long> reads(0);
+    std::vector<std::thread> readers;
+    for(int i = 0; i < 4; i++){
+        readers.emplace_back([&](){
+            uint64_t lastEpoch = 0;
+            while(!done.load()){
+                std::shared_ptr<const FlowSnapshot> snapshot = testSystem.getSnapshot();
+                double total = 0;
+                for(const auto &city : snapshot->getCities()){
+                    total += city.demand - snapshot->flowDeficit(city.code);
+                }
+                if(total != snapshot->getTotalFlow() || snapshot->getEpoch() < lastEpoch) inconsistent++;
+                lastEpoch = snapshot->getEpoch();
+                reads++;
+            }
+        });
+    }
+
+    //the writer keeps solving and publishing while the readers query
+    for(int i = 0; i < 20; i++){
+        if(i % 2 == 0) testSystem.edmondsKarpScaling("super_source", "super_sink");
+        else testSystem.edmondsKarp("super_source", "super_sink");
+        testSystem.publishSnapshot();
+    }
+    done = true;
+    for(std::thread &reader : readers) reader.join();
+
+    EXPECT_EQ(inconsistent.load(), 0);
+    EXPECT_GT(reads.load(), 0);
+    EXPECT_EQ(testSystem.getSnapshot()->getEpoch(), 21);
+}
+
+TEST(traversalWorkspace, resetIsIndependentOfTheGraph){
+    Graph<int> g;
+    for(int i = 0; i < 5; i++) g.addVertex(i, VertexType::STATIONS);
+    g.addEdge(0, 1, 1);
+    g.addEdge(1, 2, 1);
+    Edge<int> *e = g.findVertex(1)->getAdj().at(0);
+
+    TraversalWorkspace<int> ws(g.getNumVertex());
+    Vertex<int> *v = g.findVertex(2);
+    ws.setVisited(v, true);
+    ws.setPath(v, e);
+    ws.setIndegree(v, 3);
+    EXPECT_TRUE(ws.isVisited(v));
+    EXPECT_EQ(ws.getPath(v), e);
+    EXPECT_EQ(ws.getIndegree(v), 3);
+
+    ws.reset(g.getNumVertex());
+    EXPECT_FALSE(ws.isVisited(v));
+    EXPECT_EQ(ws.getPath(v), nullptr);
+    EXPECT_EQ(ws.getIndegree(v), 0);
+
+    //indexes are kept consistent when a vertex is removed
+    g.removeVertex(0);
+    for(unsigned i = 0; i < g.getVertexSet().size(); i++){
+        EXPECT_EQ(g.getVertexSet()[i]->getIndex(), i);
+    }
+}
+
+TEST(traversalWorkspace, concurrentTraversals){
+    //layered DAG: every vertex of a layer goes to every vertex of the next one
+    Graph<int> g;
+    const int layers = 50, width = 20;
+    for(int i = 0; i < layers * width; i++) g.addVertex(i, VertexType::STATIONS);
+    for(int l = 0; l + 1 < layers; l++){
+        for(int a = 0; a < width; a++){
+            for(int b = 0; b < width; b++) g.addEdge(l * width + a, (l + 1) * width + b, 1);
+        }
+    }
+
+    std::vector<int> expectedDfs = g.dfs();
+    std::vector<int> expectedTopsort = g.topsort();
+    ASSERT_EQ(expectedDfs.size(), layers * width);
+    ASSERT_EQ(expectedTopsort.size(), layers * width);
+
+    //traversals no longer write to the vertexes, so they can run at the same time
+    std::atomic<int> mismatches(0);
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; t++){
+        threads.emplace_back([&](){
+            for(int i = 0; i < 20; i++){
+                if(g.dfs() != expectedDfs) mismatches++;
+                if(g.topsort() != expectedTopsort) mismatches++;
+                if(!g.isDAG()) mismatches++;
+            }
+        });
+    }
+    for(std::thread &thread : threads) thread.join();
+    EXPECT_EQ(mismatches.load(), 0);
+}
+
+/**
+ * Recursive dfs (the previous implementation of Graph::dfsVisit), used as reference for the iterative one.
+ */
+template <class T>
+void recursiveDfsVisit(Vertex<T> *v, std::unordered_set<Vertex<T> *> &visited, std::vector<T> &res){
+    visited.insert(v);
+    res.push_back(v->getInfo());
+    for(auto e : v->getAdj()){
+        if(!visited.count(e->getDest())) recursiveDfsVisit(e->getDest(), visited, res);
+    }
+    for(auto e : v->getIncoming()){
+        if(e->isBidirectional() && !visited.count(e->getOrig())) recursiveDfsVisit(e->getOrig(), visited, res);
+    }
+}
+
+template <class T>
+std::vector<T> recursiveDfs(const Graph<T> &g){
+    std::unordered_set<Vertex<T> *> visited;
+    std::vector<T> res;
+    for(auto v : g.getVertexSet()){
+        if(!visited.count(v)) recursiveDfsVisit(v, visited, res);
+    }
+    return res;
+}
+
+TEST(iterativeDfs, sameOrderAsRecursive){
+    std::mt19937 rng(11);
+    Graph<int> g;
+    const int n = 2000;
+    for(int i = 0; i < n; i++) g.addVertex(i, VertexType::STATIONS);
+    for(int i = 0; i < 3 * n; i++){
+        int a = rng() % n, b = rng() % n;
+        if(a == b) continue;
+        //only forward edges, so the graph is a DAG
+        if(a < b) g.addEdge(a, b, 1);
+        else g.addEdge(b, a, 1);
+    }
+    EXPECT_EQ(g.dfs(), recursiveDfs(g));
+    EXPECT_TRUE(g.isDAG());
+    EXPECT_EQ(g.topsort().size(), n);
+
+    //a back edge makes a cycle
+    g.addEdge(n - 1, 0, 1);
+    g.addEdge(0, n - 1, 1);
+    EXPECT_FALSE(g.isDAG());
+    EXPECT_TRUE(g.topsort().empty());
+    EXPECT_EQ(g.dfs(), recursiveDfs(g));
+
+    //undirected edges are followed both ways
+    g.addUndirectedEdge(5, 3, 1);
+    g.addUndirectedEdge(n - 2, 1, 1);
+    EXPECT_EQ(g.dfs(), recursiveDfs(g));
+    EXPECT_EQ(g.dfs(7), g.dfs(7));
+}
+
+TEST(iterativeDfs, millionVertexChain){
+    Graph<int> g;
+    const int n = 1000000;
+    for(int i = 0; i < n; i++) g.addVertex(i, VertexType::STATIONS);
+    for(int i = 0; i + 1 < n; i++) g.addEdge(i, i + 1, 1);
+
+    std::vector<int> order = g.dfs(0);
+    bool dag = g.isDAG();
+    std::vector<int> topsort = g.topsort();
+
+    ASSERT_EQ(order.size(), n);
+    ASSERT_EQ(topsort.size(), n);
+    for(int i = 0; i < n; i++){
+        ASSERT_EQ(order[i], i);
+        ASSERT_EQ(topsort[i], i);
+    }
+    EXPECT_TRUE(dag);
+
+    //same order as the recursive version on a chain it can still handle
+    Graph<int> small;
+    const int m = 10000;
+    for(int i = 0; i < m; i++) small.addVertex(i, VertexType::STATIONS);
+    for(int i = 0; i + 1 < m; i++) small.addEdge(i, i + 1, 1);
+
+    //and compared with it on the profiler timers: the frames hold the vertex's own edge lists, so nothing is copied per level
+    Profiler::reset();
+    Profiler::setEnabled(true);
+    std::vector<int> recursive, iterative;
+    for(int i = 0; i < 20; i++){
+        Profiler::ScopedTimer timer("recursiveDfs", "benchmark");
+        recursive = recursiveDfs(small);
+    }
+    for(int i = 0; i < 20; i++){
+        Profiler::ScopedTimer timer("iterativeDfs", "benchmark");
+        iterative = small.dfs();
+    }
+    Profiler::setEnabled(false);
+    double recursiveMs = Profiler::getTotalTime("recursiveDfs");
+    double iterativeMs = Profiler::getTotalTime("iterativeDfs");
+    Profiler::reset();
+
+    ASSERT_EQ(iterative.size(), m);
+    EXPECT_EQ(iterative, recursive);
+    EXPECT_GT(recursiveMs, 0);
+    EXPECT_LT(iterativeMs, recursiveMs);
+}
+
+TEST(reachability, stronglyConnectedComponents){
+    Graph<int> g;
+    for(int i = 0; i < 7; i++) g.addVertex(i, VertexType::STATIONS);
+    //0 -> 1 -> 2 -> 0 is a cycle, 3 - 4 is a bidirectional pipe, 5 and 6 are alone
+    g.addEdge(0, 1, 1);
+    g.addEdge(1, 2, 1);
+    g.addEdge(2, 0, 1);
+    g.addEdge(2, 3, 1);
+    g.addUndirectedEdge(3, 4, 1);
+    g.addEdge(4, 5, 1);
+
+    std::vector<unsigned int> component;
+    EXPECT_EQ(g.scc(component), 4);
+    EXPECT_EQ(component[0], component[1]);
+    EXPECT_EQ(component[1], component[2]);
+    EXPECT_EQ(component[3], component[4]);
+    EXPECT_NE(component[2], component[3]);
+    EXPECT_NE(component[4], component[5]);
+    //a component reaches only components with smaller numbers
+    EXPECT_GT(component[0], component[3]);
+    EXPECT_GT(component[3], component[5]);
+}
+
+TEST(reachability, matchesSearch){
+    cleanSystem();
+
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+
+    const ReachabilityIndex &index = testSystem.getReachability();
+    const Graph<std::string> &network = testSystem.getNetwork();
+
+    //every element is compared with a search from it (super nodes not included)
+    for(Vertex<std::string> *v : network.getVertexSet()){
+        if(v->getType() == VertexType::SUPERSOURCE || v->getType() == VertexType::SUPERSINK) continue;
+        std::unordered_set<std::string> reached;
+        std::vector<Vertex<std::string> *> stack {v};
+        reached.insert(v->getInfo());
+        while(!stack.empty()){
+            Vertex<std::string> *u = stack.back();
+            stack.pop_back();
+            std::vector<Vertex<std::string> *> next;
+            for(auto e : u->getAdj()) next.push_back(e->getDest());
+            for(auto e : u->getIncoming()) if(e->isBidirectional()) next.push_back(e->getOrig());
+            for(auto w : next){
+                if(w->getType() == VertexType::SUPERSINK || reached.count(w->getInfo())) continue;
+                reached.insert(w->getInfo());
+                stack.push_back(w);
+            }
+        }
+        for(const auto &codeCity : testSystem.getCodeToCity()){
+            EXPECT_EQ(index.isDownstream(v->getInfo(), codeCity.first), reached.count(codeCity.first) == 1);
+            if(v->getType() == VertexType::RESERVOIR){
+                std::vector<std::string> suppliers = index.suppliers(codeCity.first);
+                bool isSupplier = std::find(suppliers.begin(), suppliers.end(), v->getInfo()) != suppliers.end();
+                EXPECT_EQ(isSupplier, reached.count(codeCity.first) == 1);
+            }
+        }
+    }
+
+    //bidirectional pipes join stations in the same component
+    Edge<std::string> *pipe = testSystem.findPipe("PS_4", "PS_5");
+    ASSERT_NE(pipe, nullptr);
+    EXPECT_TRUE(index.sameComponent("PS_4", "PS_5"));
+    EXPECT_LT(index.getNumComponents(), network.getNumVertex());
+
+    //the index is built again after the network changes
+    //(a pipe from a city back to a reservoir makes a cycle through the whole network)
+    unsigned int components = index.getNumComponents();
+    testSystem.addPipe("C_1", "R_1", 1, 1);
+    ReachabilityIndex fresh;
+    fresh.build(testSystem.getNetwork());
+    EXPECT_LT(fresh.getNumComponents(), components);
+    EXPECT_EQ(testSystem.getReachability().getNumComponents(), fresh.getNumComponents());
+}
+
+/**
+ * Checks if a city can be reached from the reservoirs without going through a vertex or a pipe (brute force reference for the dominator tree).
+ */
+bool reachableWithout(const Graph<std::string> &network, const std::string &city, const std::string &skipVertex, const Edge<std::string> *skipPipe){
+    std::unordered_set<std::string> reached;
+    std::vector<Vertex<std::string> *> stack;
+    for(Vertex<std::string> *v : network.getVertexSet()){
+        if(v->getType() == VertexType::RESERVOIR && v->getInfo() != skipVertex){
+            reached.insert(v->getInfo());
+            stack.push_back(v);
+        }
+    }
+    while(!stack.empty()){
+        Vertex<std::string> *u = stack.back();
+        stack.pop_back();
+        std::vector<Vertex<std::string> *> next;
+        for(auto e : u->getAdj()) if(e != skipPipe) next.push_back(e->getDest());
+        for(auto e : u->getIncoming()) if(e != skipPipe && e->isBidirectional()) next.push_back(e->getOrig());
+        for(auto w : next){
+            if(w->getType() == VertexType::SUPERSINK || w->getInfo() == skipVertex || reached.count(w->getInfo())) continue;
+            reached.insert(w->getInfo());
+            stack.push_back(w);
+        }
+    }
+    return reached.count(city) == 1;
+}
+
+TEST(dominatorTree, singlePointsOfFailure){
+    cleanSystem();
+    //R_A -> S_1 -> C_1, S_1 -> S_2 -> C_2, R_B -> S_2, S_2 = S_3 (bidirectional) -> C_3
+    testSystem.addReservoir(Reservoir("A", "A", 1, "R_A", 10));
+    testSystem.addReservoir(Reservoir("B", "B", 2, "R_B", 10));
+    for(int i = 1; i <= 3; i++){
+        testSystem.addStation(Station("S_" + std::to_string(i), i));
+        testSystem.addCity(City("C" + std::to_string(i), i, "C_" + std::to_string(i), 5, 100));
+    }
+    testSystem.insertAll();
+    testSystem.addPipe("R_A", "S_1", 10, 1);
+    testSystem.addPipe("S_1", "C_1", 10, 1);
+    testSystem.addPipe("S_1", "S_2", 10, 1);
+    testSystem.addPipe("R_B", "S_2", 10, 1);
+    testSystem.addPipe("S_2", "C_2", 10, 1);
+    testSystem.addPipe("S_3", "S_2", 10, 0);
+    testSystem.addPipe("S_3", "C_3", 10, 1);
+
+    const DominatorTree &dominators = testSystem.getDominators();
+    EXPECT_TRUE(dominators.dominates("S_1", "C_1"));
+    EXPECT_TRUE(dominators.dominates("R_A", "C_1"));
+    EXPECT_FALSE(dominators.dominates("S_1", "C_2"));
+    EXPECT_TRUE(dominators.dominates("S_2", "C_3"));
+    EXPECT_TRUE(dominators.pipeDominates("S_2", "S_3", "C_3"));
+    EXPECT_TRUE(dominators.pipeDominates("S_3", "S_2", "C_3"));
+    EXPECT_FALSE(dominators.pipeDominates("S_3", "C_3", "C_2"));
+    EXPECT_EQ(dominators.criticalStations("C_3"), std::vector<std::string>({"S_3", "S_2"}));
+    EXPECT_EQ(dominators.criticalPipes("C_3").size(), 2);
+    std::vector<std::string> disconnected = dominators.disconnectedCities("S_2");
+    std::sort(disconnected.begin(), disconnected.end());
+    EXPECT_EQ(disconnected, std::vector<std::string>({"C_2", "C_3"}));
+    EXPECT_EQ(dominators.disconnectedCities("S_1", "C_1"), std::vector<std::string>({"C_1"}));
+}
+
+TEST(dominatorTree, matchesRemoval){
+    cleanSystem();
+
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+
+    const DominatorTree &dominators = testSystem.getDominators();
+    const Graph<std::string> &network = testSystem.getNetwork();
+
+    //every station and every pipe is compared with removing it and searching from the reservoirs
+    for(const auto &codeCity : testSystem.getCodeToCity()){
+        bool reachable = reachableWithout(network, codeCity.first, "", nullptr);
+        EXPECT_EQ(dominators.isReachable(codeCity.first), reachable);
+        if(!reachable) continue;
+
+        for(const auto &codeStation : testSystem.getCodeToStation()){
+            EXPECT_EQ(dominators.dominates(codeStation.first, codeCity.first),
+                      !reachableWithout(network, codeCity.first, codeStation.first, nullptr));
+        }
+        for(Vertex<std::string> *v : network.getVertexSet()){
+            if(v->getType() == VertexType::SUPERSOURCE) continue;
+            for(Edge<std::string> *e : v->getAdj()){
+                if(e->getDest()->getType() == VertexType::SUPERSINK) continue;
+                EXPECT_EQ(dominators.pipeDominates(v->getInfo(), e->getDest()->getInfo(), codeCity.first),
+                          !reachableWithout(network, codeCity.first, "", e));
+            }
+        }
+    }
+}
+
+TEST(isolatedCapacities, matchesPerCityMaxFlow){
+    cleanSystem();
+
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+
+    std::vector<std::pair<std::string, double>> capacities = testSystem.isolatedCityCapacities(4);
+    EXPECT_EQ(capacities.size(), testSystem.getCodeToCity().size());
+    EXPECT_TRUE(std::is_sorted(capacities.begin(), capacities.end()));
+    EXPECT_EQ(testSystem.isolatedCityCapacities(1), capacities);
+
+    //each city compared with a max flow that ends on it
+    for(const auto &codeCapacity : capacities){
+        testSystem.edmondsKarp("super_source", codeCapacity.first);
+        double demand = testSystem.getCodeToCity().find(codeCapacity.first)->second.getDemand();
+        EXPECT_NEAR(codeCapacity.second, demand - testSystem.flowDeficit(codeCapacity.first), 1e-6);
+    }
+}
+
+TEST(fairAllocation, sharesTheDeficit){
+    cleanSystem();
+    //R_A (10) -> S_1 -> C_1 (demand 10) and C_2 (demand 30), R_B (20) -> C_3 (demand 10) through a pipe of 4
+    testSystem.addReservoir(Reservoir("A", "A", 1, "R_A", 10));
+    testSystem.addReservoir(Reservoir("B", "B", 2, "R_B", 20));
+    testSystem.addStation(Station("S_1", 1));
+    testSystem.addCity(City("C1", 1, "C_1", 10, 100));
+    testSystem.addCity(City("C2", 2, "C_2", 30, 100));
+    testSystem.addCity(City("C3", 3, "C_3", 10, 100));
+    testSystem.insertAll();
+    testSystem.addPipe("R_A", "S_1", 20, 1);
+    testSystem.addPipe("S_1", "C_1", 20, 1);
+    testSystem.addPipe("S_1", "C_2", 20, 1);
+    testSystem.addPipe("R_B", "C_3", 4, 1);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+
+    //C_1 and C_2 get the same fraction of their demand, C_3 gets everything its pipe can carry
+    std::vector<std::pair<std::string, double>> allocation = testSystem.fairAllocation();
+    ASSERT_EQ(allocation.size(), 3);
+    EXPECT_EQ(allocation[0].first, "C_1");
+    EXPECT_NEAR(allocation[0].second, 2.5, 1e-6);
+    EXPECT_NEAR(allocation[1].second, 7.5, 1e-6);
+    EXPECT_NEAR(allocation[2].second, 4, 1e-6);
+    EXPECT_NEAR(testSystem.flowDeficit("C_2"), 22.5, 1e-6);
+    EXPECT_NEAR(totalFlow(testSystem), 14, 1e-6);
+}
+
+TEST(fairAllocation, keepsTheMaximumFlow){
+    cleanSystem();
+
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+
+    testSystem.edmondsKarp("super_source", "super_sink");
+    double maxFlow = totalFlow(testSystem);
+    double minFraction = 1;
+    for(const auto &codeCity : testSystem.getCodeToCity()){
+        minFraction = std::min(minFraction, 1 - testSystem.flowDeficit(codeCity.first) / codeCity.second.getDemand());
+    }
+
+    std::vector<std::pair<std::string, double>> allocation = testSystem.fairAllocation();
+    EXPECT_NEAR(totalFlow(testSystem), maxFlow, 1e-6);
+    EXPECT_EQ(testSystem.fairAllocation(), allocation);
+
+    //the worst served city is never worse than with the max flow split
+    double fairMinFraction = 1;
+    for(const auto &codeFlow : allocation){
+        double demand = testSystem.getCodeToCity().find(codeFlow.first)->second.getDemand();
+        EXPECT_LE(codeFlow.second, demand + 1e-6);
+        EXPECT_NEAR(codeFlow.second, demand - testSystem.flowDeficit(codeFlow.first), 1e-6);
+        fairMinFraction = std::min(fairMinFraction, codeFlow.second / demand);
+    }
+    EXPECT_GE(fairMinFraction, minFraction - 1e-6);
+
+    //the pipes still respect their capacities
+    for(Vertex<std::string> *v : testSystem.getNetwork().getVertexSet()){
+        for(Edge<std::string> *e : v->getAdj()){
+            EXPECT_LE(std::abs(e->getFlow()), e->getWeight() + 1e-6);
+        }
+    }
+}
+
+TEST(deterministicOrder, followsTheFiles){
+    cleanSystem();
+
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+
+    const std::vector<std::string> &cities = testSystem.getCityCodes();
+    ASSERT_EQ(cities.size(), testSystem.getCodeToCity().size());
+    EXPECT_EQ(cities[0], "C_1");
+    EXPECT_EQ(cities[1], "C_2");
+    EXPECT_EQ(testSystem.getStationCodes().size(), testSystem.getCodeToStation().size());
+    EXPECT_EQ(testSystem.getReservoirCodes().size(), testSystem.getCodeToReservoir().size());
+
+    //the vertexes and the super node edges are inserted in file order: cities, stations, reservoirs
+    std::vector<std::string> expected(cities);
+    expected.insert(expected.end(), testSystem.getStationCodes().begin(), testSystem.getStationCodes().end());
+    expected.insert(expected.end(), testSystem.getReservoirCodes().begin(), testSystem.getReservoirCodes().end());
+    std::vector<std::string> vertexes;
+    const Graph<std::string> &network = testSystem.getNetwork();
+    for(Vertex<std::string> *v : network.getVertexSet()){
+        if(v->getType() != VertexType::SUPERSOURCE && v->getType() != VertexType::SUPERSINK) vertexes.push_back(v->getInfo());
+    }
+    EXPECT_EQ(vertexes, expected);
+
+    std::vector<std::string> sourceEdges;
+    for(Edge<std::string> *e : network.findVertex("super_source")->getAdj()) sourceEdges.push_back(e->getDest()->getInfo());
+    EXPECT_EQ(sourceEdges, testSystem.getReservoirCodes());
+
+    //adding an element twice doesn't change the order
+    testSystem.addCity(City("Porto Moniz", 1, "C_1", 18, 2517));
+    EXPECT_EQ(testSystem.getCityCodes().size(), testSystem.getCodeToCity().size());
+}
+
+TEST(priorityAllocation, prefersHighPriority){
+    cleanSystem();
+    //R_A (10) -> S_1 -> C_1 (demand 10, population 100) and C_2 (demand 10, population 500)
+    testSystem.addReservoir(Reservoir("A", "A", 1, "R_A", 10));
+    testSystem.addStation(Station("S_1", 1));
+    City small("C1", 1, "C_1", 10, 100);
+    testSystem.addCity(small);
+    testSystem.addCity(City("C2", 2, "C_2", 10, 500));
+    testSystem.insertAll();
+    testSystem.addPipe("R_A", "S_1", 20, 1);
+    testSystem.addPipe("S_1", "C_1", 20, 1);
+    testSystem.addPipe("S_1", "C_2", 20, 1);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+
+    std::vector<std::pair<std::string, double>> allocation = testSystem.priorityAllocation();
+    ASSERT_EQ(allocation.size(), 2);
+    EXPECT_NEAR(allocation[0].second, 0, 1e-6);
+    EXPECT_NEAR(allocation[1].second, 10, 1e-6);
+    EXPECT_NEAR(testSystem.flowDeficit("C_1"), 10, 1e-6);
+
+    //an explicit priority replaces the population
+    cleanSystem();
+    small.setPriority(1000);
+    testSystem.addReservoir(Reservoir("A", "A", 1, "R_A", 10));
+    testSystem.addStation(Station("S_1", 1));
+    testSystem.addCity(small);
+    testSystem.addCity(City("C2", 2, "C_2", 10, 500));
+    testSystem.insertAll();
+    testSystem.addPipe("R_A", "S_1", 20, 1);
+    testSystem.addPipe("S_1", "C_1", 20, 1);
+    testSystem.addPipe("S_1", "C_2", 20, 1);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+    testSystem.distributeWater(DistributionMode::PRIORITY);
+    EXPECT_NEAR(testSystem.flowDeficit("C_1"), 0, 1e-6);
+    EXPECT_NEAR(testSystem.flowDeficit("C_2"), 10, 1e-6);
+}
+
+TEST(priorityAllocation, keepsTheMaximumFlow){
+    cleanSystem();
+
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+
+    auto weightedDelivery = [](){
+        double total = 0;
+        for(const auto &codeCity : testSystem.getCodeToCity()){
+            total += codeCity.second.getPriority() * (codeCity.second.getDemand() - testSystem.flowDeficit(codeCity.first));
+        }
+        return total;
+    };
+
+    testSystem.distributeWater(DistributionMode::MAX_FLOW);
+    double maxFlow = totalFlow(testSystem);
+    double maxFlowWeighted = weightedDelivery();
+
+    testSystem.distributeWater(DistributionMode::PRIORITY);
+    EXPECT_NEAR(totalFlow(testSystem), maxFlow, 1e-6);
+    EXPECT_GE(weightedDelivery(), maxFlowWeighted - 1e-6);
+    for(Vertex<std::string> *v : testSystem.getNetwork().getVertexSet()){
+        for(Edge<std::string> *e : v->getAdj()){
+            EXPECT_LE(std::abs(e->getFlow()), e->getWeight() + 1e-6);
+        }
+    }
+}
+
+TEST(minCostAllocation, cheapestRoute){
+    cleanSystem();
+    //R_A (10) -> C_1 (demand 10) directly (cost 5) or through S_2 = S_1 (bidirectional, cost 2) -> C_1
+    testSystem.addReservoir(Reservoir("A", "A", 1, "R_A", 10));
+    testSystem.addStation(Station("S_1", 1));
+    testSystem.addStation(Station("S_2", 2));
+    testSystem.addCity(City("C1", 1, "C_1", 10, 100));
+    testSystem.insertAll();
+    testSystem.addPipe("R_A", "C_1", 10, 1, 5);
+    testSystem.addPipe("R_A", "S_2", 10, 1);
+    testSystem.addPipe("S_1", "S_2", 10, 0, 2);
+    testSystem.addPipe("S_1", "C_1", 10, 1);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+
+    EXPECT_NEAR(testSystem.minCostAllocation(), 20, 1e-6);
+    EXPECT_NEAR(testSystem.operatingCost(), 20, 1e-6);
+    EXPECT_NEAR(testSystem.flowDeficit("C_1"), 0, 1e-6);
+    EXPECT_NEAR(testSystem.findPipe("S_1", "S_2")->getFlow(), -10, 1e-6);
+    EXPECT_NEAR(testSystem.findPipe("R_A", "C_1")->getFlow(), 0, 1e-6);
+
+    std::vector<WaterSupplyManagement::StationLoad> loads = testSystem.stationPumpingLoad();
+    ASSERT_EQ(loads.size(), 2);
+    EXPECT_EQ(loads[0].code, "S_1");
+    EXPECT_NEAR(loads[0].pumped, 10, 1e-6);
+    EXPECT_NEAR(loads[0].cost, 0, 1e-6);
+    EXPECT_NEAR(loads[1].pumped, 10, 1e-6);
+    EXPECT_NEAR(loads[1].cost, 20, 1e-6);
+}
+
+TEST(minCostAllocation, keepsTheMaximumFlow){
+    cleanSystem();
+
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+
+    //pseudo random costs on every pipe
+    std::mt19937 generator(39);
+    std::uniform_int_distribution<int> costs(0, 9);
+    const Graph<std::string> &network = testSystem.getNetwork();
+    for(Vertex<std::string> *v : network.getVertexSet()){
+        if(v->getType() == VertexType::SUPERSOURCE) continue;
+        for(Edge<std::string> *e : v->getAdj()){
+            if(e->getDest()->getType() != VertexType::SUPERSINK) e->setCost(costs(generator));
+        }
+    }
+
+    testSystem.distributeWater(DistributionMode::MAX_FLOW);
+    double maxFlow = totalFlow(testSystem);
+    double maxFlowCost = testSystem.operatingCost();
+
+    double cost = testSystem.minCostAllocation();
+    EXPECT_NEAR(totalFlow(testSystem), maxFlow, 1e-6);
+    EXPECT_NEAR(testSystem.operatingCost(), cost, 1e-6);
+    EXPECT_LE(cost, maxFlowCost + 1e-6);
+    for(Vertex<std::string> *v : network.getVertexSet()){
+        for(Edge<std::string> *e : v->getAdj()){
+            EXPECT_LE(std::abs(e->getFlow()), e->getWeight() + 1e-6);
+        }
+    }
+}
+
+TEST(minCostAllocation, rejectsNegativeCosts){
+    cleanSystem();
+    testSystem.addReservoir(Reservoir("A", "A", 1, "R_A", 10));
+    testSystem.addStation(Station("S_1", 1));
+    testSystem.addStation(Station("S_2", 2));
+    testSystem.addCity(City("C1", 1, "C_1", 10, 100));
+    testSystem.insertAll();
+    testSystem.addPipe("R_A", "C_1", 10, 1, 5);
+    testSystem.addPipe("R_A", "S_2", 10, 1);
+    testSystem.addPipe("S_1", "C_1", 10, 1);
+
+    //a bidirectional pipe with a negative cost is a cycle with a negative cost
+    EXPECT_FALSE(testSystem.addPipe("S_1", "S_2", 10, 0, -2));
+    EXPECT_EQ(testSystem.findPipe("S_1", "S_2"), nullptr);
+    {
+        std::ofstream fout("pipes_negative_cost_test.csv");
+        fout << "Service_Point_A,Service_Point_B,Capacity,Direction,Cost\n";
+        fout << "S_1,S_2,10,0,-2\n";
+        fout << "S_2,S_1,10,0,2\n";
+    }
+    ValidationReport report;
+    std::vector<WaterSupplyManagement::PipeRecord> pipes = WaterSupplyManagement::parsePipes("pipes_negative_cost_test.csv", 1, &report);
+    std::remove("pipes_negative_cost_test.csv");
+    ASSERT_EQ(pipes.size(), 1);
+    EXPECT_EQ(pipes[0].cost, 2);
+    ASSERT_EQ(report.count(ValidationReport::IssueType::NEGATIVE_COST), 1);
+    EXPECT_EQ(report.getIssues()[0].line, 2);
+
+    pipes.push_back(pipes[0]);
+    pipes[1].cost = -2;
+    testSystem.addPipes(pipes);
+    EXPECT_EQ(testSystem.validate().count(ValidationReport::IssueType::NEGATIVE_COST), 1);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+    EXPECT_NEAR(testSystem.minCostAllocation(), 20, 1e-6);
+}
+
+TEST(memory, compactNetworkMatchesTheGraph){
+    cleanSystem();
+
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+    testSystem.edmondsKarp("super_source", "super_sink");
+
+    const Graph<std::string> &network = testSystem.getNetwork();
+    CompactNetwork compact;
+    compact.build(network);
+    EXPECT_EQ(compact.getNumVertexes(), network.getNumVertex() - 2);
+    EXPECT_EQ(compact.findVertex("super_source"), CompactNetwork::NONE);
+    EXPECT_EQ(compact.findVertex("nothing"), CompactNetwork::NONE);
+    EXPECT_TRUE(compact.isSinglePrecision());
+
+    size_t pipes = 0;
+    for(Vertex<std::string> *v : network.getVertexSet()){
+        if(v->getType() == VertexType::SUPERSOURCE || v->getType() == VertexType::SUPERSINK) continue;
+        uint32_t u = compact.findVertex(v->getInfo());
+        ASSERT_NE(u, CompactNetwork::NONE);
+        EXPECT_EQ(compact.getCode(u), v->getInfo());
+        EXPECT_EQ(compact.getType(u), v->getType());
+
+        uint32_t pipe = compact.firstPipe(u);
+        for(Edge<std::string> *e : v->getAdj()){
+            if(e->getDest()->getType() == VertexType::SUPERSINK) continue;
+            ASSERT_LT(pipe, compact.firstPipe(u + 1));
+            EXPECT_EQ(compact.getCode(compact.getDest(pipe)), e->getDest()->getInfo());
+            EXPECT_EQ(compact.getCapacity(pipe), e->getWeight());
+            EXPECT_EQ(compact.getFlow(pipe), e->getFlow());
+            EXPECT_EQ(compact.isBidirectional(pipe), e->isBidirectional());
+            pipe++;
+            pipes++;
+        }
+        EXPECT_EQ(pipe, compact.firstPipe(u + 1));
+    }
+    EXPECT_EQ(compact.getNumPipes(), pipes);
+
+    //a value that isn't exactly a float is kept as a double
+    testSystem.findPipe("R_1", network.findVertex("R_1")->getAdj()[0]->getDest()->getInfo())->setCost(0.1);
+    compact.build(network);
+    EXPECT_FALSE(compact.isSinglePrecision());
+    EXPECT_EQ(compact.getCost(compact.firstPipe(compact.findVertex("R_1"))), 0.1);
+
+    WaterSupplyManagement::MemoryReport report = testSystem.memoryReport();
+    size_t edges = 0;
+    for(auto v : network.getVertexSet()) edges += v->getAdj().size();
+    EXPECT_EQ(report.numVertexes, network.getNumVertex());
+    EXPECT_EQ(report.numEdges, edges);
+    EXPECT_GT(report.numEdges, pipes);
+    EXPECT_EQ(report.numEntities, testSystem.getCodeToCity().size() + testSystem.getCodeToStation().size() + testSystem.getCodeToReservoir().size());
+    EXPECT_GE(report.edgeBytes, report.numEdges * sizeof(Edge<std::string>));
+    EXPECT_LT(report.compactBytes, report.vertexBytes + report.edgeBytes);
+}
+
+TEST(incrementalBalance, onlyTheChangedRegion){
+    cleanSystem();
+
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+    testSystem.edmondsKarp("super_source", "super_sink");
+
+    //nothing changed since the snapshot
+    std::shared_ptr<const FlowSnapshot> solved = testSystem.publishSnapshot();
+    EXPECT_TRUE(testSystem.changedVertexes(*solved).empty());
+
+    //a region with every vertex is the same as the global balance
+    std::vector<std::string> everything;
+    for(const std::vector<std::string> *codes : {&testSystem.getReservoirCodes(), &testSystem.getStationCodes(), &testSystem.getCityCodes()}){
+        everything.insert(everything.end(), codes->begin(), codes->end());
+    }
+    testSystem.networkBalance(everything);
+    double avgRegional = testSystem.avgDiffPipes();
+    std::shared_ptr<const FlowSnapshot> regional = testSystem.publishSnapshot();
+    testSystem.edmondsKarp("super_source", "super_sink");
+    testSystem.networkBalance();
+    EXPECT_EQ(testSystem.avgDiffPipes(), avgRegional);
+    for(const FlowSnapshot::PipeFlow &pipe : regional->getPipes()){
+        EXPECT_EQ(testSystem.findPipe(pipe.origin, pipe.destination)->getFlow(), pipe.flow);
+    }
+    std::vector<std::string> changed = testSystem.changedVertexes(*solved);
+    EXPECT_FALSE(changed.empty());
+
+    //rebalancing only where the flow changed after an edit never makes the average worse
+    std::shared_ptr<const FlowSnapshot> balanced = testSystem.publishSnapshot();
+    Edge<std::string> *pipe = testSystem.findPipe("R_1", testSystem.getNetwork().findVertex("R_1")->getAdj()[0]->getDest()->getInfo());
+    pipe->setWeight(pipe->getWeight() / 2);
+    testSystem.edmondsKarp("super_source", "super_sink");
+    changed = testSystem.changedVertexes(*balanced);
+    ASSERT_FALSE(changed.empty());
+    for(const std::string &code : changed){
+        EXPECT_NE(testSystem.getNetwork().findVertex(code), nullptr);
+    }
+    WaterSupplyManagement::PipeStats stats = testSystem.pipeStats();
+    double avgBefore = stats.average();
+    double flowBefore = testSystem.publishSnapshot()->getTotalFlow();
+    testSystem.networkBalance(changed, stats);
+    EXPECT_LE(testSystem.avgDiffPipes(), avgBefore);
+    EXPECT_EQ(testSystem.publishSnapshot()->getTotalFlow(), flowBefore);
+
+    //the differences given to the regional balance are kept up to date without going over the whole network
+    EXPECT_EQ(stats.numPipes, testSystem.pipeStats().numPipes);
+    EXPECT_NEAR(stats.average(), testSystem.avgDiffPipes(), 1e-9);
+}
+
+TEST(parallelBalance, sameAsSequential){
+    cleanSystem();
+
+    testSystem.readStations(DataSetSelection::BIG);
+    testSystem.readReservoirs(DataSetSelection::BIG);
+    testSystem.readCities(DataSetSelection::BIG);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::BIG);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+
+    testSystem.edmondsKarp("super_source", "super_sink");
+    testSystem.networkBalance(1);
+    double avgSequential = testSystem.avgDiffPipes();
+    std::shared_ptr<const FlowSnapshot> sequential = testSystem.publishSnapshot();
+
+    for(unsigned int numThreads : {2u, 8u}){
+        testSystem.edmondsKarp("super_source", "super_sink");
+        testSystem.networkBalance(numThreads);
+        EXPECT_EQ(testSystem.avgDiffPipes(), avgSequential);
+        for(const FlowSnapshot::PipeFlow &pipe : sequential->getPipes()){
+            EXPECT_EQ(testSystem.findPipe(pipe.origin, pipe.destination)->getFlow(), pipe.flow);
+        }
+    }
+}
+
+TEST(parallelBalance, manyIndependentParts){
+    cleanSystem();
+    //32 parts not connected by pipes, each with paths of 1, 2 and 3 pipes from R_i to C_i (random capacities)
+    const int numParts = 32;
+    std::mt19937 gen(5);
+    std::uniform_int_distribution<int> capacity(5, 40);
+    for(int i = 0; i < numParts; i++){
+        std::string part = std::to_string(i);
+        testSystem.addReservoir(Reservoir("R" + part, "M", i, "R_" + part, 60));
+        for(int k = 0; k < 3; k++) testSystem.addStation(Station("S_" + part + "_" + std::to_string(k), i * 3 + k));
+        testSystem.addCity(City("City" + part, i, "C_" + part, 60, 1000));
+    }
+    testSystem.insertAll();
+    for(int i = 0; i < numParts; i++){
+        std::string part = std::to_string(i), reservoir = "R_" + part, city = "C_" + part, station = "S_" + part + "_";
+        testSystem.addPipe(reservoir, city, capacity(gen), 1);
+        testSystem.addPipe(reservoir, station + "0", capacity(gen), 1);
+        testSystem.addPipe(station + "0", city, capacity(gen), 1);
+        testSystem.addPipe(station + "0", station + "1", capacity(gen), 1);
+        testSystem.addPipe(reservoir, station + "2", capacity(gen), 1);
+        testSystem.addPipe(station + "2", station + "1", capacity(gen), 1);
+        testSystem.addPipe(station + "1", city, capacity(gen), 1);
+    }
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+
+    testSystem.edmondsKarp("super_source", "super_sink");
+    double avgSolved = testSystem.avgDiffPipes();
+    testSystem.networkBalance(1);
+    double avgSequential = testSystem.avgDiffPipes();
+    std::shared_ptr<const FlowSnapshot> sequential = testSystem.publishSnapshot();
+    EXPECT_LT(avgSequential, avgSolved);
+
+    //each part is taken by one of the threads, the result doesn't depend on how many there are
+    for(unsigned int numThreads : {2u, 8u, 32u}){
+        testSystem.edmondsKarp("super_source", "super_sink");
+        testSystem.networkBalance(numThreads);
+        EXPECT_EQ(testSystem.avgDiffPipes(), avgSequential);
+        for(const FlowSnapshot::PipeFlow &pipe : sequential->getPipes()){
+            EXPECT_EQ(testSystem.findPipe(pipe.origin, pipe.destination)->getFlow(), pipe.flow);
+        }
+    }
+}
+
+TEST(bulkBalance, highCapacityPipes){
+    cleanSystem();
+    testSystem.addReservoir(Reservoir("R1", "M", 1, "R_1", 10000));
+    testSystem.addStation(Station("PS_1", 1));
+    testSystem.addCity(City("City1", 1, "C_1", 10000, 1000));
+    testSystem.insertAll();
+    testSystem.addPipe("R_1", "C_1", 10000, 1);
+    testSystem.addPipe("R_1", "PS_1", 10000, 1);
+    testSystem.addPipe("PS_1", "C_1", 10000, 1);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+    testSystem.edmondsKarp("super_source", "super_sink");
+    ASSERT_EQ(testSystem.findPipe("R_1", "C_1")->getFlow(), 10000);
+
+    //one unit at a time this would take thousands of moves
+    Profiler::reset();
+    Profiler::setEnabled(true);
+    double avgInitial = testSystem.avgDiffPipes();
+    testSystem.networkBalance();
+    Profiler::setEnabled(false);
+    EXPECT_LT(Profiler::getCount(ProfilerCounter::FLOW_ADD_STEPS), 20);
+    Profiler::reset();
+
+    EXPECT_LT(testSystem.avgDiffPipes(), avgInitial);
+    EXPECT_EQ(testSystem.findPipe("R_1", "C_1")->getFlow(), 5000);
+    EXPECT_EQ(testSystem.findPipe("R_1", "PS_1")->getFlow(), 5000);
+    EXPECT_EQ(testSystem.findPipe("PS_1", "C_1")->getFlow(), 5000);
+    EXPECT_EQ(totalFlow(testSystem), 10000);
+}
+
+TEST(solveCache, leastRecentlyUsedAndFile){
+    std::remove("solve_cache_test.wsmcache");
+    SolveCache cache(2);
+    ASSERT_TRUE(cache.setFile("solve_cache_test.wsmcache"));
+    std::vector<double> values;
+    EXPECT_FALSE(cache.find(1, values));
+    cache.store(1, {1, 2});
+    cache.store(2, {3});
+    EXPECT_TRUE(cache.find(1, values));
+    cache.store(3, {4, 5, 6});
+
+    //2 was the least recently used one, it is only in the file now
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_TRUE(cache.find(2, values));
+    EXPECT_EQ(values, std::vector<double>({3}));
+    EXPECT_EQ(cache.getHits(), 2);
+    EXPECT_EQ(cache.getMisses(), 1);
+
+    //another session reads the same file
+    SolveCache other;
+    ASSERT_TRUE(other.setFile("solve_cache_test.wsmcache"));
+    EXPECT_TRUE(other.find(3, values));
+    EXPECT_EQ(values, std::vector<double>({4, 5, 6}));
+    EXPECT_TRUE(other.find(1, values));
+    EXPECT_EQ(values, std::vector<double>({1, 2}));
+    EXPECT_FALSE(other.find(4, values));
+
+    //the results of other solvers are discarded
+    SolveCache newer;
+    ASSERT_TRUE(newer.setFile("solve_cache_test.wsmcache", 1));
+    EXPECT_FALSE(newer.find(3, values));
+
+    //the file is compacted when it is full, keeping the newest results
+    newer.setMaxFileSize(1024);
+    for(uint64_t key = 0; key < 100; key++) newer.store(key, std::vector<double>(4, key));
+    EXPECT_LE(newer.getFileSize(), 1024);
+    SolveCache reader;
+    ASSERT_TRUE(reader.setFile("solve_cache_test.wsmcache", 1));
+    EXPECT_TRUE(reader.find(99, values));
+    EXPECT_EQ(values, std::vector<double>(4, 99));
+    EXPECT_FALSE(reader.find(0, values));
+    std::remove("solve_cache_test.wsmcache");
+}
+
+TEST(solveCache, reusesTheSolvedNetwork){
+    cleanSystem();
+
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+    testSystem.edmondsKarp("super_source", "super_sink");
+    std::vector<double> solved = testSystem.edgeFlows();
+
+    uint64_t key = testSystem.fingerprint("max_flow");
+    EXPECT_EQ(testSystem.fingerprint("max_flow"), key);
+    EXPECT_NE(testSystem.fingerprint("fair_share"), key);
+
+    //the second solve of the same network is read from the cache
+    testSystem.distributeWater(DistributionMode::MAX_FLOW);
+    EXPECT_EQ(testSystem.getSolveCache().getMisses(), 1);
+    testSystem.networkBalance();
+    Profiler::reset();
+    Profiler::setEnabled(true);
+    testSystem.distributeWater(DistributionMode::MAX_FLOW);
+    Profiler::setEnabled(false);
+    EXPECT_EQ(Profiler::getCount(ProfilerCounter::AUGMENTING_PATHS), 0);
+    EXPECT_EQ(testSystem.getSolveCache().getHits(), 1);
+    EXPECT_EQ(testSystem.edgeFlows(), solved);
+    Profiler::reset();
+
+    //a change of capacity is a different network
+    Edge<std::string> *pipe = testSystem.findPipe("R_1", testSystem.getNetwork().findVertex("R_1")->getAdj()[0]->getDest()->getInfo());
+    pipe->setWeight(pipe->getWeight() + 1);
+    EXPECT_NE(testSystem.fingerprint("max_flow"), key);
+    pipe->setWeight(pipe->getWeight() - 1);
+    EXPECT_EQ(testSystem.fingerprint("max_flow"), key);
+
+    //the failure scenarios give the same results with and without the cache
+    std::vector<std::pair<std::string, double>> none;
+    std::vector<std::pair<std::string, double>> first = testSystem.affectedCitiesReservoir("R_1", none);
+    uint64_t hits = testSystem.getSolveCache().getHits();
+    EXPECT_EQ(testSystem.affectedCitiesReservoir("R_1", none), first);
+    EXPECT_EQ(testSystem.getSolveCache().getHits(), hits + 1);
+
+    //the network is the same after a pipe failure, its order included
+    Edge<std::string> *crucial = testSystem.getNetwork().findVertex("PS_1")->getAdj()[0];
+    std::vector<std::pair<std::string, double>> crucialFirst = testSystem.crucialPipelines("PS_1", crucial->getDest()->getInfo(), none);
+    EXPECT_EQ(testSystem.fingerprint("max_flow"), key);
+    hits = testSystem.getSolveCache().getHits();
+    EXPECT_EQ(testSystem.crucialPipelines("PS_1", crucial->getDest()->getInfo(), none), crucialFirst);
+    EXPECT_EQ(testSystem.getSolveCache().getHits(), hits + 1);
+}
+
+TEST(editJournal, undoAndRedo){
+    cleanSystem();
+
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+    testSystem.edmondsKarp("super_source", "super_sink");
+    double maxFlow = totalFlow(testSystem);
+    uint64_t original = testSystem.fingerprint();
+    //loading the data is not an edit
+    std::size_t loaded = testSystem.getJournal().checkpoint();
+    EXPECT_EQ(loaded, 0);
+    EXPECT_FALSE(testSystem.getJournal().canRedo());
+
+    Edge<std::string> *first = testSystem.getNetwork().findVertex("R_1")->getAdj()[0];
+    std::string dest = first->getDest()->getInfo();
+    double capacity = first->getWeight();
+    EXPECT_TRUE(testSystem.setPipeCapacity("R_1", dest, 0));
+    EXPECT_FALSE(testSystem.setPipeCapacity("R_1", "R_1", 0));
+    std::string removed = testSystem.getNetwork().findVertex("PS_1")->getAdj()[0]->getDest()->getInfo();
+    EXPECT_TRUE(testSystem.deletePipe("PS_1", removed));
+    EXPECT_FALSE(testSystem.deletePipe("PS_1", removed));
+    EXPECT_FALSE(testSystem.insertCity("C_1"));
+    EXPECT_EQ(testSystem.getJournal().checkpoint(), loaded + 2);
+    uint64_t edited = testSystem.fingerprint();
+    EXPECT_NE(edited, original);
+
+    //undo takes the network back (the solve gives the same flow), redo makes the edits again
+    EXPECT_TRUE(testSystem.undo());
+    EXPECT_TRUE(testSystem.undo());
+    EXPECT_EQ(testSystem.findPipe("R_1", dest)->getWeight(), capacity);
+    testSystem.edmondsKarp("super_source", "super_sink");
+    EXPECT_EQ(totalFlow(testSystem), maxFlow);
+    EXPECT_TRUE(testSystem.redo());
+    EXPECT_TRUE(testSystem.redo());
+    EXPECT_FALSE(testSystem.redo());
+    EXPECT_EQ(testSystem.findPipe("PS_1", removed), nullptr);
+    EXPECT_EQ(testSystem.fingerprint(), edited);
+
+    //a new edit after an undo discards the redo
+    testSystem.rollback(loaded + 1);
+    EXPECT_EQ(testSystem.findPipe("R_1", dest)->getWeight(), 0);
+    EXPECT_TRUE(testSystem.setPipeCapacity("R_1", dest, 1));
+    EXPECT_FALSE(testSystem.getJournal().canRedo());
+    testSystem.rollback(loaded);
+    EXPECT_EQ(testSystem.findPipe("R_1", dest)->getWeight(), capacity);
+
+    //an inserted vertex is connected to the super nodes and removed with its pipes by undo
+    testSystem.addCity(City("New", 99, "C_99", 10, 100));
+    EXPECT_TRUE(testSystem.insertCity("C_99"));
+    EXPECT_TRUE(testSystem.addPipe("R_1", "C_99", 5, 1));
+    testSystem.edmondsKarp("super_source", "super_sink");
+    EXPECT_EQ(totalFlow(testSystem), maxFlow + 5);
+    EXPECT_TRUE(testSystem.rollback(loaded));
+    EXPECT_EQ(testSystem.getNetwork().findVertex("C_99"), nullptr);
+    testSystem.edmondsKarp("super_source", "super_sink");
+    EXPECT_EQ(totalFlow(testSystem), maxFlow);
+
+    //an edit that can't be made again leaves the journal where it was
+    cleanSystem();
+    EXPECT_TRUE(testSystem.insertStation("super_source"));
+    EXPECT_TRUE(testSystem.undo());
+    testSystem.createSuperSource();
+    EXPECT_FALSE(testSystem.redo());
+    EXPECT_EQ(testSystem.getJournal().checkpoint(), 0);
+    EXPECT_TRUE(testSystem.getJournal().canRedo());
+}
+
+TEST(graphClone, independentCopy){
+    cleanSystem();
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+    testSystem.edmondsKarp("super_source", "super_sink");
+    const Graph<std::string> &network = testSystem.getNetwork();
+    double maxFlow = totalFlow(testSystem);
+
+    //same vertexes, edges, weights and flows in the same order
+    Graph<std::string> copy = network;
+    ASSERT_EQ(copy.getNumVertex(), network.getNumVertex());
+    for(int i = 0; i < network.getNumVertex(); i++){
+        Vertex<std::string> *v = network.getVertexSet()[i];
+        Vertex<std::string> *c = copy.getVertexSet()[i];
+        EXPECT_NE(v, c);
+        EXPECT_EQ(c, copy.findVertex(v->getInfo()));
+        EXPECT_EQ(c->getIndex(), v->getIndex());
+        ASSERT_EQ(c->getAdj().size(), v->getAdj().size());
+        ASSERT_EQ(c->getIncoming().size(), v->getIncoming().size());
+        for(size_t k = 0; k < v->getAdj().size(); k++){
+            EXPECT_EQ(c->getAdj()[k]->getOrig(), c);
+            EXPECT_EQ(c->getAdj()[k]->getDest(), copy.getVertexSet()[v->getAdj()[k]->getDest()->getIndex()]);
+            EXPECT_EQ(c->getAdj()[k]->getWeight(), v->getAdj()[k]->getWeight());
+            EXPECT_EQ(c->getAdj()[k]->getFlow(), v->getAdj()[k]->getFlow());
+        }
+        for(size_t k = 0; k < v->getIncoming().size(); k++){
+            EXPECT_EQ(c->getIncoming()[k]->getOrig()->getInfo(), v->getIncoming()[k]->getOrig()->getInfo());
+            EXPECT_EQ(c->getIncoming()[k]->getDest(), c);
+        }
+    }
+
+    //changing the copy doesn't change the original
+    Edge<std::string> *pipe = copy.findVertex("R_1")->getAdj()[0];
+    std::string dest = pipe->getDest()->getInfo();
+    pipe->setFlow(-1);
+    pipe->setWeight(0);
+    EXPECT_TRUE(copy.removeEdge("R_1", dest));
+    EXPECT_TRUE(copy.removeVertex("PS_1"));
+    EXPECT_NE(testSystem.findPipe("R_1", dest), nullptr);
+    EXPECT_NE(network.findVertex("PS_1"), nullptr);
+    EXPECT_EQ(totalFlow(testSystem), maxFlow);
+
+    //reverse edges point inside the copy, and a copy of a copy can be assigned and freed
+    Graph<int> g;
+    for(int i = 0; i < 3; i++) g.addVertex(i, VertexType::STATIONS);
+    g.addBidirectionalEdge(0, 1, 4);
+    g.addEdge(1, 2, 2);
+    Graph<int> h;
+    h = g;
+    Graph<int> k = h;
+    h = Graph<int>();
+    Edge<int> *forward = k.findVertex(0)->getAdj()[0];
+    EXPECT_EQ(forward->getReverse(), k.findVertex(1)->getAdj()[0]);
+    EXPECT_EQ(forward->getReverse()->getReverse(), forward);
+    EXPECT_NE(forward, g.findVertex(0)->getAdj()[0]);
+    EXPECT_TRUE(k.removeVertex(1));
+    EXPECT_EQ(k.getNumVertex(), 2);
+    EXPECT_EQ(g.getNumVertex(), 3);
+}
+
+TEST(graphClone, millionPipes){
+    const int numVertexes = 200000;
+    Graph<int> g;
+    for(int i = 0; i < numVertexes; i++) g.addVertex(i, VertexType::STATIONS);
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> vertex(0, numVertexes - 1);
+    for(int i = 0; i < 1000000; i++) g.addEdge(vertex(gen), vertex(gen), i % 100);
+
+    Graph<int> copy = g;
+    ASSERT_EQ(copy.getNumVertex(), numVertexes);
+    EXPECT_EQ(copy.getNumEdges(), 1000000);
+
+    //one allocation: the vertexes and then the edges are contiguous, in the order of the vertex set and of the outgoing edges
+    std::vector<Vertex<int> *> vertexes = copy.getVertexSet();
+    Edge<int> *first = nullptr;
+    size_t numEdge = 0, misplaced = 0;
+    for(size_t i = 0; i < vertexes.size(); i++){
+        if(vertexes[i] != vertexes[0] + i) misplaced++;
+        for(Edge<int> *e : vertexes[i]->getAdj()){
+            if(first == nullptr) first = e;
+            if(e != first + numEdge) misplaced++;
+            numEdge++;
+        }
+    }
+    EXPECT_EQ(misplaced, 0);
+    EXPECT_EQ(g.findVertex(123)->getAdj().size(), copy.findVertex(123)->getAdj().size());
+}
+
+TEST(parallelIngestion, sameAsSequential){
+    cleanSystem();
+    testSystem.readCities(DataSetSelection::BIG);
+    testSystem.readReservoirs(DataSetSelection::BIG);
+    testSystem.readStations(DataSetSelection::BIG);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::BIG, 1);
+    uint64_t sequential = testSystem.fingerprint();
+    std::vector<std::string> cityCodes = testSystem.getCityCodes();
+
+    //the entity files are read at the same time, the pipes only after their endpoints are inserted
+    cleanSystem();
+    std::vector<WaterSupplyManagement::PipeRecord> pipes = testSystem.readData(DataSetSelection::BIG, 4);
+    EXPECT_EQ(testSystem.getNetwork().getNumVertex(), 0);
+    EXPECT_EQ(testSystem.getCityCodes(), cityCodes);
+    testSystem.insertAll();
+    testSystem.addPipes(pipes);
+    EXPECT_EQ(testSystem.fingerprint(), sequential);
+
+    //a big file is split in parts at line breaks, the parts are joined in the order of the file
+    {
+        std::ofstream fout("pipes_ingestion_test.csv", std::ios::binary);
+        fout << "Service_Point_A,Service_Point_B,Capacity,Direction,Cost\n";
+        for(int i = 0; i < 60000; i++){
+            fout << "PS_" << i << ",C_" << (i * 7919) % 60000 << ',' << 100 + i % 900 << ',' << i % 2;
+            if(i % 3 == 0) fout << ',' << i % 11;
+            if(i == 30000) fout << '\n';
+            if(i < 59999) fout << '\n';
+        }
+    }
+    std::vector<WaterSupplyManagement::PipeRecord> single = WaterSupplyManagement::parsePipes("pipes_ingestion_test.csv", 1);
+    std::vector<WaterSupplyManagement::PipeRecord> parallel = WaterSupplyManagement::parsePipes("pipes_ingestion_test.csv", 4);
+    std::remove("pipes_ingestion_test.csv");
+    ASSERT_EQ(single.size(), 60000);
+    ASSERT_EQ(parallel.size(), single.size());
+    for(size_t i = 0; i < single.size(); i++){
+        EXPECT_EQ(parallel[i].origin, "PS_" + std::to_string(i));
+        EXPECT_EQ(parallel[i].line, i + (i > 30000 ? 3 : 2));
+        EXPECT_EQ(parallel[i].destination, single[i].destination);
+        EXPECT_EQ(parallel[i].capacity, single[i].capacity);
+        EXPECT_EQ(parallel[i].direction, single[i].direction);
+        EXPECT_EQ(parallel[i].cost, i % 3 == 0 ? i % 11 : 0);
+    }
+}
+
+TEST(validation, reportsWithLines){
+    cleanSystem();
+    std::vector<WaterSupplyManagement::PipeRecord> pipes = testSystem.readData(DataSetSelection::BIG);
+    testSystem.insertAll();
+    testSystem.addPipes(pipes);
+    ValidationReport report = testSystem.validate();
+    EXPECT_EQ(report.getStatistics().cities, 22);
+    EXPECT_EQ(report.getStatistics().reachableCities, 22);
+    EXPECT_EQ(report.getStatistics().pipes, 173);
+    ASSERT_EQ(report.getIssues().size(), 1);
+    EXPECT_EQ(report.getIssues()[0].type, ValidationReport::IssueType::STATION_WITHOUT_OUTFLOW);
+    EXPECT_EQ(report.getIssues()[0].code, "PS_78");
+    EXPECT_EQ(report.getIssues()[0].line, 79);
+
+    //problems of the files, with their line
+    testSystem.readCities(DataSetSelection::BIG);
+    report = testSystem.validate();
+    EXPECT_EQ(report.count(ValidationReport::IssueType::DUPLICATE_CODE), 22);
+    EXPECT_EQ(report.getIssues()[0].code, "C_1");
+    EXPECT_EQ(report.getIssues()[0].line, 2);
+    EXPECT_EQ(report.getIssues()[0].file, VertexType::CITIES);
+
+    testSystem.addStation(Station("PS_99", 99));
+    EXPECT_TRUE(testSystem.insertStation("PS_99"));
+    testSystem.addCity(City("New", 99, "C_99", 10, 100));
+    EXPECT_TRUE(testSystem.insertCity("C_99"));
+    {
+        std::ofstream fout("pipes_validation_test.csv");
+        fout << "Service_Point_A,Service_Point_B,Capacity,Direction\n";
+        fout << "R_1,C_404,10,1\n\n";
+        fout << "R_1,PS_99,0,1\n";
+        fout << "R_1,PS_99,5,1\n";
+    }
+    testSystem.addPipes(WaterSupplyManagement::parsePipes("pipes_validation_test.csv"));
+    std::remove("pipes_validation_test.csv");
+    EXPECT_TRUE(WaterSupplyManagement::parsePipes("missing_file.csv", 1, &report).empty());
+    EXPECT_EQ(report.count(ValidationReport::IssueType::FILE_NOT_OPENED), 1);
+
+    report = testSystem.validate(true);
+    std::map<ValidationReport::IssueType, ValidationReport::Issue> found;
+    for(const ValidationReport::Issue &issue : report.getIssues()) found[issue.type] = issue;
+    EXPECT_EQ(found[ValidationReport::IssueType::DANGLING_ENDPOINT].line, 2);
+    EXPECT_EQ(found[ValidationReport::IssueType::NON_POSITIVE_CAPACITY].line, 4);
+    EXPECT_TRUE(found[ValidationReport::IssueType::NON_POSITIVE_CAPACITY].repaired);
+    EXPECT_EQ(found[ValidationReport::IssueType::DUPLICATE_PIPE].line, 5);
+    EXPECT_EQ(found[ValidationReport::IssueType::UNREACHABLE_CITY].code, "C_99");
+    EXPECT_EQ(report.count(ValidationReport::IssueType::STATION_WITHOUT_OUTFLOW), 2);
+    EXPECT_EQ(report.getStatistics().reachableCities, 22);
+
+    //the repair removed only the pipe with no capacity, and it can be undone
+    ASSERT_NE(testSystem.findPipe("R_1", "PS_99"), nullptr);
+    EXPECT_EQ(testSystem.findPipe("R_1", "PS_99")->getWeight(), 5);
+    EXPECT_EQ(testSystem.getNetwork().findVertex("PS_99")->getIncoming().size(), 1);
+    EXPECT_EQ(testSystem.validate().count(ValidationReport::IssueType::NON_POSITIVE_CAPACITY), 0);
+    EXPECT_TRUE(testSystem.undo());
+    EXPECT_EQ(testSystem.getNetwork().findVertex("PS_99")->getIncoming().size(), 2);
+    EXPECT_EQ(testSystem.validate().count(ValidationReport::IssueType::NON_POSITIVE_CAPACITY), 1);
+}
+
+static double stationOutflow(const Vertex<std::string> *v){
+    double res = 0;
+    for(Edge<std::string> *e : v->getAdj()) if(e->getFlow() > 0) res += e->getFlow();
+    for(Edge<std::string> *e : v->getIncoming()) if(e->isBidirectional() && e->getFlow() < 0) res -= e->getFlow();
+    return res;
+}
+
+TEST(stationCapacity, nodeSplitting){
+    {
+        std::ofstream fout("stations_capacity_test.csv");
+        fout << "Id,Code,Capacity\n";
+        fout << "1,PS_1,30\n";
+        fout << "2,PS_2\n";
+    }
+    std::vector<Station> parsed = WaterSupplyManagement::parseStations("stations_capacity_test.csv");
+    std::remove("stations_capacity_test.csv");
+    ASSERT_EQ(parsed.size(), 2);
+    EXPECT_EQ(parsed[0].getCode(), "PS_1");
+    EXPECT_EQ(parsed[0].getCapacity(), 30);
+    EXPECT_EQ(parsed[1].getCode(), "PS_2");
+    EXPECT_FALSE(parsed[1].hasCapacity());
+
+    cleanSystem();
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+    testSystem.edmondsKarp("super_source", "super_sink");
+    double maxFlow = totalFlow(testSystem);
+
+    //the station that pumps the most water
+    std::string busiest;
+    double pumped = 0;
+    for(const std::string &code : testSystem.getStationCodes()){
+        double out = stationOutflow(testSystem.getNetwork().findVertex(code));
+        if(out > pumped){
+            pumped = out;
+            busiest = code;
+        }
+    }
+    ASSERT_GT(pumped, 0);
+    EXPECT_GE(testSystem.stationCapacity(busiest), pumped);
+
+    //limited to half of what it pumped
+    double limit = pumped / 2;
+    EXPECT_TRUE(testSystem.setStationCapacity(busiest, limit));
+    EXPECT_FALSE(testSystem.setStationCapacity("PS_404", limit));
+    EXPECT_EQ(testSystem.stationCapacity(busiest), limit);
+    testSystem.edmondsKarp("super_source", "super_sink");
+    double limitedFlow = totalFlow(testSystem);
+    EXPECT_LT(limitedFlow, maxFlow);
+    EXPECT_LE(stationOutflow(testSystem.getNetwork().findVertex(busiest)), limit + 1e-9);
+    testSystem.edmondsKarpScaling("super_source", "super_sink");
+    EXPECT_DOUBLE_EQ(totalFlow(testSystem), limitedFlow);
+
+    //the balance keeps the station within its capacity
+    testSystem.networkBalance();
+    EXPECT_LE(stationOutflow(testSystem.getNetwork().findVertex(busiest)), limit + 1e-9);
+    EXPECT_DOUBLE_EQ(totalFlow(testSystem), limitedFlow);
+
+    //the capacities of the super source edges are still respected
+    Edge<std::string> *reservoir = nullptr;
+    for(Edge<std::string> *e : testSystem.getNetwork().findVertex("super_source")->getAdj()){
+        if(reservoir == nullptr || e->getFlow() > reservoir->getFlow()) reservoir = e;
+    }
+    ASSERT_GT(reservoir->getFlow(), 0);
+    double delivery = reservoir->getWeight();
+    EXPECT_TRUE(testSystem.setPipeCapacity("super_source", reservoir->getDest()->getInfo(), 0));
+    testSystem.edmondsKarp("super_source", "super_sink");
+    EXPECT_EQ(reservoir->getFlow(), 0);
+    EXPECT_LT(totalFlow(testSystem), limitedFlow);
+    EXPECT_TRUE(testSystem.setPipeCapacity("super_source", reservoir->getDest()->getInfo(), delivery));
+
+    //without the limit, keeping half of the capacity loses less water than removing the station
+    EXPECT_TRUE(testSystem.setStationCapacity(busiest, std::numeric_limits<double>::infinity()));
+    testSystem.edmondsKarp("super_source", "super_sink");
+    EXPECT_DOUBLE_EQ(totalFlow(testSystem), maxFlow);
+    std::vector<std::pair<std::string,double>> removed = testSystem.affectedCitiesStations(busiest, {});
+    std::vector<std::pair<std::string,double>> halved = testSystem.affectedCitiesStations(busiest, {}, 0.5);
+    double removedDeficit = 0, halvedDeficit = 0;
+    for(const auto &city : removed) removedDeficit += city.second;
+    for(const auto &city : halved) halvedDeficit += city.second;
+    EXPECT_GT(removedDeficit, 0);
+    EXPECT_LT(halvedDeficit, removedDeficit);
+    EXPECT_FALSE(testSystem.getCodeToStation().at(busiest).hasCapacity());
+}
+
+TEST(degradation, curveMatchesResolving){
+    cleanSystem();
+    testSystem.readStations(DataSetSelection::SMALL);
+    testSystem.readReservoirs(DataSetSelection::SMALL);
+    testSystem.readCities(DataSetSelection::SMALL);
+    testSystem.insertAll();
+    testSystem.readPipes(DataSetSelection::SMALL);
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+    testSystem.edmondsKarp("super_source", "super_sink");
+    double maxFlow = totalFlow(testSystem);
+
+    //busiest reservoir, station and pipe
+    std::string reservoir, station;
+    Edge<std::string> *pipe = nullptr;
+    double reservoirFlow = 0, stationFlow = 0;
+    for(Vertex<std::string> *v : testSystem.getNetwork().getVertexSet()){
+        for(Edge<std::string> *e : v->getAdj()){
+            if(v->getInfo() == "super_source" && e->getFlow() > reservoirFlow){
+                reservoirFlow = e->getFlow();
+                reservoir = e->getDest()->getInfo();
+            }
+            if(v->getType() == VertexType::STATIONS && e->getDest()->getType() == VertexType::STATIONS && (pipe == nullptr || std::abs(e->getFlow()) > std::abs(pipe->getFlow()))) pipe = e;
+        }
+        if(v->getType() == VertexType::STATIONS && stationOutflow(v) > stationFlow){
+            stationFlow = stationOutflow(v);
+            station = v->getInfo();
+        }
+    }
+    ASSERT_NE(pipe, nullptr);
+    std::string origin = pipe->getOrig()->getInfo(), destination = pipe->getDest()->getInfo();
+    double pipeCapacity = pipe->getWeight();
+    double delivery = testSystem.findPipe("super_source", reservoir)->getWeight();
+
+    WaterSupplyManagement::DegradationCurve reservoirCurve = testSystem.degradationCurve(reservoir);
+    WaterSupplyManagement::DegradationCurve stationCurve = testSystem.degradationCurve(station);
+    WaterSupplyManagement::DegradationCurve pipeCurve = testSystem.degradationCurve(origin, destination);
+    EXPECT_DOUBLE_EQ(totalFlow(testSystem), maxFlow);
+    EXPECT_DOUBLE_EQ(reservoirCurve.flow(1), maxFlow);
+    EXPECT_DOUBLE_EQ(stationCurve.flow(1), maxFlow);
+    EXPECT_DOUBLE_EQ(pipeCurve.flow(1), maxFlow);
+    EXPECT_LT(reservoirCurve.flow(0), maxFlow);
+    EXPECT_DOUBLE_EQ(testSystem.degradationCurve("PS_404").flow(0), maxFlow);
+
+    //the same flow as solving again at each percentage, and deficits that add up to the missing water
+    double totalDemand = 0;
+    for(double demand : reservoirCurve.demand) totalDemand += demand;
+    for(int percentage = 0; percentage <= 100; percentage += 20){
+        double remaining = percentage / 100.0;
+
+        testSystem.setPipeCapacity("super_source", reservoir, remaining * delivery);
+        testSystem.edmondsKarp("super_source", "super_sink");
+        EXPECT_NEAR(reservoirCurve.flow(remaining), totalFlow(testSystem), 1e-6);
+        double deficit = 0;
+        for(const auto &city : reservoirCurve.deficits(remaining)) deficit += city.second;
+        EXPECT_NEAR(deficit, totalDemand - reservoirCurve.flow(remaining), 1e-6);
+        testSystem.setPipeCapacity("super_source", reservoir, delivery);
+
+        testSystem.setStationCapacity(station, remaining * stationCurve.capacity);
+        testSystem.edmondsKarp("super_source", "super_sink");
+        EXPECT_NEAR(stationCurve.flow(remaining), totalFlow(testSystem), 1e-6);
+        testSystem.setStationCapacity(station, std::numeric_limits<double>::infinity());
+
+        testSystem.setPipeCapacity(origin, destination, remaining * pipeCapacity);
+        testSystem.edmondsKarp("super_source", "super_sink");
+        EXPECT_NEAR(pipeCurve.flow(remaining), totalFlow(testSystem), 1e-6);
+        testSystem.setPipeCapacity(origin, destination, pipeCapacity);
+        deficit = 0;
+        for(const auto &city : pipeCurve.deficits(remaining)) deficit += city.second;
+        EXPECT_NEAR(deficit, totalDemand - pipeCurve.flow(remaining), 1e-6);
+    }
+}
+
+TEST(validation, selectionAndReversedPipes){
+    cleanSystem();
+    testSystem.addReservoir(Reservoir("A", "A", 1, "R_1", 10));
+    testSystem.addStation(Station("PS_1", 1));
+    testSystem.addStation(Station("PS_2", 2));
+    testSystem.addCity(City("C1", 1, "C_1", 10, 100));
+    testSystem.insertReservoir("R_1");
+    testSystem.insertStation("PS_1");
+    testSystem.insertCity("C_1");
+
+    //PS_2 was read but not selected, C_404 was never read
+    std::vector<WaterSupplyManagement::PipeRecord> pipes = {
+            {"R_1", "PS_1", 10, 1, 0, 2},
+            {"PS_1", "PS_2", 10, 1, 0, 3},
+            {"PS_1", "C_404", 10, 1, 0, 4},
+            {"PS_1", "C_1", 10, 0, 0, 5},
+            {"C_1", "PS_1", 10, 0, 0, 6},
+            {"C_1", "R_1", 10, 1, 0, 7},
+            {"PS_1", "R_1", 10, 1, 0, 8}};
+    testSystem.addPipes(pipes);
+    ValidationReport report = testSystem.validate();
+    ASSERT_EQ(report.count(ValidationReport::IssueType::DANGLING_ENDPOINT), 1);
+    ASSERT_EQ(report.count(ValidationReport::IssueType::DUPLICATE_PIPE), 1);
+    for(const ValidationReport::Issue &issue : report.getIssues()){
+        if(issue.type == ValidationReport::IssueType::DANGLING_ENDPOINT){
+            EXPECT_EQ(issue.line, 4);
+        }
+        if(issue.type == ValidationReport::IssueType::DUPLICATE_PIPE){
+            EXPECT_EQ(issue.line, 6);
+        }
+    }
+}
+
+TEST(stationCapacity, invalidCapacities){
+    {
+        std::ofstream fout("stations_invalid_capacity_test.csv");
+        fout << "Id,Code,Capacity\n";
+        fout << "1,PS_1,30\n";
+        fout << "2,PS_2,-5\n";
+    }
+    ValidationReport report;
+    std::vector<Station> parsed = WaterSupplyManagement::parseStations("stations_invalid_capacity_test.csv", &report);
+    std::remove("stations_invalid_capacity_test.csv");
+    ASSERT_EQ(parsed.size(), 2);
+    EXPECT_FALSE(parsed[1].hasCapacity());
+    ASSERT_EQ(report.count(ValidationReport::IssueType::INVALID_STATION_CAPACITY), 1);
+    EXPECT_EQ(report.getIssues()[0].line, 3);
+
+    cleanSystem();
+    testSystem.addReservoir(Reservoir("A", "A", 1, "R_1", 10));
+    testSystem.addStation(Station("PS_1", 1));
+    testSystem.addStation(Station("PS_2", 2, -1));
+    testSystem.addCity(City("C1", 1, "C_1", 10, 100));
+    testSystem.insertAll();
+    testSystem.addPipe("R_1", "PS_1", 10, 1);
+    testSystem.addPipe("PS_1", "PS_2", 10, 1);
+    testSystem.addPipe("PS_2", "C_1", 10, 1);
+
+    //invalid values are refused, valid changes can be undone
+    EXPECT_FALSE(testSystem.setStationCapacity("PS_1", -1));
+    EXPECT_FALSE(testSystem.setStationCapacity("PS_1", std::nan("")));
+    EXPECT_TRUE(testSystem.setStationCapacity("PS_1", 4));
+    EXPECT_EQ(testSystem.stationCapacity("PS_1"), 4);
+    EXPECT_TRUE(testSystem.undo());
+    EXPECT_FALSE(testSystem.getCodeToStation().at("PS_1").hasCapacity());
+    EXPECT_TRUE(testSystem.redo());
+    EXPECT_EQ(testSystem.stationCapacity("PS_1"), 4);
+
+    //a station built with an invalid capacity is reported and repaired
+    report = testSystem.validate(true);
+    ASSERT_EQ(report.count(ValidationReport::IssueType::INVALID_STATION_CAPACITY), 1);
+    for(const ValidationReport::Issue &issue : report.getIssues()){
+        if(issue.type == ValidationReport::IssueType::INVALID_STATION_CAPACITY){
+            EXPECT_TRUE(issue.repaired);
+        }
+    }
+    EXPECT_FALSE(testSystem.getCodeToStation().at("PS_2").hasCapacity());
+    testSystem.createSuperSource();
+    testSystem.createSuperSink();
+    testSystem.edmondsKarp("super_source", "super_sink");
+    EXPECT_DOUBLE_EQ(totalFlow(testSystem), 4);
+}